@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "AblationProfiler.h"
+#include "Statistics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace ShaderToggler
+{
+	void AblationProfiler::start(std::vector<Candidate>&& candidates, const Settings& settings)
+	{
+		_candidates = std::move(candidates);
+		_settings = settings;
+		_settings.framesPerSample = std::max(_settings.framesPerSample, 1u);
+		_settings.rounds = std::max(_settings.rounds, 1u);
+		_deltasPerCandidate.assign(_candidates.size(), std::vector<double>());
+		_baselineSumPerCandidate.assign(_candidates.size(), 0.0);
+		_phaseFrameTimes.clear();
+		_phaseFrameTimes.reserve(_settings.framesPerSample);
+		_isBlockedPhase = false;
+		_currentCandidate = 0;
+		_currentRound = 0;
+		_frameInPhase = 0;
+		_hasLastPresentTime = false;
+		_isRunning = !_candidates.empty();
+	}
+
+
+	void AblationProfiler::stop()
+	{
+		_isRunning = false;
+	}
+
+
+	void AblationProfiler::onFramePresented(std::chrono::steady_clock::time_point presentTime)
+	{
+		if(!_isRunning)
+		{
+			return;
+		}
+		if(!_hasLastPresentTime)
+		{
+			_lastPresentTime = presentTime;
+			_hasLastPresentTime = true;
+			return;
+		}
+		const double frameTimeMs = std::chrono::duration<double, std::milli>(presentTime - _lastPresentTime).count();
+		_lastPresentTime = presentTime;
+		if(_frameInPhase >= _settings.warmupFrames)
+		{
+			_phaseFrameTimes.push_back(frameTimeMs);
+		}
+		_frameInPhase++;
+		if(_frameInPhase < getFramesPerPhase())
+		{
+			return;
+		}
+
+		// the median isn't thrown off by the occasional hitch, unlike the mean.
+		const double medianFrameTimeMs = median(_phaseFrameTimes);
+		_phaseFrameTimes.clear();
+		_frameInPhase = 0;
+		onPhaseCompleted(medianFrameTimeMs);
+	}
+
+
+	void AblationProfiler::onPhaseCompleted(double medianFrameTimeMs)
+	{
+		if(!_isBlockedPhase)
+		{
+			_lastBaselineMs = medianFrameTimeMs;
+			_isBlockedPhase = true;
+			return;
+		}
+		_deltasPerCandidate[_currentCandidate].push_back(medianFrameTimeMs - _lastBaselineMs);
+		_baselineSumPerCandidate[_currentCandidate] += _lastBaselineMs;
+		_isBlockedPhase = false;
+		_currentCandidate++;
+		if(_currentCandidate < _candidates.size())
+		{
+			return;
+		}
+		_currentCandidate = 0;
+		_currentRound++;
+		if(_currentRound >= _settings.rounds)
+		{
+			_isRunning = false;
+		}
+	}
+
+
+	const AblationProfiler::Candidate* AblationProfiler::getBlockedCandidate() const
+	{
+		return _isRunning && _isBlockedPhase ? &_candidates[_currentCandidate] : nullptr;
+	}
+
+
+	uint32_t AblationProfiler::getFramesToGo() const
+	{
+		if(!_isRunning)
+		{
+			return 0;
+		}
+		const uint32_t amountCandidates = static_cast<uint32_t>(_candidates.size());
+		const uint32_t phasesDone = (_currentRound * amountCandidates + _currentCandidate) * 2 + (_isBlockedPhase ? 1 : 0);
+		const uint32_t phasesTotal = _settings.rounds * amountCandidates * 2;
+		return (phasesTotal - phasesDone) * getFramesPerPhase() - _frameInPhase;
+	}
+
+
+	float AblationProfiler::getProgress() const
+	{
+		if(_candidates.empty())
+		{
+			return 0.0f;
+		}
+		if(!_isRunning)
+		{
+			return 1.0f;
+		}
+		const uint32_t framesTotal = _settings.rounds * static_cast<uint32_t>(_candidates.size()) * 2 * getFramesPerPhase();
+		return 1.0f - static_cast<float>(getFramesToGo()) / static_cast<float>(framesTotal);
+	}
+
+
+	std::vector<AblationProfiler::Result> AblationProfiler::getResults() const
+	{
+		std::vector<Result> toReturn;
+		toReturn.reserve(_candidates.size());
+		for(size_t i = 0; i < _candidates.size(); i++)
+		{
+			const std::vector<double>& deltas = _deltasPerCandidate[i];
+			if(deltas.empty())
+			{
+				continue;
+			}
+			Result result;
+			result.candidate = _candidates[i];
+			result.amountSamples = static_cast<uint32_t>(deltas.size());
+			const MeanWithInterval delta = meanWithInterval(deltas);
+			result.meanDeltaMs = delta.mean;
+			result.confidenceIntervalMs = delta.confidenceInterval95;
+			result.baselineFrameTimeMs = _baselineSumPerCandidate[i] / deltas.size();
+			toReturn.push_back(result);
+		}
+		std::sort(toReturn.begin(), toReturn.end(), [](const Result& a, const Result& b) { return a.meanDeltaMs < b.meanDeltaMs; });
+		return toReturn;
+	}
+
+
+	bool AblationProfiler::writeCsv(const std::string& fileName, std::string& errorMessage) const
+	{
+		std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+		if(!file.is_open())
+		{
+			errorMessage = "Couldn't open " + fileName;
+			return false;
+		}
+		file << "Rank,ShaderType,ShaderHash,FrameTimeDeltaMs,ConfidenceInterval95Ms,BaselineFrameTimeMs,Samples\n";
+		const std::vector<Result> results = getResults();
+		char line[256];
+		for(size_t i = 0; i < results.size(); i++)
+		{
+			const Result& result = results[i];
+			snprintf(line, sizeof(line), "%zu,%s,%08X,%.4f,%.4f,%.4f,%u\n", i + 1, result.candidate.shaderType, result.candidate.shaderHash, result.meanDeltaMs,
+					 result.confidenceIntervalMs, result.baselineFrameTimeMs, result.amountSamples);
+			file << line;
+		}
+		file.close();
+		if(file.fail())
+		{
+			errorMessage = "Couldn't write " + fileName;
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ShaderToggler
+{
+	class ShaderManager;
+
+	/// <summary>
+	/// Ranks shaders by what they cost in frame time, by blocking them one at a time and measuring the present to present time. Every candidate
+	/// gets a baseline sample (nothing blocked) directly followed by a sample with the candidate blocked, so slow drift in frame time cancels
+	/// out. A sample is the median frame time over a number of frames, after skipping a few frames for the change to reach the GPU. All
+	/// candidates are measured for a number of rounds, and the result per candidate is the mean of the deltas with a 95% confidence interval.
+	/// Only used on the present thread.
+	/// </summary>
+	class AblationProfiler
+	{
+	public:
+		struct Settings
+		{
+			uint32_t framesPerSample = 10;		// frames measured per sample
+			uint32_t warmupFrames = 3;			// frames skipped after blocking / unblocking, before measuring
+			uint32_t rounds = 3;				// number of times each candidate is measured
+		};
+
+		struct Candidate
+		{
+			ShaderManager* shaderManager = nullptr;		// the manager of the stage the shader is bound to, which does the blocking.
+			const char* shaderType = "";
+			uint32_t shaderId = 0;
+			uint32_t shaderHash = 0;
+		};
+
+		struct Result
+		{
+			Candidate candidate;
+			double meanDeltaMs = 0.0;					// frame time with the shader blocked minus frame time without. Negative is a saving.
+			double confidenceIntervalMs = 0.0;			// half width of the 95% confidence interval of meanDeltaMs. 0 with fewer than 2 samples.
+			double baselineFrameTimeMs = 0.0;
+			uint32_t amountSamples = 0;
+		};
+
+		/// <summary>
+		/// Starts measuring the candidates specified. Any previous results are discarded.
+		/// </summary>
+		void start(std::vector<Candidate>&& candidates, const Settings& settings);
+		void stop();
+		/// <summary>
+		/// Called at every present with the time of the present. Advances the schedule, after which getBlockedCandidate returns the candidate
+		/// to block for the next frame.
+		/// </summary>
+		void onFramePresented(std::chrono::steady_clock::time_point presentTime);
+		/// <summary>
+		/// Returns the candidate which has to be blocked in the coming frame, nullptr if nothing has to be blocked.
+		/// </summary>
+		const Candidate* getBlockedCandidate() const;
+
+		bool isRunning() const { return _isRunning; }
+		bool hasResults() const { return !_deltasPerCandidate.empty(); }
+		/// <summary>
+		/// Returns the number of frames the profiler still needs to finish.
+		/// </summary>
+		uint32_t getFramesToGo() const;
+		float getProgress() const;
+		/// <summary>
+		/// Returns the results measured so far, ranked by delta: the shaders whose blocking saves the most frame time come first.
+		/// </summary>
+		std::vector<Result> getResults() const;
+		/// <summary>
+		/// Writes the ranked results as CSV to the file specified.
+		/// </summary>
+		bool writeCsv(const std::string& fileName, std::string& errorMessage) const;
+
+	private:
+		uint32_t getFramesPerPhase() const { return _settings.warmupFrames + _settings.framesPerSample; }
+		void onPhaseCompleted(double medianFrameTimeMs);
+
+		Settings _settings;
+		std::vector<Candidate> _candidates;
+		std::vector<std::vector<double>> _deltasPerCandidate;		// per candidate, the delta measured per round.
+		std::vector<double> _baselineSumPerCandidate;
+		std::vector<double> _phaseFrameTimes;
+		bool _isRunning = false;
+		bool _isBlockedPhase = false;
+		uint32_t _currentCandidate = 0;
+		uint32_t _currentRound = 0;
+		uint32_t _frameInPhase = 0;
+		double _lastBaselineMs = 0.0;
+		bool _hasLastPresentTime = false;
+		std::chrono::steady_clock::time_point _lastPresentTime;
+	};
+}
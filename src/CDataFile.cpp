@@ -35,6 +35,8 @@
 // MachineName=ADMIN
 //
 #include "stdafx.h"
+#include <algorithm>
+#include <bit>
 #include <vector>
 #include <string>
 #include <ctype.h>
@@ -42,11 +44,20 @@
 #include <stdarg.h>
 #include <fstream>
 #include <float.h>
+#include <climits>
+#include <cstring>
+
+#include <string_view>
 
 #ifdef WIN32
 #include <windows.h>
 #endif
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CDATAFILE_SSE2
+#endif
+
 #include "CDataFile.h"
 
 // Compatibility Defines ////////////////////////////////////////////////////////
@@ -57,15 +68,154 @@
 #endif
 
 
+// IsTrimChar
+// Returns true for the characters Load trims from lines and key names: white
+// space and the equal indicators.
+static inline bool IsTrimChar(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '=' || c == ':';
+}
+
+// TrimView
+// Returns the passed in view without white space and equal indicators on
+// both sides.
+static std::string_view TrimView(std::string_view szStr)
+{
+	size_t nStart = 0;
+	size_t nEnd = szStr.size();
+
+	while ( nStart < nEnd && IsTrimChar(szStr[nStart]) )
+		nStart++;
+
+	while ( nEnd > nStart && IsTrimChar(szStr[nEnd - 1]) )
+		nEnd--;
+
+	return szStr.substr(nStart, nEnd - nStart);
+}
+
+// IsCommentIndicator
+// Returns true if the character starts a comment line. Compares against the
+// indicators directly, as t_Str::find costs more than the whole comparison.
+static inline bool IsCommentIndicator(char c)
+{
+	for (const char cIndicator : CommentIndicators)
+	{
+		if ( c == cIndicator )
+			return true;
+	}
+
+	return false;
+}
+
+// FindEqualIndicator
+// Returns the position of the first equal indicator in the line, npos if
+// there's none. Searches for each indicator with find, which is a lot faster
+// than testing every character against both.
+static size_t FindEqualIndicator(std::string_view szLine)
+{
+	const size_t nEqual = szLine.find('=');
+	const size_t nColon = szLine.substr(0, nEqual).find(':');
+
+	return nColon != std::string_view::npos ? nColon : nEqual;
+}
+
+// FindLineEnd
+// Returns the position of the line break ending the line which starts at
+// nLineStart, the size of the contents if it's the last line. Also returns
+// the position of the first equal indicator on the line in nEqual, npos if
+// there's none. Runs for every line of the file, so where SSE2 is available
+// it checks 16 characters at a time for all three at once.
+static size_t FindLineEnd(std::string_view szContents, size_t nLineStart, size_t& nEqual)
+{
+	size_t nPos = nLineStart;
+
+	nEqual = std::string_view::npos;
+
+#ifdef CDATAFILE_SSE2
+	const __m128i LineBreak = _mm_set1_epi8('\n');
+	const __m128i Equal = _mm_set1_epi8('=');
+	const __m128i Colon = _mm_set1_epi8(':');
+
+	for (; nPos + 16 <= szContents.size(); nPos += 16)
+	{
+		const __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(szContents.data() + nPos));
+		const unsigned int nLineBreaks = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(Chunk, LineBreak)));
+		unsigned int nEquals = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(Chunk, Equal), _mm_cmpeq_epi8(Chunk, Colon))));
+
+		// only the indicators before the line break are on this line
+		if ( nLineBreaks != 0 )
+			nEquals &= (nLineBreaks & (0u - nLineBreaks)) - 1;
+
+		if ( nEqual == std::string_view::npos && nEquals != 0 )
+			nEqual = nPos + std::countr_zero(nEquals);
+
+		if ( nLineBreaks != 0 )
+			return nPos + std::countr_zero(nLineBreaks);
+	}
+#endif
+
+	for (; nPos < szContents.size(); nPos++)
+	{
+		const char c = szContents[nPos];
+
+		if ( c == '\n' )
+			break;
+
+		if ( nEqual == std::string_view::npos && (c == '=' || c == ':') )
+			nEqual = nPos;
+	}
+
+	return nPos;
+}
+
+// NextLine
+// Returns the trimmed line starting at nLineStart and moves nLineStart to the
+// start of the line after it. nEqual receives the position of the first equal
+// indicator in the returned line, npos if there's none.
+static std::string_view NextLine(std::string_view szContents, size_t& nLineStart, size_t& nEqual)
+{
+	const size_t nLineEnd = FindLineEnd(szContents, nLineStart, nEqual);
+	const std::string_view szRawLine = szContents.substr(nLineStart, nLineEnd - nLineStart);
+	const std::string_view szLine = TrimView(szRawLine);
+	const size_t nTrimmedStart = nLineStart + static_cast<size_t>(szLine.data() - szRawLine.data());
+
+	nLineStart = nLineEnd + 1;
+
+	if ( nEqual == std::string_view::npos )
+		return szLine;
+
+	// an indicator trimmed off the start of the line may be followed by
+	// another one, while one trimmed off the end is the line's only one
+	if ( nEqual < nTrimmedStart )
+		nEqual = FindEqualIndicator(szLine);
+	else
+	if ( nEqual - nTrimmedStart < szLine.size() )
+		nEqual -= nTrimmedStart;
+	else
+		nEqual = std::string_view::npos;
+
+	return szLine;
+}
+
+// ReserveKeys
+// Makes room for the given number of keys more in the section's key list
+// and key index.
+static void ReserveKeys(t_Section* pSection, size_t nAmountKeys)
+{
+	pSection->Keys.reserve(pSection->Keys.size() + nAmountKeys);
+	pSection->KeyIndex.Reserve(pSection->Keys.size() + nAmountKeys);
+}
+
+
 // CDataFile
 // Our default contstructor.  If it can load the file, it will do so and populate
 // the section list with the values from the file.
-CDataFile::CDataFile(t_Str szFileName)
+CDataFile::CDataFile(const t_Str& szFileName)
 {
 	m_bDirty = false;
 	m_szFileName = szFileName;
 	m_Flags = (AUTOCREATE_SECTIONS | AUTOCREATE_KEYS);
-	m_Sections.push_back( *(new t_Section) );
+	AddSection(t_Str(""), t_Str(""));
 
 	Load(m_szFileName);
 }
@@ -74,7 +224,7 @@ CDataFile::CDataFile()
 {
 	Clear();
 	m_Flags = (AUTOCREATE_SECTIONS | AUTOCREATE_KEYS);
-	m_Sections.push_back( *(new t_Section) );
+	AddSection(t_Str(""), t_Str(""));
 }
 
 // ~CDataFile
@@ -92,12 +242,13 @@ void CDataFile::Clear()
 	m_bDirty = false;
 	m_szFileName = t_Str("");
 	m_Sections.clear();
+	m_SectionIndex.Clear();
 }
 
 // SetFileName
 // Set's the m_szFileName member variable. For use when creating the CDataFile
 // object by hand (-vs- loading it from a file
-void CDataFile::SetFileName(t_Str szFileName)
+void CDataFile::SetFileName(const t_Str& szFileName)
 {
 	if (m_szFileName.size() != 0 && CompareNoCase(szFileName, m_szFileName) != 0)
 	{
@@ -114,80 +265,117 @@ void CDataFile::SetFileName(t_Str szFileName)
 // Attempts to load in the text file. If successful it will populate the 
 // Section list with the key/value pairs found in the file. Note that comments
 // are saved so that they can be rewritten to the file later.
-bool CDataFile::Load(t_Str szFileName)
+// The file is mapped into memory and parsed in a single pass over it: lines
+// and tokens are string_views into the mapped view, so there's no line
+// length limit and a t_Str is only created for what is actually stored.
+// Keys are added straight to the current section instead of going through
+// SetValue, which would look up the section again for every line.
+bool CDataFile::Load(const t_Str& szFileName)
 {
 	// We dont want to create a new file here.  If it doesn't exist, just
 	// return false and report the failure.
-	fstream File(szFileName.c_str(), ios::in);
+	std::ifstream File(szFileName.c_str(), std::ios::in | std::ios::binary);
 
-	if ( File.is_open() )
+	if ( !File.is_open() )
 	{
-		bool bDone = false;
-		bool bAutoKey = (m_Flags & AUTOCREATE_KEYS) == AUTOCREATE_KEYS;
-		bool bAutoSec = (m_Flags & AUTOCREATE_SECTIONS) == AUTOCREATE_SECTIONS;
-		
-		t_Str szLine;
-		t_Str szComment;
-		char buffer[MAX_BUFFER_LEN]; 
-		t_Section* pSection = GetSection("");
+		Report(E_INFO, "[CDataFile::Load] Unable to open file. Does it exist?");
+		return false;
+	}
 
-		// These need to be set, we'll restore the original values later.
-		m_Flags |= AUTOCREATE_KEYS;
-		m_Flags |= AUTOCREATE_SECTIONS;
+	// The file is read into a buffer in one go and parsed from there, so an
+	// editor saving the file during the load can't change the bytes being
+	// parsed. Ini files are tens of KB, so the copy costs next to nothing.
+	File.seekg(0, std::ios::end);
+	const std::streamoff nFileSize = File.tellg();
+	File.seekg(0, std::ios::beg);
+	t_Str szBuffer(nFileSize > 0 ? static_cast<size_t>(nFileSize) : 0, '\0');
+	File.read(szBuffer.data(), static_cast<std::streamsize>(szBuffer.size()));
+	szBuffer.resize(static_cast<size_t>(File.gcount()));
+	File.close();
 
-		while ( !bDone )
+	// the loaded keys equal what's in the file, so loading doesn't make the
+	// data dirty: only changes made before or after it do.
+	const bool bWasDirty = m_bDirty;
+	const std::string_view szContents = szBuffer;
+
+	// Count the lines following each section header first, so the key lists
+	// and their indices are allocated once, at a size which fits all keys.
+	// The count at position 0 is for the lines before the first header. A
+	// header which doesn't start its line only costs its section the reserve.
+	// Searching for the brackets and counting the line ends in between is a
+	// lot cheaper than going through the file line by line.
+	std::vector<size_t> LineCounts(1, 0);
+	size_t nCountedUpTo = 0;
+
+	for (size_t nBracket = szContents.find('['); nBracket != std::string_view::npos; nBracket = szContents.find('[', nBracket + 1))
+	{
+		if ( nBracket == 0 || szContents[nBracket - 1] == '\n' )
 		{
-			memset(buffer, 0, MAX_BUFFER_LEN);
-			File.getline(buffer, MAX_BUFFER_LEN);
+			LineCounts.back() += std::count(szContents.begin() + nCountedUpTo, szContents.begin() + nBracket, '\n');
+			LineCounts.push_back(0);
+			nCountedUpTo = nBracket;
+		}
+	}
 
-			szLine = buffer;
-			Trim(szLine);
+	LineCounts.back() += std::count(szContents.begin() + nCountedUpTo, szContents.end(), '\n') + 1;
 
-			bDone = ( File.eof() || File.bad() || File.fail() );
+	t_Str szComment;
+	t_Section* pSection = GetSection("");
+	size_t nSectionHeader = 0;
+	size_t nLineStart = 0;
 
-			if ( szLine.find_first_of(CommentIndicators) == 0 )
-			{
-				szComment += "\n";
-				szComment += szLine;
-			}
-			else
-			if ( szLine.find_first_of('[') == 0 ) // new section
-			{
-				szLine.erase( 0, 1 );
-				szLine.erase( szLine.find_last_of(']'), 1 );
+	if ( pSection != NULL )
+		ReserveKeys(pSection, LineCounts[0]);
 
-				CreateSection(szLine, szComment);
-				pSection = GetSection(szLine);
-				szComment = t_Str("");
-			}
-			else 
-			if ( szLine.size() > 0 ) // we have a key, add this key/value pair
-			{
-				t_Str szKey = GetNextWord(szLine);
-				t_Str szValue = szLine;
+	while ( nLineStart < szContents.size() )
+	{
+		size_t nEqual;
+		const std::string_view szLine = NextLine(szContents, nLineStart, nEqual);
 
-				if ( szKey.size() > 0 && szValue.size() > 0 )
-				{
-					SetValue(szKey, szValue, szComment, pSection->szName);
-					szComment = t_Str("");
-				}
-			}
+		if ( szLine.size() == 0 )
+			continue;
+
+		if ( IsCommentIndicator(szLine[0]) )
+		{
+			szComment += "\n";
+			szComment += szLine;
 		}
+		else
+		if ( szLine[0] == '[' ) // new section
+		{
+			t_Str szSection(szLine.substr(1));
+			const size_t nBracket = szSection.find_last_of(']');
 
-		// Restore the original flag values.
-		if ( !bAutoKey )
-			m_Flags &= ~AUTOCREATE_KEYS;
+			if ( nBracket != t_Str::npos )
+				szSection.erase(nBracket, 1);
 
-		if ( !bAutoSec )
-			m_Flags &= ~AUTOCREATE_SECTIONS;
-	}
-	else
-	{
-		Report(E_INFO, "[CDataFile::Load] Unable to open file. Does it exist?");
-		return false;
+			pSection = GetSection(szSection);
+
+			if ( pSection == NULL )
+				pSection = AddSection(szSection, szComment);
+
+			if ( ++nSectionHeader < LineCounts.size() )
+				ReserveKeys(pSection, LineCounts[nSectionHeader]);
+
+			szComment.clear();
+		}
+		else // we have a key, add this key/value pair
+		{
+			if ( nEqual == std::string_view::npos )
+				continue;
+
+			const std::string_view szKey = TrimView(szLine.substr(0, nEqual));
+			const std::string_view szValue = szLine.substr(nEqual + 1);
+
+			if ( szKey.size() > 0 && szValue.size() > 0 && pSection != NULL )
+			{
+				LoadKey(pSection, szKey, szValue, szComment);
+				szComment.clear();
+			}
+		}
 	}
 
-	File.close();
+	m_bDirty = bWasDirty;
 
 	return true;
 }
@@ -273,46 +461,33 @@ bool CDataFile::Save()
 
 // SetKeyComment
 // Set the comment of a given key. Returns true if the key is not found.
-bool CDataFile::SetKeyComment(t_Str szKey, t_Str szComment, t_Str szSection)
+bool CDataFile::SetKeyComment(const t_Str& szKey, const t_Str& szComment, const t_Str& szSection)
 {
-	KeyItor k_pos;
-	t_Section* pSection;
+	t_Key* pKey = GetKey(szKey, szSection);
 
-	if ( (pSection = GetSection(szSection)) == NULL )
+	if ( pKey == NULL )
 		return false;
 
-	for (k_pos = pSection->Keys.begin(); k_pos != pSection->Keys.end(); k_pos++)
-	{
-		if ( CompareNoCase( (*k_pos).szKey, szKey ) == 0 )
-		{
-			(*k_pos).szComment = szComment;
-			m_bDirty = true;
-			return true;
-		}
-	}
-
-	return false;
+	pKey->szComment = szComment;
+	m_bDirty = true;
 
+	return true;
 }
 
 // SetSectionComment
 // Set the comment for a given section. Returns false if the section
 // was not found.
-bool CDataFile::SetSectionComment(t_Str szSection, t_Str szComment)
+bool CDataFile::SetSectionComment(const t_Str& szSection, const t_Str& szComment)
 {
-	SectionItor s_pos;
+	t_Section* pSection = GetSection(szSection);
 
-	for (s_pos = m_Sections.begin(); s_pos != m_Sections.end(); s_pos++)
-	{
-		if ( CompareNoCase( (*s_pos).szName, szSection ) == 0 ) 
-		{
-		    (*s_pos).szComment = szComment;
-			m_bDirty = true;
-			return true;
-		}
-	}
+	if ( pSection == NULL )
+		return false;
 
-	return false;
+	pSection->szComment = szComment;
+	m_bDirty = true;
+
+	return true;
 }
 
 
@@ -321,7 +496,7 @@ bool CDataFile::SetSectionComment(t_Str szSection, t_Str szComment)
 // Key within the given section, and if it finds it, change the keys value to
 // the new value. If it does not locate the key, it will create a new key with
 // the proper value and place it in the section requested.
-bool CDataFile::SetValue(t_Str szKey, t_Str szValue, t_Str szComment, t_Str szSection)
+bool CDataFile::SetValue(const t_Str& szKey, const t_Str& szValue, const t_Str& szComment, const t_Str& szSection)
 {
 	t_Key* pKey = GetKey(szKey, szSection);
 	t_Section* pSection = GetSection(szSection);
@@ -342,15 +517,9 @@ bool CDataFile::SetValue(t_Str szKey, t_Str szValue, t_Str szComment, t_Str szSe
 	// is not t_Str("") then add the new key.
 	if ( pKey == NULL && szValue.size() > 0 && (m_Flags & AUTOCREATE_KEYS))
 	{
-		pKey = new t_Key;
+		AddKey(pSection, szKey, szValue, szComment);
 
-		pKey->szKey = szKey;
-		pKey->szValue = szValue;
-		pKey->szComment = szComment;
-		
 		m_bDirty = true;
-		
-		pSection->Keys.push_back(*pKey);
 
 		return true;
 	}
@@ -370,7 +539,7 @@ bool CDataFile::SetValue(t_Str szKey, t_Str szValue, t_Str szComment, t_Str szSe
 
 // SetFloat
 // Passes the given float to SetValue as a string
-bool CDataFile::SetFloat(t_Str szKey, float fValue, t_Str szComment, t_Str szSection)
+bool CDataFile::SetFloat(const t_Str& szKey, float fValue, const t_Str& szComment, const t_Str& szSection)
 {
 	char szStr[64];
 
@@ -381,7 +550,7 @@ bool CDataFile::SetFloat(t_Str szKey, float fValue, t_Str szComment, t_Str szSec
 
 // SetInt
 // Passes the given int to SetValue as a string
-bool CDataFile::SetInt(t_Str szKey, int nValue, t_Str szComment, t_Str szSection)
+bool CDataFile::SetInt(const t_Str& szKey, int nValue, const t_Str& szComment, const t_Str& szSection)
 {
 	char szStr[64];
 
@@ -394,7 +563,7 @@ bool CDataFile::SetInt(t_Str szKey, int nValue, t_Str szComment, t_Str szSection
 
 // SetUInt
 // Passes the given int to SetValue as a string
-bool CDataFile::SetUInt(t_Str szKey, uint32_t nValue, t_Str szComment, t_Str szSection)
+bool CDataFile::SetUInt(const t_Str& szKey, uint32_t nValue, const t_Str& szComment, const t_Str& szSection)
 {
 	char szStr[64];
 
@@ -407,7 +576,7 @@ bool CDataFile::SetUInt(t_Str szKey, uint32_t nValue, t_Str szComment, t_Str szS
 
 // SetBool
 // Passes the given bool to SetValue as a string
-bool CDataFile::SetBool(t_Str szKey, bool bValue, t_Str szComment, t_Str szSection)
+bool CDataFile::SetBool(const t_Str& szKey, bool bValue, const t_Str& szComment, const t_Str& szSection)
 {
 	t_Str szValue = bValue ?  "True" : "False";
 
@@ -417,17 +586,27 @@ bool CDataFile::SetBool(t_Str szKey, bool bValue, t_Str szComment, t_Str szSecti
 // GetValue
 // Returns the key value as a t_Str object. A return value of
 // t_Str("") indicates that the key could not be found.
-t_Str CDataFile::GetValue(t_Str szKey, t_Str szSection) 
+t_Str CDataFile::GetValue(std::string_view szKey, std::string_view szSection) 
 {
 	t_Key* pKey = GetKey(szKey, szSection);
 
 	return (pKey == NULL) ? t_Str("") : pKey->szValue;
 }
 
+// GetValueView
+// Returns a view on the key value. An empty view indicates that the key could
+// not be found. The view is invalidated when the key is changed or removed.
+std::string_view CDataFile::GetValueView(std::string_view szKey, std::string_view szSection) 
+{
+	t_Key* pKey = GetKey(szKey, szSection);
+
+	return (pKey == NULL) ? std::string_view() : std::string_view(pKey->szValue);
+}
+
 // GetString
 // Returns the key value as a t_Str object. A return value of
 // t_Str("") indicates that the key could not be found.
-t_Str CDataFile::GetString(t_Str szKey, t_Str szSection)
+t_Str CDataFile::GetString(std::string_view szKey, std::string_view szSection)
 {
 	return GetValue(szKey, szSection);
 }
@@ -435,53 +614,54 @@ t_Str CDataFile::GetString(t_Str szKey, t_Str szSection)
 // GetFloat
 // Returns the key value as a float type. Returns FLT_MIN if the key is
 // not found.
-float CDataFile::GetFloat(t_Str szKey, t_Str szSection)
+float CDataFile::GetFloat(std::string_view szKey, std::string_view szSection)
 {
-	t_Str szValue = GetValue(szKey, szSection);
+	t_Key* pKey = GetKey(szKey, szSection);
 
-	if ( szValue.size() == 0 )
+	if ( pKey == NULL || pKey->szValue.size() == 0 )
 		return FLT_MIN;
 
-	return (float)atof( szValue.c_str() );
+	return (float)atof( pKey->szValue.c_str() );
 }
 
 // GetInt
 // Returns the key value as an integer type. Returns INT_MIN if the key is
 // not found.
-int	CDataFile::GetInt(t_Str szKey, t_Str szSection)
+int	CDataFile::GetInt(std::string_view szKey, std::string_view szSection)
 {
-	t_Str szValue = GetValue(szKey, szSection);
+	t_Key* pKey = GetKey(szKey, szSection);
 
-	if ( szValue.size() == 0 )
+	if ( pKey == NULL || pKey->szValue.size() == 0 )
 		return INT_MIN;
 
-	return atoi( szValue.c_str() );
+	return atoi( pKey->szValue.c_str() );
 }
 
 // GetUInt
 // Returns the key value as an integer type. Returns UINT_MAX if the key is
 // not found.
-uint32_t CDataFile::GetUInt(t_Str szKey, t_Str szSection)
+uint32_t CDataFile::GetUInt(std::string_view szKey, std::string_view szSection)
 {
-	t_Str szValue = GetValue(szKey, szSection);
+	t_Key* pKey = GetKey(szKey, szSection);
 
-	if ( szValue.size() == 0 )
+	if ( pKey == NULL || pKey->szValue.size() == 0 )
 		return UINT_MAX;
 
-	return static_cast<uint32_t>(atoll( szValue.c_str() ));
+	return static_cast<uint32_t>(atoll( pKey->szValue.c_str() ));
 }
 
 // GetBool
 // Returns the key value as a bool type. Returns false if the key is
 // not found.
-bool CDataFile::GetBool(t_Str szKey, t_Str szSection)
+bool CDataFile::GetBool(std::string_view szKey, std::string_view szSection)
 {
 	bool bValue = false;
-	t_Str szValue = GetValue(szKey, szSection);
+	const std::string_view szValue = GetValueView(szKey, szSection);
+	const st_nocase_equal IsEqualNoCase;
 
 	if ( szValue.find("1") == 0 
-		|| CompareNoCase(szValue, "true") == 0
-		|| CompareNoCase(szValue, "yes") == 0 )
+		|| IsEqualNoCase(szValue, "true")
+		|| IsEqualNoCase(szValue, "yes") )
 	{
 		bValue = true;
 	}
@@ -492,43 +672,38 @@ bool CDataFile::GetBool(t_Str szKey, t_Str szSection)
 // DeleteSection
 // Delete a specific section. Returns false if the section cannot be 
 // found or true when sucessfully deleted.
-bool CDataFile::DeleteSection(t_Str szSection)
+bool CDataFile::DeleteSection(std::string_view szSection)
 {
-	SectionItor s_pos;
+	const size_t nSection = FindSection(szSection);
 
-	for (s_pos = m_Sections.begin(); s_pos != m_Sections.end(); s_pos++)
-	{
-		if ( CompareNoCase( (*s_pos).szName, szSection ) == 0 ) 
-		{
-			m_Sections.erase(s_pos);
-			return true;
-		}
-	}
+	if ( nSection == IndexMap::npos )
+		return false;
 
-	return false;
+	m_Sections.erase(m_Sections.begin() + nSection);
+	RebuildSectionIndex();
+
+	return true;
 }
 
 // DeleteKey
 // Delete a specific key in a specific section. Returns false if the key
 // cannot be found or true when sucessfully deleted.
-bool CDataFile::DeleteKey(t_Str szKey, t_Str szFromSection)
+bool CDataFile::DeleteKey(std::string_view szKey, std::string_view szFromSection)
 {
-	KeyItor k_pos;
 	t_Section* pSection;
 
 	if ( (pSection = GetSection(szFromSection)) == NULL )
 		return false;
 
-	for (k_pos = pSection->Keys.begin(); k_pos != pSection->Keys.end(); k_pos++)
-	{
-		if ( CompareNoCase( (*k_pos).szKey, szKey ) == 0 )
-		{
-			pSection->Keys.erase(k_pos);
-			return true;
-		}
-	}
+	const size_t nKey = FindKey(pSection, szKey);
 
-	return false;
+	if ( nKey == IndexMap::npos )
+		return false;
+
+	pSection->Keys.erase(pSection->Keys.begin() + nKey);
+	RebuildKeyIndex(pSection);
+
+	return true;
 }
 
 // CreateKey
@@ -536,7 +711,7 @@ bool CDataFile::DeleteKey(t_Str szKey, t_Str szFromSection)
 // Key within the given section, and if it finds it, change the keys value to
 // the new value. If it does not locate the key, it will create a new key with
 // the proper value and place it in the section requested.
-bool CDataFile::CreateKey(t_Str szKey, t_Str szValue, t_Str szComment, t_Str szSection)
+bool CDataFile::CreateKey(const t_Str& szKey, const t_Str& szValue, const t_Str& szComment, const t_Str& szSection)
 {
 	bool bAutoKey = (m_Flags & AUTOCREATE_KEYS) == AUTOCREATE_KEYS;
 	bool bReturn  = false;
@@ -557,7 +732,7 @@ bool CDataFile::CreateKey(t_Str szKey, t_Str szValue, t_Str szComment, t_Str szS
 // allready exists in the list or not, if not, it creates the new section and
 // assigns it the comment given in szComment.  The function returns true if
 // sucessfully created, or false otherwise. 
-bool CDataFile::CreateSection(t_Str szSection, t_Str szComment)
+bool CDataFile::CreateSection(const t_Str& szSection, const t_Str& szComment)
 {
 	t_Section* pSection = GetSection(szSection);
 
@@ -567,11 +742,7 @@ bool CDataFile::CreateSection(t_Str szSection, t_Str szComment)
 		return false;
 	}
 
-	pSection = new t_Section;
-
-	pSection->szName = szSection;
-	pSection->szComment = szComment;
-	m_Sections.push_back(*pSection);
+	AddSection(szSection, szComment);
 	m_bDirty = true;
 
 	return true;
@@ -583,7 +754,7 @@ bool CDataFile::CreateSection(t_Str szSection, t_Str szComment)
 // assigns it the comment given in szComment.  The function returns true if
 // sucessfully created, or false otherwise. This version accpets a KeyList 
 // and sets up the newly created Section with the keys in the list.
-bool CDataFile::CreateSection(t_Str szSection, t_Str szComment, KeyList Keys)
+bool CDataFile::CreateSection(const t_Str& szSection, const t_Str& szComment, const KeyList& Keys)
 {
 	if ( !CreateSection(szSection, szComment) )
 		return false;
@@ -593,25 +764,27 @@ bool CDataFile::CreateSection(t_Str szSection, t_Str szComment, KeyList Keys)
 	if ( !pSection )
 		return false;
 
-	KeyItor k_pos;
+	KeyList::const_iterator k_pos;
 
-	pSection->szName = szSection;
 	for (k_pos = Keys.begin(); k_pos != Keys.end(); k_pos++)
 	{
-		t_Key* pKey = new t_Key;
-		pKey->szComment = (*k_pos).szComment;
-		pKey->szKey = (*k_pos).szKey;
-		pKey->szValue = (*k_pos).szValue;
-
-		pSection->Keys.push_back(*pKey);
+		// keep the first occurrence of a key, like a lookup in the list would.
+		if ( FindKey(pSection, (*k_pos).szKey) == IndexMap::npos )
+			AddKey(pSection, (*k_pos).szKey, (*k_pos).szValue, (*k_pos).szComment);
 	}
 
-	m_Sections.push_back(*pSection);
 	m_bDirty = true;
 
 	return true;
 }
 
+// HasSection
+// Returns true if a section with the given name exists.
+bool CDataFile::HasSection(std::string_view szSection)
+{
+	return GetSection(szSection) != NULL;
+}
+
 // SectionCount
 // Simply returns the number of sections in the list.
 int CDataFile::SectionCount() 
@@ -639,9 +812,8 @@ int CDataFile::KeyCount()
 // GetKey
 // Given a key and section name, looks up the key and if found, returns a
 // pointer to that key, otherwise returns NULL.
-t_Key*	CDataFile::GetKey(t_Str szKey, t_Str szSection)
+t_Key*	CDataFile::GetKey(std::string_view szKey, std::string_view szSection)
 {
-	KeyItor k_pos;
 	t_Section* pSection;
 
 	// Since our default section has a name value of t_Str("") this should
@@ -650,29 +822,163 @@ t_Key*	CDataFile::GetKey(t_Str szKey, t_Str szSection)
 	if ( (pSection = GetSection(szSection)) == NULL )
 		return NULL;
 
-	for (k_pos = pSection->Keys.begin(); k_pos != pSection->Keys.end(); k_pos++)
-	{
-		if ( CompareNoCase( (*k_pos).szKey, szKey ) == 0 )
-			return (t_Key*)&(*k_pos);
-	}
+	const size_t nKey = FindKey(pSection, szKey);
 
-	return NULL;
+	if ( nKey == IndexMap::npos )
+		return NULL;
+
+	return &pSection->Keys[nKey];
 }
 
 // GetSection
-// Given a section name, locates that section in the list and returns a pointer
-// to it. If the section was not found, returns NULL
-t_Section* CDataFile::GetSection(t_Str szSection)
+// Given a section name, locates that section through the section index and
+// returns a pointer to it. If the section was not found, returns NULL
+t_Section* CDataFile::GetSection(std::string_view szSection)
 {
-	SectionItor s_pos;
+	const size_t nSection = FindSection(szSection);
 
-	for (s_pos = m_Sections.begin(); s_pos != m_Sections.end(); s_pos++)
+	if ( nSection == IndexMap::npos )
+		return NULL;
+
+	return &m_Sections[nSection];
+}
+
+// FindSection
+// Returns the position of the section in the section list, IndexMap::npos if
+// there's no section with that name.
+size_t CDataFile::FindSection(std::string_view szSection) const
+{
+	return m_SectionIndex.Find(szSection, m_Sections, [](const t_Section& Section) -> std::string_view { return Section.szName; });
+}
+
+// FindKey
+// Returns the position of the key in the section's key list, IndexMap::npos
+// if the section has no key with that name.
+size_t CDataFile::FindKey(const t_Section* pSection, std::string_view szKey) const
+{
+	return pSection->KeyIndex.Find(szKey, pSection->Keys, [](const t_Key& Key) -> std::string_view { return Key.szKey; });
+}
+
+// AddSection
+// Appends a new section at the end of the list, so file order is preserved,
+// and registers it in the section index. The caller is responsible for
+// checking that the section doesn't exist yet.
+t_Section* CDataFile::AddSection(std::string_view szSection, std::string_view szComment)
+{
+	t_Section& Section = m_Sections.emplace_back();
+
+	Section.szName = szSection;
+	Section.szComment = szComment;
+	m_SectionIndex.Insert(Section.szName, m_Sections.size() - 1);
+
+	return &Section;
+}
+
+// AddKey
+// Appends a new key at the end of the section's key list and registers it
+// in the section's key index. The caller is responsible for checking that
+// the key doesn't exist yet.
+void CDataFile::AddKey(t_Section* pSection, std::string_view szKey, std::string_view szValue, std::string_view szComment)
+{
+	t_Key& Key = pSection->Keys.emplace_back();
+
+	Key.szKey = szKey;
+	Key.szValue = szValue;
+	Key.szComment = szComment;
+	pSection->KeyIndex.Insert(Key.szKey, pSection->Keys.size() - 1);
+}
+
+// LoadKey
+// Adds the key, or overwrites the earlier key with the same name, as the last
+// occurrence in the file wins. Indexes the name before the key exists, so the
+// name is hashed and looked up only once per key.
+void CDataFile::LoadKey(t_Section* pSection, std::string_view szKey, std::string_view szValue, std::string_view szComment)
+{
+	const size_t nKey = pSection->KeyIndex.Add(szKey, pSection->Keys.size(), pSection->Keys, [](const t_Key& Key) -> std::string_view { return Key.szKey; });
+
+	t_Key& Key = nKey == IndexMap::npos ? pSection->Keys.emplace_back() : pSection->Keys[nKey];
+
+	if ( nKey == IndexMap::npos )
+		Key.szKey = szKey;
+
+	Key.szValue = szValue;
+
+	// a new key's comment is empty already, and most keys have none
+	if ( Key.szComment.size() > 0 || szComment.size() > 0 )
+		Key.szComment = szComment;
+}
+
+// RebuildSectionIndex
+// Recreates the section index from the section list. Needed after a section
+// has been removed, as the positions of all following sections shift.
+void CDataFile::RebuildSectionIndex()
+{
+	m_SectionIndex.Clear();
+
+	for (size_t i = 0; i < m_Sections.size(); i++)
+		m_SectionIndex.Insert(m_Sections[i].szName, i);
+}
+
+// RebuildKeyIndex
+// Recreates the key index of a section from its key list. Needed after a key
+// has been removed, as the positions of all following keys shift.
+void CDataFile::RebuildKeyIndex(t_Section* pSection)
+{
+	pSection->KeyIndex.Clear();
+
+	for (size_t i = 0; i < pSection->Keys.size(); i++)
+		pSection->KeyIndex.Insert(pSection->Keys[i].szKey, i);
+}
+
+// IndexMap::Insert
+// Adds the name's slot, growing the table first if that would fill it more
+// than half, which keeps the probe sequences short.
+void IndexMap::Insert(std::string_view szName, size_t nPosition)
+{
+	Reserve(m_nCount + 1);
+	InsertSlot(st_slot{ HashName(szName), static_cast<uint32_t>(nPosition + 1) });
+	m_nCount++;
+}
+
+// IndexMap::Reserve
+// Grows the table so it holds the given number of names at most half full.
+void IndexMap::Reserve(size_t nAmountNames)
+{
+	if ( nAmountNames * 2 <= m_Slots.size() )
+		return;
+
+	size_t nAmountSlots = m_Slots.empty() ? 16 : m_Slots.size();
+
+	while ( nAmountNames * 2 > nAmountSlots )
+		nAmountSlots *= 2;
+
+	std::vector<st_slot> OldSlots = std::move(m_Slots);
+
+	m_Slots.assign(nAmountSlots, st_slot{ 0, 0 });
+	m_nMask = nAmountSlots - 1;
+
+	for (const st_slot& Slot : OldSlots)
 	{
-		if ( CompareNoCase( (*s_pos).szName, szSection ) == 0 ) 
-			return (t_Section*)&(*s_pos);
+		if ( Slot.nPosition != 0 )
+			InsertSlot(Slot);
 	}
+}
+
+void IndexMap::InsertSlot(st_slot Slot)
+{
+	size_t nSlot = Slot.nHash & m_nMask;
+
+	while ( m_Slots[nSlot].nPosition != 0 )
+		nSlot = (nSlot + 1) & m_nMask;
+
+	m_Slots[nSlot] = Slot;
+}
 
-	return NULL;
+void IndexMap::Clear()
+{
+	m_Slots.clear();
+	m_nMask = 0;
+	m_nCount = 0;
 }
 
 
@@ -730,7 +1036,7 @@ t_Str GetNextWord(t_Str& CommandLine)
 // it's amazing what features std::string lacks.  This function simply
 // does a lowercase compare against the two strings, returning 0 if they
 // match.
-int CompareNoCase(t_Str str1, t_Str str2)
+int CompareNoCase(const t_Str& str1, const t_Str& str2)
 {
 #ifdef WIN32
 	return _stricmp(str1.c_str(), str2.c_str());
@@ -739,6 +1045,62 @@ int CompareNoCase(t_Str str1, t_Str str2)
 #endif
 }
 
+// ToLowerAscii
+// Lowercases A-Z only. Section and key names are ASCII, and unlike tolower()
+// this doesn't call into the C runtime's locale for every character.
+static inline unsigned char ToLowerAscii(char c)
+{
+	const unsigned char uc = static_cast<unsigned char>(c);
+
+	return static_cast<unsigned char>(uc - 'A') < 26 ? static_cast<unsigned char>(uc | 0x20) : uc;
+}
+
+// st_nocase_hash
+// Hashes eight characters at a time, with bit 5 of every character set so
+// two names which CompareNoCase considers equal always hash to the same value.
+// That also folds a few non-letters onto each other, which only costs the
+// name compare a lookup does anyway.
+size_t st_nocase_hash::operator()(std::string_view szStr) const
+{
+	const uint64_t nFold = 0x2020202020202020ULL;
+	const uint64_t nMultiplier = 0x9E3779B97F4A7C15ULL;
+	uint64_t nHash = szStr.size() * nMultiplier;
+	size_t i = 0;
+
+	for (; i + 8 <= szStr.size(); i += 8)
+	{
+		uint64_t nWord;
+		memcpy(&nWord, szStr.data() + i, 8);
+		nHash = (nHash ^ (nWord | nFold)) * nMultiplier;
+		nHash ^= nHash >> 29;
+	}
+
+	if ( i < szStr.size() )
+	{
+		uint64_t nWord = 0;
+		memcpy(&nWord, szStr.data() + i, szStr.size() - i);
+		nHash = (nHash ^ (nWord | nFold)) * nMultiplier;
+	}
+
+	return static_cast<size_t>(nHash ^ (nHash >> 32));
+}
+
+// st_nocase_equal
+// Lowercase compare of the two names, returning true if they match.
+bool st_nocase_equal::operator()(std::string_view szLhs, std::string_view szRhs) const
+{
+	if ( szLhs.size() != szRhs.size() )
+		return false;
+
+	for (size_t i = 0; i < szLhs.size(); i++)
+	{
+		if ( ToLowerAscii(szLhs[i]) != ToLowerAscii(szRhs[i]) )
+			return false;
+	}
+
+	return true;
+}
+
 // Trim
 // Trims whitespace from both sides of a string.
 void Trim(t_Str& szStr)
@@ -775,9 +1137,13 @@ int WriteLn(std::fstream& stream, const char* fmt, ...)
 	va_list args;
 
 	va_start (args, fmt);
-	  nLength = _vsnprintf_s(buf, MAX_BUFFER_LEN, fmt, args);
+	  nLength = vsnprintf(buf, MAX_BUFFER_LEN, fmt, args);
 	va_end (args);
 
+	// Longer lines are cut off, leaving room for the line break. Depending on
+	// the runtime, vsnprintf returns -1 or the untruncated length for them.
+	if ( nLength < 0 || nLength > MAX_BUFFER_LEN - 1 )
+		nLength = MAX_BUFFER_LEN - 1;
 
 	if ( buf[nLength] != '\n' && buf[nLength] != '\r' )
 		buf[nLength++] = '\n';
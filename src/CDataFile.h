@@ -17,6 +17,8 @@
 #include <vector>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <cstdint>
 
 using namespace std;
 
@@ -35,8 +37,8 @@ using namespace std;
 
 // MAX_BUFFER_LEN
 // Used simply as a max size of some internal buffers. Determines the maximum
-// length of a line that will be read from or written to the file or the
-// report output.
+// length of a line that will be written to the file or the report output.
+// Reading has no line length limit.
 #define MAX_BUFFER_LEN				512
 
 
@@ -91,6 +93,107 @@ const t_Str EqualIndicators   = t_Str("=:");
 // the head and tail of strings.
 const t_Str WhiteSpace = t_Str(" \t\n\r");
 
+// st_nocase_hash, st_nocase_equal
+// Case insensitive hash and equality functors. Used by the section and key
+// indices so lookups through them match the CompareNoCase semantics. Both are
+// transparent so lookups can be done without creating a t_Str first.
+struct st_nocase_hash
+{
+	typedef void is_transparent;
+	size_t operator()(std::string_view szStr) const;
+};
+
+struct st_nocase_equal
+{
+	typedef void is_transparent;
+	bool operator()(std::string_view szLhs, std::string_view szRhs) const;
+};
+
+// IndexMap
+// Maps a section or key name to its position in the SectionList or KeyList.
+// The lists themselves stay the authoritative, ordered storage so Save() writes
+// everything back in file order; the index only speeds up the lookups. It's an
+// open addressing table of positions and name hashes, and compares against the
+// names in the list itself, so indexing a name neither copies it nor allocates.
+class IndexMap
+{
+public:
+	static const size_t npos = SIZE_MAX;
+
+				// Find: Returns the position of the name in the list, npos if
+				// it's not indexed. GetName returns the name of a list element.
+	template<typename List, typename GetName>
+	size_t		Find(std::string_view szName, const List& list, GetName getName) const
+	{
+		if ( m_nCount == 0 )
+			return npos;
+
+		const st_slot& Slot = m_Slots[FindSlot(szName, HashName(szName), list, getName)];
+
+		return Slot.nPosition != 0 ? Slot.nPosition - 1 : npos;
+	}
+				// Add: Indexes the name at the given position, unless it's
+				// indexed already. Returns the position it's indexed at then,
+				// npos if it has been added. Hashes and probes only once, where
+				// Find followed by Insert would do both twice.
+	template<typename List, typename GetName>
+	size_t		Add(std::string_view szName, size_t nPosition, const List& list, GetName getName)
+	{
+		Reserve(m_nCount + 1);
+
+		const uint32_t nHash = HashName(szName);
+		st_slot& Slot = m_Slots[FindSlot(szName, nHash, list, getName)];
+
+		if ( Slot.nPosition != 0 )
+			return Slot.nPosition - 1;
+
+		Slot = st_slot{ nHash, static_cast<uint32_t>(nPosition + 1) };
+		m_nCount++;
+
+		return npos;
+	}
+				// Insert: Indexes the name at the given position. The caller is
+				// responsible for checking that the name isn't indexed yet.
+	void		Insert(std::string_view szName, size_t nPosition);
+				// Reserve: Makes room for the given number of names in total.
+	void		Reserve(size_t nAmountNames);
+	void		Clear();
+	size_t		Size() const { return m_nCount; }
+
+private:
+	struct st_slot
+	{
+		uint32_t	nHash;
+		uint32_t	nPosition;	// position in the list + 1, 0 for an empty slot
+	};
+
+	static uint32_t HashName(std::string_view szName) { return static_cast<uint32_t>(st_nocase_hash()(szName)); }
+
+				// FindSlot: Returns the slot holding the name, or the empty slot
+				// ending its probe sequence. The table must not be empty.
+	template<typename List, typename GetName>
+	size_t		FindSlot(std::string_view szName, uint32_t nHash, const List& list, GetName getName) const
+	{
+		const st_nocase_equal IsEqualNoCase;
+		size_t nSlot = nHash & m_nMask;
+
+		for (; m_Slots[nSlot].nPosition != 0; nSlot = (nSlot + 1) & m_nMask)
+		{
+			const st_slot& Slot = m_Slots[nSlot];
+
+			if ( Slot.nHash == nHash && IsEqualNoCase(getName(list[Slot.nPosition - 1]), szName) )
+				break;
+		}
+
+		return nSlot;
+	}
+	void		InsertSlot(st_slot Slot);
+
+	std::vector<st_slot>	m_Slots;
+	size_t					m_nMask = 0;
+	size_t					m_nCount = 0;
+};
+
 // st_key
 // This structure stores the definition of a key. A key is a named identifier
 // that is associated with a value. It may or may not have a comment.  All comments
@@ -101,13 +204,6 @@ typedef struct st_key
 	t_Str		szValue;
 	t_Str		szComment;
 
-	st_key()
-	{
-		szKey = t_Str("");
-		szValue = t_Str("");
-		szComment = t_Str("");
-	}
-
 } t_Key;
 
 typedef std::vector<t_Key> KeyList;
@@ -122,12 +218,14 @@ typedef struct st_section
 	t_Str		szName;
 	t_Str		szComment;
 	KeyList		Keys;
+	IndexMap	KeyIndex;	// key name -> position in Keys
 
 	st_section()
 	{
 		szName = t_Str("");
 		szComment = t_Str("");
 		Keys.clear();
+		KeyIndex.Clear();
 	}
 
 } t_Section;
@@ -141,7 +239,7 @@ typedef SectionList::iterator SectionItor;
 /////////////////////////////////////////////////////////////////////////////////
 void	Report(e_DebugLevel DebugLevel, const char *fmt, ...);
 t_Str	GetNextWord(t_Str& CommandLine);
-int		CompareNoCase(t_Str str1, t_Str str2);
+int		CompareNoCase(const t_Str& str1, const t_Str& str2);
 void	Trim(t_Str& szStr);
 int		WriteLn(fstream& stream, const char* fmt, ...);
 
@@ -158,67 +256,74 @@ public:
 				// Constructors & Destructors
 				/////////////////////////////////////////////////////////////////
 				CDataFile();
-				CDataFile(t_Str szFileName);
+				CDataFile(const t_Str& szFileName);
 	virtual		~CDataFile();
 
 				// File handling methods
 				/////////////////////////////////////////////////////////////////
-	bool		Load(t_Str szFileName);
+	bool		Load(const t_Str& szFileName);
 	bool		Save();
 
 				// Data handling methods
 				/////////////////////////////////////////////////////////////////
 
+				// The Get methods take the key and section as string_views, so
+				// lookups with literals or substrings don't allocate.
+
 				// GetValue: Our default access method. Returns the raw t_Str value
 				// Note that this returns keys specific to the given section only.
-	t_Str		GetValue(t_Str szKey, t_Str szSection = t_Str("")); 
+	t_Str		GetValue(std::string_view szKey, std::string_view szSection = std::string_view()); 
+				// GetValueView: Like GetValue, but returns a view on the stored
+				// value instead of a copy. The view is valid until the key is
+				// changed or removed.
+	std::string_view	GetValueView(std::string_view szKey, std::string_view szSection = std::string_view()); 
 				// GetString: Returns the value as a t_Str
-	t_Str		GetString(t_Str szKey, t_Str szSection = t_Str("")); 
+	t_Str		GetString(std::string_view szKey, std::string_view szSection = std::string_view()); 
 				// GetFloat: Return the value as a float
-	float		GetFloat(t_Str szKey, t_Str szSection = t_Str(""));
+	float		GetFloat(std::string_view szKey, std::string_view szSection = std::string_view());
 				// GetInt: Return the value as an int
-	int			GetInt(t_Str szKey, t_Str szSection = t_Str(""));
+	int			GetInt(std::string_view szKey, std::string_view szSection = std::string_view());
 				// GetUInt: Return the value as an int
-	uint32_t	GetUInt(t_Str szKey, t_Str szSection = t_Str(""));
+	uint32_t	GetUInt(std::string_view szKey, std::string_view szSection = std::string_view());
 				// GetBool: Return the value as a bool
-	bool		GetBool(t_Str szKey, t_Str szSection = t_Str(""));
+	bool		GetBool(std::string_view szKey, std::string_view szSection = std::string_view());
 
 				// SetValue: Sets the value of a given key. Will create the
 				// key if it is not found and AUTOCREATE_KEYS is active.
-	bool		SetValue(t_Str szKey, t_Str szValue, 
-						 t_Str szComment = t_Str(""), t_Str szSection = t_Str(""));
+	bool		SetValue(const t_Str& szKey, const t_Str& szValue, 
+						 const t_Str& szComment = t_Str(""), const t_Str& szSection = t_Str(""));
 
 				// SetFloat: Sets the value of a given key. Will create the
 				// key if it is not found and AUTOCREATE_KEYS is active.
-	bool		SetFloat(t_Str szKey, float fValue, 
-						 t_Str szComment = t_Str(""), t_Str szSection = t_Str(""));
+	bool		SetFloat(const t_Str& szKey, float fValue, 
+						 const t_Str& szComment = t_Str(""), const t_Str& szSection = t_Str(""));
 
 				// SetInt: Sets the value of a given key. Will create the
 				// key if it is not found and AUTOCREATE_KEYS is active.
-	bool		SetInt(t_Str szKey, int nValue, 
-						 t_Str szComment = t_Str(""), t_Str szSection = t_Str(""));
+	bool		SetInt(const t_Str& szKey, int nValue, 
+						 const t_Str& szComment = t_Str(""), const t_Str& szSection = t_Str(""));
 
 				// SetUInt: Sets the value of a given key. Will create the
 				// key if it is not found and AUTOCREATE_KEYS is active.
-	bool		SetUInt(t_Str szKey, uint32_t nValue, 
-						 t_Str szComment = t_Str(""), t_Str szSection = t_Str(""));
+	bool		SetUInt(const t_Str& szKey, uint32_t nValue, 
+						 const t_Str& szComment = t_Str(""), const t_Str& szSection = t_Str(""));
 
 				// SetBool: Sets the value of a given key. Will create the
 				// key if it is not found and AUTOCREATE_KEYS is active.
-	bool		SetBool(t_Str szKey, bool bValue, 
-						 t_Str szComment = t_Str(""), t_Str szSection = t_Str(""));
+	bool		SetBool(const t_Str& szKey, bool bValue, 
+						 const t_Str& szComment = t_Str(""), const t_Str& szSection = t_Str(""));
 
 				// Sets the comment for a given key.
-	bool		SetKeyComment(t_Str szKey, t_Str szComment, t_Str szSection = t_Str(""));
+	bool		SetKeyComment(const t_Str& szKey, const t_Str& szComment, const t_Str& szSection = t_Str(""));
 
 				// Sets the comment for a given section
-	bool		SetSectionComment(t_Str szSection, t_Str szComment);
+	bool		SetSectionComment(const t_Str& szSection, const t_Str& szComment);
 
 				// DeleteKey: Deletes a given key from a specific section
-	bool		DeleteKey(t_Str szKey, t_Str szFromSection = t_Str(""));
+	bool		DeleteKey(std::string_view szKey, std::string_view szFromSection = std::string_view());
 
 				// DeleteSection: Deletes a given section.
-	bool		DeleteSection(t_Str szSection);
+	bool		DeleteSection(std::string_view szSection);
 				
 				// Key/Section handling methods
 				/////////////////////////////////////////////////////////////////
@@ -226,17 +331,20 @@ public:
 				// CreateKey: Creates a new key in the requested section. The
 	            // Section will be created if it does not exist and the 
 				// AUTOCREATE_SECTIONS bit is set.
-	bool		CreateKey(t_Str szKey, t_Str szValue, 
-		                  t_Str szComment = t_Str(""), t_Str szSection = t_Str(""));
+	bool		CreateKey(const t_Str& szKey, const t_Str& szValue, 
+		                  const t_Str& szComment = t_Str(""), const t_Str& szSection = t_Str(""));
 				// CreateSection: Creates the new section if it does not allready
 				// exist. Section is created with no keys.
-	bool		CreateSection(t_Str szSection, t_Str szComment = t_Str(""));
+	bool		CreateSection(const t_Str& szSection, const t_Str& szComment = t_Str(""));
 				// CreateSection: Creates the new section if it does not allready
 				// exist, and copies the keys passed into it into the new section.
-	bool		CreateSection(t_Str szSection, t_Str szComment, KeyList Keys);
+	bool		CreateSection(const t_Str& szSection, const t_Str& szComment, const KeyList& Keys);
 
 				// Utility Methods
 				/////////////////////////////////////////////////////////////////
+				// HasSection: Returns true if the section exists, even if it has
+				// no keys.
+	bool		HasSection(std::string_view szSection);
 				// SectionCount: Returns the number of valid sections in the database.
 	int			SectionCount();
 				// KeyCount: Returns the total number of keys, across all sections.
@@ -245,7 +353,7 @@ public:
 	void		Clear();
 				// SetFileName: For use when creating the object by hand
 				// initializes the file name so that it can be later saved.
-	void		SetFileName(t_Str szFileName);
+	void		SetFileName(const t_Str& szFileName);
 				// CommentStr
 				// Parses a string into a proper comment token/comment.
 	t_Str		CommentStr(t_Str szComment);				
@@ -263,9 +371,26 @@ protected:
 
 				// GetKey: Returns the requested key (if found) from the requested
 				// Section. Returns NULL otherwise.
-	t_Key*		GetKey(t_Str szKey, t_Str szSection);
+	t_Key*		GetKey(std::string_view szKey, std::string_view szSection);
 				// GetSection: Returns the requested section (if found), NULL otherwise.
-	t_Section*	GetSection(t_Str szSection);
+	t_Section*	GetSection(std::string_view szSection);
+				// FindSection / FindKey: Return the position of the section or
+				// key in its list through the index, IndexMap::npos if not found.
+	size_t		FindSection(std::string_view szSection) const;
+	size_t		FindKey(const t_Section* pSection, std::string_view szKey) const;
+				// AddSection: Appends a new section to the list and the section index,
+				// without checking whether it exists. Returns the new section.
+	t_Section*	AddSection(std::string_view szSection, std::string_view szComment);
+				// AddKey: Appends a new key to the given section and its key index,
+				// without checking whether it exists.
+	void		AddKey(t_Section* pSection, std::string_view szKey, std::string_view szValue, std::string_view szComment);
+				// LoadKey: Adds a key read by Load, or overwrites the value and
+				// comment of an earlier key with the same name in the section.
+	void		LoadKey(t_Section* pSection, std::string_view szKey, std::string_view szValue, std::string_view szComment);
+				// RebuildSectionIndex / RebuildKeyIndex: Recreates the index after
+				// elements have been removed from the middle of a list.
+	void		RebuildSectionIndex();
+	void		RebuildKeyIndex(t_Section* pSection);
 
 
 // Data
@@ -274,6 +399,7 @@ public:
 
 protected:
 	SectionList	m_Sections;		// Our list of sections
+	IndexMap	m_SectionIndex;	// section name -> position in m_Sections
 	t_Str		m_szFileName;	// The filename to write to
 	bool		m_bDirty;		// Tracks whether or not data has changed.
 };
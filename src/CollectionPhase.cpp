@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "CollectionPhase.h"
+
+namespace ShaderToggler
+{
+	void CollectionPhase::start(uint32_t maxFrameCount, uint32_t convergenceFrameCount)
+	{
+		_maxFrameCount = maxFrameCount;
+		_convergenceFrameCount = convergenceFrameCount;
+		_framesCollected = 0;
+		_framesWithoutNewShaders = 0;
+		_lastAmountShadersCollected = 0;
+		_hasConverged = false;
+		_isCollecting.store(maxFrameCount > 0, std::memory_order_relaxed);
+	}
+
+
+	void CollectionPhase::stop()
+	{
+		_isCollecting.store(false, std::memory_order_relaxed);
+	}
+
+
+	void CollectionPhase::onFramePresented(uint32_t amountShadersCollected)
+	{
+		if(!isCollecting())
+		{
+			return;
+		}
+		_framesCollected++;
+		if(amountShadersCollected > _lastAmountShadersCollected)
+		{
+			_lastAmountShadersCollected = amountShadersCollected;
+			_framesWithoutNewShaders = 0;
+		}
+		else if(amountShadersCollected > 0)
+		{
+			// only count once something has been collected, so a few frames without draws (e.g. a loading screen) don't end the phase.
+			_framesWithoutNewShaders++;
+		}
+		_hasConverged = isAdaptive() && _framesWithoutNewShaders >= _convergenceFrameCount;
+		if(_hasConverged || _framesCollected >= _maxFrameCount)
+		{
+			stop();
+		}
+	}
+}
@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Tracks the collection phase which runs when the shaders of a group are edited, during which the shaders of bound pipelines are collected
+	/// so they can be hunted. The phase ends after a maximum number of frames or, if a convergence window is set, as soon as no new shader has
+	/// been collected for that many frames, whichever comes first. isCollecting is read by the pipeline bind hooks, everything else is only used
+	/// on the present thread.
+	/// </summary>
+	class CollectionPhase
+	{
+	public:
+		/// <summary>
+		/// Starts a new collection phase.
+		/// </summary>
+		/// <param name="maxFrameCount">the number of frames after which collection always ends</param>
+		/// <param name="convergenceFrameCount">the number of frames without new shaders after which collection ends. 0 to always collect
+		/// maxFrameCount frames</param>
+		void start(uint32_t maxFrameCount, uint32_t convergenceFrameCount);
+		void stop();
+		/// <summary>
+		/// Called once per presented frame with the total number of shaders collected so far. Ends the phase when the maximum number of
+		/// frames has been reached or the collected set has converged.
+		/// </summary>
+		/// <param name="amountShadersCollected"></param>
+		void onFramePresented(uint32_t amountShadersCollected);
+
+		bool isCollecting() const { return _isCollecting.load(std::memory_order_relaxed); }
+		bool hasConverged() const { return _hasConverged; }
+		bool isAdaptive() const { return _convergenceFrameCount > 0; }
+		uint32_t getFramesCollected() const { return _framesCollected; }
+		uint32_t getMaxFrameCount() const { return _maxFrameCount; }
+		uint32_t getFramesWithoutNewShaders() const { return _framesWithoutNewShaders; }
+		uint32_t getConvergenceFrameCount() const { return _convergenceFrameCount; }
+
+	private:
+		std::atomic<bool> _isCollecting = false;
+		bool _hasConverged = false;
+		uint32_t _maxFrameCount = 0;
+		uint32_t _convergenceFrameCount = 0;
+		uint32_t _framesCollected = 0;
+		uint32_t _framesWithoutNewShaders = 0;
+		uint32_t _lastAmountShadersCollected = 0;
+	};
+}
@@ -0,0 +1,261 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "CompiledProfile.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace ShaderToggler
+{
+	// the tables of the slicing-by-8 crc32: entry i of table n is the crc of byte i followed by n zero bytes.
+	static constexpr std::array<std::array<uint32_t, 256>, 8> CRC32_TABLES = []()
+		{
+			std::array<std::array<uint32_t, 256>, 8> tables{};
+			for(uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t crc = i;
+				for(int bit = 0; bit < 8; bit++)
+				{
+					crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+				}
+				tables[0][i] = crc;
+			}
+			for(size_t table = 1; table < tables.size(); table++)
+			{
+				for(uint32_t i = 0; i < 256; i++)
+				{
+					tables[table][i] = (tables[table - 1][i] >> 8) ^ tables[0][tables[table - 1][i] & 0xFF];
+				}
+			}
+			return tables;
+		}();
+
+
+	/// <summary>
+	/// The same crc32 as compute_crc32 in crc32_hash.hpp, but 8 bytes per step instead of 1: the lookup tables make up most of the file, so
+	/// checking it at load time byte by byte would take longer than parsing the ini file.
+	/// </summary>
+	static uint32_t computeChecksum(const uint8_t* data, size_t size)
+	{
+		uint32_t crc = 0xFFFFFFFF;
+		for(; size >= 8; size -= 8, data += 8)
+		{
+			// the file is little endian, as are the platforms it's used on.
+			uint32_t low;
+			uint32_t high;
+			std::memcpy(&low, data, sizeof(low));
+			std::memcpy(&high, data + sizeof(low), sizeof(high));
+			low ^= crc;
+			crc = CRC32_TABLES[7][low & 0xFF] ^ CRC32_TABLES[6][(low >> 8) & 0xFF] ^ CRC32_TABLES[5][(low >> 16) & 0xFF] ^ CRC32_TABLES[4][low >> 24] ^
+				  CRC32_TABLES[3][high & 0xFF] ^ CRC32_TABLES[2][(high >> 8) & 0xFF] ^ CRC32_TABLES[1][(high >> 16) & 0xFF] ^ CRC32_TABLES[0][high >> 24];
+		}
+		for(; size != 0; size--, data++)
+		{
+			crc = (crc >> 8) ^ CRC32_TABLES[0][(crc ^ *data) & 0xFF];
+		}
+		return ~crc;
+	}
+
+
+	static void appendToBlock(std::vector<uint8_t>& block, const void* data, size_t size)
+	{
+		const auto bytes = static_cast<const uint8_t*>(data);
+		block.insert(block.end(), bytes, bytes + size);
+	}
+
+
+	static void alignBlock(std::vector<uint8_t>& block)
+	{
+		block.resize((block.size() + 3) & ~static_cast<size_t>(3), 0);
+	}
+
+
+	bool CompiledProfile::write(const std::string& fileName, const std::vector<ToggleGroup>& groups, uint32_t flags, const FileStamp& sourceFileStamp)
+	{
+		const size_t dataStart = sizeof(CompiledProfileHeader) + groups.size() * sizeof(CompiledProfileGroup);
+		std::vector<CompiledProfileGroup> groupRecords(groups.size());
+		std::vector<uint8_t> data;
+		for(size_t i = 0; i < groups.size(); i++)
+		{
+			const ToggleGroup& group = groups[i];
+			CompiledProfileGroup& record = groupRecords[i];
+			const std::string& name = group.getName();
+			record.nameOffset = static_cast<uint32_t>(dataStart + data.size());
+			record.nameLength = static_cast<uint32_t>(name.size());
+			appendToBlock(data, name.data(), name.size());
+			record.toggleKey = group.getToggleKeyForIniFile();
+			record.isActiveAtStartup = group.isActiveAtStartup() ? 1 : 0;
+			record.isPerformanceGroup = group.isPerformanceGroup() ? 1 : 0;
+			record.performancePriority = group.getPerformancePriority();
+			record.throttleMode = static_cast<uint32_t>(group.getThrottleMode());
+			record.throttleValue = group.getThrottleValue();
+
+			const ShaderHashSet* stageHashes[ShaderStageCount] = { &group.getVertexShaderHashes(), &group.getPixelShaderHashes(), &group.getComputeShaderHashes() };
+			for(uint32_t stage = 0; stage < ShaderStageCount; stage++)
+			{
+				const std::span<const uint32_t> layout = stageHashes[stage]->getLayout();
+				alignBlock(data);
+				record.hashesOffset[stage] = static_cast<uint32_t>(dataStart + data.size());
+				record.hashesCount[stage] = static_cast<uint32_t>(stageHashes[stage]->size());
+				record.hashesSlotBits[stage] = stageHashes[stage]->getSlotBits();
+				appendToBlock(data, layout.data(), layout.size_bytes());
+			}
+		}
+
+		std::vector<uint8_t> payload;
+		payload.reserve(dataStart - sizeof(CompiledProfileHeader) + data.size());
+		appendToBlock(payload, groupRecords.data(), groupRecords.size() * sizeof(CompiledProfileGroup));
+		appendToBlock(payload, data.data(), data.size());
+
+		CompiledProfileHeader header;
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.checksum = computeChecksum(payload.data(), payload.size());
+		header.fileSize = static_cast<uint32_t>(sizeof(CompiledProfileHeader) + payload.size());
+		header.groupCount = static_cast<uint32_t>(groups.size());
+		header.flags = flags;
+		header.sourceFileSize = sourceFileStamp.size;
+		header.sourceFileWriteTime = sourceFileStamp.lastWriteTime.time_since_epoch().count();
+
+		// the file may be mapped by a running load, so it's never rewritten in place: the new contents go to a file of their own, which then
+		// replaces the old file as a whole.
+		const std::string temporaryFileName = fileName + ".tmp";
+		std::ofstream file(temporaryFileName, std::ios::out | std::ios::trunc | std::ios::binary);
+		if(!file.is_open())
+		{
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+		file.close();
+		std::error_code errorCode;
+		if(!file.good())
+		{
+			std::filesystem::remove(temporaryFileName, errorCode);
+			return false;
+		}
+		std::filesystem::rename(temporaryFileName, fileName, errorCode);
+		if(errorCode)
+		{
+			std::filesystem::remove(temporaryFileName, errorCode);
+			return false;
+		}
+		return true;
+	}
+
+
+	bool CompiledProfile::isCompiledFrom(const FileStamp& iniFileStamp) const
+	{
+		return nullptr != _header && iniFileStamp.exists && _header->sourceFileSize == iniFileStamp.size && 
+			   _header->sourceFileWriteTime == static_cast<int64_t>(iniFileStamp.lastWriteTime.time_since_epoch().count());
+	}
+
+
+	bool CompiledProfile::open(const std::string& fileName)
+	{
+		_header = nullptr;
+		_groups = nullptr;
+		// sets loaded from a previously opened file keep that mapping alive, so this one gets a mapping of its own.
+		_file = std::make_shared<MappedFile>();
+		if(!_file->open(fileName) || _file->getSize() < sizeof(CompiledProfileHeader))
+		{
+			return false;
+		}
+		const auto header = reinterpret_cast<const CompiledProfileHeader*>(_file->getData());
+		if(header->magic != MAGIC || header->version != VERSION || header->fileSize != _file->getSize())
+		{
+			return false;
+		}
+		const size_t dataStart = sizeof(CompiledProfileHeader) + static_cast<size_t>(header->groupCount) * sizeof(CompiledProfileGroup);
+		if(dataStart > _file->getSize())
+		{
+			return false;
+		}
+		const auto payload = reinterpret_cast<const uint8_t*>(_file->getData()) + sizeof(CompiledProfileHeader);
+		if(computeChecksum(payload, _file->getSize() - sizeof(CompiledProfileHeader)) != header->checksum)
+		{
+			return false;
+		}
+		// the checksum only protects against corruption, the offsets are still checked so a bad file can't make us read outside the mapping.
+		const auto groups = reinterpret_cast<const CompiledProfileGroup*>(payload);
+		for(uint32_t i = 0; i < header->groupCount; i++)
+		{
+			const CompiledProfileGroup& group = groups[i];
+			if(group.nameOffset < dataStart || static_cast<uint64_t>(group.nameOffset) + group.nameLength > _file->getSize())
+			{
+				return false;
+			}
+			for(uint32_t stage = 0; stage < ShaderStageCount; stage++)
+			{
+				size_t layoutSize = 0;
+				if(!ShaderHashSet::getLayoutSize(group.hashesCount[stage], group.hashesSlotBits[stage], layoutSize) || group.hashesOffset[stage] < dataStart ||
+				   (group.hashesOffset[stage] & 3) != 0 || static_cast<uint64_t>(group.hashesOffset[stage]) + static_cast<uint64_t>(layoutSize) * sizeof(uint32_t) > _file->getSize())
+				{
+					return false;
+				}
+			}
+		}
+		_header = header;
+		_groups = groups;
+		return true;
+	}
+
+
+	std::string_view CompiledProfile::getGroupName(uint32_t groupIndex) const
+	{
+		const CompiledProfileGroup& group = _groups[groupIndex];
+		return std::string_view(_file->getData() + group.nameOffset, group.nameLength);
+	}
+
+
+	DrawThrottleMode CompiledProfile::getThrottleMode(uint32_t groupIndex) const
+	{
+		// the file is validated as a whole, but an out of range mode would still end up in a switch on it.
+		const uint32_t throttleMode = _groups[groupIndex].throttleMode;
+		return throttleMode < static_cast<uint32_t>(DrawThrottleMode::Count) ? static_cast<DrawThrottleMode>(throttleMode) : DrawThrottleMode::HideAll;
+	}
+
+
+	void CompiledProfile::assignHashes(uint32_t groupIndex, ShaderStage stage, ShaderHashSet& destination) const
+	{
+		// the layout was validated when the file was opened.
+		const CompiledProfileGroup& group = _groups[groupIndex];
+		size_t layoutSize = 0;
+		ShaderHashSet::getLayoutSize(group.hashesCount[stage], group.hashesSlotBits[stage], layoutSize);
+		const std::span<const uint32_t> layout(reinterpret_cast<const uint32_t*>(_file->getData() + group.hashesOffset[stage]), layoutSize);
+		destination.assignLayout(layout, group.hashesCount[stage], group.hashesSlotBits[stage], _file);
+	}
+}
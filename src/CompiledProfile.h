@@ -0,0 +1,146 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FileChangeWatcher.h"
+#include "MappedFile.h"
+#include "ToggleGroup.h"
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Compiled, binary version of the toggle groups in the ini file. It's stored next to the ini file together with the size and last write
+	/// time of the ini file it was compiled from, and is regenerated whenever the ini file doesn't match these anymore. The file is memory mapped
+	/// and read without any parsing: the hashes per shader stage are stored as the layout of their ShaderHashSet, which includes its lookup
+	/// table. Loading copies nothing: each group's ShaderHashSet is pointed at its layout in the mapping and shares ownership of it, so the
+	/// mapping stays open until the last of these sets is assigned other hashes or destroyed. Editing a group's hashes gives it a set of its own.
+	/// </summary>
+	/// <remarks>
+	/// Layout, all values little endian and 4 byte aligned:
+	/// - CompiledProfileHeader
+	/// - CompiledProfileGroup, one per group
+	/// - the data block: group names (UTF-8, not zero terminated) and the ShaderHashSet layouts, each layout starting at a 4 byte boundary.
+	/// The checksum is the crc32 of everything after the header.
+	/// </remarks>
+	class CompiledProfile
+	{
+	public:
+		static constexpr uint32_t MAGIC = 0x42505453;	// 'STPB'
+		static constexpr uint32_t VERSION = 5;
+		static constexpr uint32_t FLAG_DELTA_ENCODE_HASHES = 0x1;
+		static constexpr uint32_t FLAG_AUTO_SAVE = 0x2;
+
+		enum ShaderStage : uint32_t
+		{
+			VertexShaderStage = 0,
+			PixelShaderStage,
+			ComputeShaderStage,
+			ShaderStageCount
+		};
+
+		struct CompiledProfileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t checksum;
+			uint32_t fileSize;
+			uint32_t groupCount;
+			uint32_t flags;
+			uint64_t sourceFileSize;			// size of the ini file the profile was compiled from
+			int64_t sourceFileWriteTime;		// last write time of that ini file, in file_time_type ticks
+		};
+
+		struct CompiledProfileGroup
+		{
+			uint32_t nameOffset;
+			uint32_t nameLength;
+			uint32_t toggleKey;
+			uint32_t isActiveAtStartup;
+			uint32_t isPerformanceGroup;
+			int32_t performancePriority;
+			uint32_t throttleMode;
+			uint32_t throttleValue;
+			uint32_t hashesOffset[ShaderStageCount];		// offset of the ShaderHashSet layout
+			uint32_t hashesCount[ShaderStageCount];
+			uint32_t hashesSlotBits[ShaderStageCount];
+		};
+
+		/// <summary>
+		/// Writes the groups specified to a compiled profile file. The profile is written to fileName + ".tmp" first, which is then renamed over
+		/// the file specified, so an existing profile is replaced in one step and never seen half written.
+		/// </summary>
+		/// <param name="fileName"></param>
+		/// <param name="groups"></param>
+		/// <param name="flags">FLAG_* values, the settings to store with the groups</param>
+		/// <param name="sourceFileStamp">the stamp of the ini file the groups were read from or written to</param>
+		/// <returns>true if the file was written successfully, false otherwise</returns>
+		static bool write(const std::string& fileName, const std::vector<ToggleGroup>& groups, uint32_t flags, const FileStamp& sourceFileStamp);
+
+		/// <summary>
+		/// Maps the compiled profile file specified and validates its header, checksum and offsets.
+		/// </summary>
+		/// <param name="fileName"></param>
+		/// <returns>true if the file is a valid compiled profile, false otherwise</returns>
+		bool open(const std::string& fileName);
+
+		/// <summary>
+		/// Returns true if the profile was compiled from the ini file with the stamp specified. Only an exact match of size and last write time
+		/// counts: a copied or restored ini file can be older than the compiled profile and still differ from what it was compiled from.
+		/// </summary>
+		bool isCompiledFrom(const FileStamp& iniFileStamp) const;
+		uint32_t getGroupCount() const { return nullptr == _header ? 0 : _header->groupCount; }
+		uint32_t getFlags() const { return nullptr == _header ? 0 : _header->flags; }
+		std::string_view getGroupName(uint32_t groupIndex) const;
+		uint32_t getToggleKey(uint32_t groupIndex) const { return _groups[groupIndex].toggleKey; }
+		bool isActiveAtStartup(uint32_t groupIndex) const { return _groups[groupIndex].isActiveAtStartup != 0; }
+		bool isPerformanceGroup(uint32_t groupIndex) const { return _groups[groupIndex].isPerformanceGroup != 0; }
+		int getPerformancePriority(uint32_t groupIndex) const { return _groups[groupIndex].performancePriority; }
+		DrawThrottleMode getThrottleMode(uint32_t groupIndex) const;
+		uint32_t getThrottleValue(uint32_t groupIndex) const { return _groups[groupIndex].throttleValue; }
+		/// <summary>
+		/// Makes the set specified use the hashes of the shader stage specified of the group specified, in place in the mapped file.
+		/// </summary>
+		void assignHashes(uint32_t groupIndex, ShaderStage stage, ShaderHashSet& destination) const;
+
+	private:
+		std::shared_ptr<MappedFile> _file;
+		const CompiledProfileHeader* _header = nullptr;
+		const CompiledProfileGroup* _groups = nullptr;
+	};
+}
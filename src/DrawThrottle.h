@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// What happens to the draw calls using a shader of an active group.
+	/// </summary>
+	enum class DrawThrottleMode : uint32_t
+	{
+		HideAll = 0,				// all draws are blocked
+		KeepEveryNthDraw,			// of the draws in a frame, the first and then every n-th one is kept, the rest is blocked.
+		KeepFirstDrawsPerFrame,		// the first n draws in a frame are kept, the rest is blocked.
+		ReduceInstances,			// the draws are re-issued with n percent of their instances.
+		Count
+	};
+
+	/// <summary>
+	/// Per command list counters of the draws done with the shaders of throttled groups, used to decide which of these draws are kept. Each
+	/// active throttled group gets a slot. A command list is only recorded by one thread at a time, so the counters are plain values and
+	/// deciding costs no synchronization.
+	/// </summary>
+	class DrawThrottleCounters
+	{
+	public:
+		static constexpr uint32_t MAX_SLOTS = 8;
+		static constexpr uint32_t NO_SLOT = UINT32_MAX;
+		static constexpr uint32_t ALL_INSTANCES = 100;
+
+		/// <summary>
+		/// Starts a new draw. The counters start at 0 again when the frame specified differs from the one of the last draw.
+		/// </summary>
+		void beginDraw(uint32_t frame)
+		{
+			if(frame != _frame)
+			{
+				_frame = frame;
+				_drawCounts.fill(0);
+			}
+			_decidedSlots = 0;
+			_keptSlots = 0;
+			_keptInstancePercentage = ALL_INSTANCES;
+		}
+
+		/// <summary>
+		/// Returns true if the current draw is kept by the throttled group in the slot specified. The draw is counted the first time a slot is
+		/// asked for it, so a draw matching a group in more than one shader stage is counted once.
+		/// </summary>
+		bool keepDraw(uint32_t slot, DrawThrottleMode mode, uint32_t value)
+		{
+			const uint32_t slotBit = 1u << slot;
+			if((_decidedSlots & slotBit) == 0)
+			{
+				_decidedSlots |= slotBit;
+				const uint32_t drawCount = _drawCounts[slot]++;
+				bool keep = false;
+				switch(mode)
+				{
+					case DrawThrottleMode::KeepEveryNthDraw:
+						keep = value <= 1 || drawCount % value == 0;
+						break;
+					case DrawThrottleMode::KeepFirstDrawsPerFrame:
+						keep = drawCount < value;
+						break;
+					default:
+						break;
+				}
+				_keptSlots |= keep ? slotBit : 0;
+			}
+			return (_keptSlots & slotBit) != 0;
+		}
+
+		/// <summary>
+		/// Lowers the percentage of instances the current draw is issued with to the one specified, if that's lower.
+		/// </summary>
+		void reduceInstances(uint32_t percentage)
+		{
+			_keptInstancePercentage = percentage < _keptInstancePercentage ? percentage : _keptInstancePercentage;
+		}
+
+		/// <summary>
+		/// Returns the percentage of instances the current draw has to be issued with, ALL_INSTANCES if it's issued as is.
+		/// </summary>
+		uint32_t getKeptInstancePercentage() const { return _keptInstancePercentage; }
+
+	private:
+		std::array<uint32_t, MAX_SLOTS> _drawCounts = {};
+		uint32_t _frame = 0;
+		uint32_t _decidedSlots = 0;
+		uint32_t _keptSlots = 0;
+		uint32_t _keptInstancePercentage = ALL_INSTANCES;
+	};
+
+
+	/// <summary>
+	/// Returns the throttle value specified limited to what's valid for the mode specified: a percentage from 1 to ALL_INSTANCES when reducing
+	/// instances, at least 1 otherwise. 0 would block every draw, and a percentage over ALL_INSTANCES would issue more instances than asked for.
+	/// </summary>
+	inline uint32_t clampThrottleValue(DrawThrottleMode mode, uint32_t value)
+	{
+		const uint32_t maxValue = mode == DrawThrottleMode::ReduceInstances ? DrawThrottleCounters::ALL_INSTANCES : UINT32_MAX;
+		return value < 1 ? 1 : (value > maxValue ? maxValue : value);
+	}
+}
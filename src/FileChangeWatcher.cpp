@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "FileChangeWatcher.h"
+
+namespace ShaderToggler
+{
+	FileStamp FileStamp::read(const std::string& fileName)
+	{
+		FileStamp toReturn;
+		std::error_code errorCode;
+		toReturn.lastWriteTime = std::filesystem::last_write_time(fileName, errorCode);
+		if(errorCode)
+		{
+			return FileStamp();
+		}
+		toReturn.size = std::filesystem::file_size(fileName, errorCode);
+		if(errorCode)
+		{
+			return FileStamp();
+		}
+		toReturn.exists = true;
+		return toReturn;
+	}
+
+
+	PollingFileChangeWatcher::PollingFileChangeWatcher(const std::string& fileName): _fileName(fileName), _lastSeenStamp(FileStamp::read(fileName))
+	{
+		_pendingStamp = _lastSeenStamp;
+	}
+
+
+	bool PollingFileChangeWatcher::checkForChange(FileStamp& newStamp)
+	{
+		const FileStamp currentStamp = FileStamp::read(_fileName);
+		if(currentStamp == _lastSeenStamp)
+		{
+			_pendingStamp = currentStamp;
+			return false;
+		}
+		if(!(currentStamp == _pendingStamp))
+		{
+			// changed since the previous call, so possibly still being written. Reported once it stays like this for one more call.
+			_pendingStamp = currentStamp;
+			return false;
+		}
+		_lastSeenStamp = currentStamp;
+		if(!currentStamp.exists)
+		{
+			// removed, or replaced right now; the new file shows up as a change on a later call.
+			return false;
+		}
+		newStamp = currentStamp;
+		return true;
+	}
+}
@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Identifies a version of a file by its last write time and size. Two stamps that are equal are assumed to be the same file contents.
+	/// </summary>
+	struct FileStamp
+	{
+		std::filesystem::file_time_type lastWriteTime{};
+		uintmax_t size = 0;
+		bool exists = false;
+
+		/// <summary>
+		/// Reads the stamp of the file specified. If the file doesn't exist or can't be read, the stamp returned has exists set to false.
+		/// </summary>
+		static FileStamp read(const std::string& fileName);
+
+		bool operator==(const FileStamp& rhs) const
+		{
+			return exists == rhs.exists && lastWriteTime == rhs.lastWriteTime && size == rhs.size;
+		}
+	};
+
+
+	/// <summary>
+	/// Detects changes to a single file. Implementations can use whatever notification mechanism the platform offers; checkForChange is called
+	/// periodically from a background thread and should return quickly.
+	/// </summary>
+	class FileChangeWatcher
+	{
+	public:
+		virtual ~FileChangeWatcher() = default;
+
+		/// <summary>
+		/// Returns true if the file has changed since the previous call (or since construction, for the first call). A file that's been removed
+		/// isn't reported as a change.
+		/// </summary>
+		/// <param name="newStamp">receives the stamp of the changed file</param>
+		virtual bool checkForChange(FileStamp& newStamp) = 0;
+	};
+
+
+	/// <summary>
+	/// FileChangeWatcher which compares the file's stamp with the one seen last time it was called. Works on every platform std::filesystem
+	/// supports. A change is only reported once the new stamp has been the same for two calls in a row, i.e. stable for one poll interval, so
+	/// a file which is still being written isn't reported halfway through.
+	/// </summary>
+	class PollingFileChangeWatcher : public FileChangeWatcher
+	{
+	public:
+		explicit PollingFileChangeWatcher(const std::string& fileName);
+
+		bool checkForChange(FileStamp& newStamp) override;
+
+	private:
+		std::string _fileName;
+		FileStamp _lastSeenStamp;		// the stamp last reported, or the one at construction
+		FileStamp _pendingStamp;		// the stamp seen in the previous call, reported if it's still the same in the next call
+	};
+}
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "FrameTimeGovernor.h"
+
+#include <algorithm>
+
+namespace ShaderToggler
+{
+	void FrameTimeGovernor::setSettings(const Settings& settings)
+	{
+		const bool windowChanged = settings.windowFrames != _settings.windowFrames;
+		_settings = settings;
+		_settings.windowFrames = std::max(_settings.windowFrames, 1u);
+		_settings.percentile = std::clamp(_settings.percentile, 0.0, 1.0);
+		if(windowChanged)
+		{
+			// the frames gathered don't fit the new window; start over but keep the groups switched on.
+			_window.clear();
+			_windowPosition = 0;
+			_framesInWindow = 0;
+		}
+	}
+
+
+	void FrameTimeGovernor::reset()
+	{
+		_window.clear();
+		_windowPosition = 0;
+		_framesInWindow = 0;
+		_frameTimePercentileMs = 0.0;
+		_percentileBeforeActivationMs = 0.0;
+		_savingsPerActivation.clear();
+	}
+
+
+	FrameTimeGovernor::Decision FrameTimeGovernor::onFramePresented(double frameTimeMs, bool canActivate)
+	{
+		if(_window.size() != _settings.windowFrames)
+		{
+			_window.assign(_settings.windowFrames, 0.0);
+			_windowPosition = 0;
+			_framesInWindow = 0;
+		}
+		_window[_windowPosition] = frameTimeMs;
+		_windowPosition = (_windowPosition + 1) % _settings.windowFrames;
+		if(_framesInWindow < _settings.windowFrames)
+		{
+			_framesInWindow++;
+			if(_framesInWindow < _settings.windowFrames)
+			{
+				return Decision::None;
+			}
+		}
+		_frameTimePercentileMs = computePercentile();
+
+		if(_percentileBeforeActivationMs > 0.0)
+		{
+			// first full window after switching a group on: what it saved is known now.
+			_savingsPerActivation.back() = std::max(_percentileBeforeActivationMs - _frameTimePercentileMs, 0.0);
+			_percentileBeforeActivationMs = 0.0;
+		}
+
+		Decision decision = Decision::None;
+		if(_frameTimePercentileMs > _settings.budgetMs)
+		{
+			if(canActivate)
+			{
+				decision = Decision::ActivateNext;
+				_percentileBeforeActivationMs = _frameTimePercentileMs;
+				_savingsPerActivation.push_back(0.0);
+			}
+		}
+		else if(!_savingsPerActivation.empty())
+		{
+			const double lowerThresholdMs = _settings.budgetMs * (1.0 - _settings.headroomFraction);
+			if(_frameTimePercentileMs + _savingsPerActivation.back() < lowerThresholdMs)
+			{
+				decision = Decision::DeactivateLast;
+				_savingsPerActivation.pop_back();
+			}
+		}
+		if(decision != Decision::None)
+		{
+			// the frames seen so far were rendered with the old set of groups; the next decision needs a full window with the new set.
+			_framesInWindow = 0;
+		}
+		return decision;
+	}
+
+
+	double FrameTimeGovernor::computePercentile()
+	{
+		_sortBuffer.assign(_window.begin(), _window.end());
+		const size_t index = std::min(static_cast<size_t>(_settings.percentile * _sortBuffer.size()), _sortBuffer.size() - 1);
+		std::nth_element(_sortBuffer.begin(), _sortBuffer.begin() + index, _sortBuffer.end());
+		return _sortBuffer[index];
+	}
+}
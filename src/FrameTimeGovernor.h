@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Decides when to switch performance groups on or off to keep the frame time within a budget. It tracks a percentile of the frame times
+	/// over a sliding window of frames. When that percentile is over the budget, it asks for the next group to be switched on. When there's
+	/// headroom again, it asks for the last group it switched on to be switched off, but only if the frame time, plus what that group was
+	/// measured to save, stays below the budget minus a margin. That, and waiting for a full window of frames after every change, keeps it
+	/// from oscillating. It only sees frame times, so it can be driven by recorded or synthetic traces.
+	/// </summary>
+	class FrameTimeGovernor
+	{
+	public:
+		struct Settings
+		{
+			double budgetMs = 16.7;				// the frame time to stay within.
+			double percentile = 0.9;			// the percentile of the frame times in the window which is compared with the budget.
+			uint32_t windowFrames = 60;			// number of frames the percentile is taken over. A decision is only made with a full window.
+			double headroomFraction = 0.1;		// a group is only switched off if the frame time stays this fraction below the budget.
+		};
+
+		enum class Decision
+		{
+			None,
+			ActivateNext,			// switch on the next performance group
+			DeactivateLast,			// switch off the performance group switched on last
+		};
+
+		void setSettings(const Settings& settings);
+		const Settings& getSettings() const { return _settings; }
+		/// <summary>
+		/// Forgets the frames seen and the groups switched on, e.g. after the caller switched the groups off itself.
+		/// </summary>
+		void reset();
+		/// <summary>
+		/// Called once per frame with the frame time. The caller has to carry out the decision returned: it's recorded as done.
+		/// </summary>
+		/// <param name="frameTimeMs"></param>
+		/// <param name="canActivate">false if there's no performance group left to switch on</param>
+		/// <returns></returns>
+		Decision onFramePresented(double frameTimeMs, bool canActivate);
+
+		/// <summary>
+		/// Returns the frame time percentile over the last full window, 0 if there hasn't been a full window yet.
+		/// </summary>
+		double getFrameTimePercentileMs() const { return _frameTimePercentileMs; }
+		/// <summary>
+		/// Returns the number of groups switched on by the governor which are still on.
+		/// </summary>
+		uint32_t getAmountActivated() const { return static_cast<uint32_t>(_savingsPerActivation.size()); }
+
+	private:
+		double computePercentile();
+
+		Settings _settings;
+		std::vector<double> _window;					// ring buffer with the frame times of the last windowFrames frames.
+		std::vector<double> _sortBuffer;
+		uint32_t _windowPosition = 0;
+		uint32_t _framesInWindow = 0;
+		double _frameTimePercentileMs = 0.0;
+		double _percentileBeforeActivationMs = 0.0;		// the percentile right before the last activation, 0 if none is being measured.
+		std::vector<double> _savingsPerActivation;		// per group switched on, the drop in frame time percentile it caused.
+	};
+}
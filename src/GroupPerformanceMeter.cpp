@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "GroupPerformanceMeter.h"
+#include "Statistics.h"
+
+#include <algorithm>
+#include <random>
+
+namespace ShaderToggler
+{
+	void GroupPerformanceMeter::start(int groupId, bool wasGroupActive, const Settings& settings, uint32_t seed)
+	{
+		_settings = settings;
+		_settings.amountBlockPairs = std::max(_settings.amountBlockPairs, 1u);
+		_settings.framesPerBlock = std::max(_settings.framesPerBlock, 1u);
+		_groupId = groupId;
+		_wasGroupActive = wasGroupActive;
+		std::mt19937 random(seed);
+		_blockStates.clear();
+		for(uint32_t i = 0; i < _settings.amountBlockPairs; i++)
+		{
+			const bool activeFirst = (random() & 1) != 0;
+			_blockStates.push_back(activeFirst);
+			_blockStates.push_back(!activeFirst);
+		}
+		_currentBlock = 0;
+		_frameInBlock = 0;
+		_blockFrameTimes.clear();
+		_activeFrameTimes.clear();
+		_inactiveFrameTimes.clear();
+		_blockMeans.clear();
+		_hasLastPresentTime = false;
+		_isRunning = true;
+	}
+
+
+	void GroupPerformanceMeter::stop()
+	{
+		_isRunning = false;
+	}
+
+
+	void GroupPerformanceMeter::onFramePresented(std::chrono::steady_clock::time_point presentTime)
+	{
+		if(!_isRunning)
+		{
+			return;
+		}
+		if(!_hasLastPresentTime)
+		{
+			_lastPresentTime = presentTime;
+			_hasLastPresentTime = true;
+			return;
+		}
+		const double frameTimeMs = std::chrono::duration<double, std::milli>(presentTime - _lastPresentTime).count();
+		_lastPresentTime = presentTime;
+		if(_frameInBlock >= _settings.warmupFrames)
+		{
+			_blockFrameTimes.push_back(frameTimeMs);
+			(_blockStates[_currentBlock] ? _activeFrameTimes : _inactiveFrameTimes).push_back(frameTimeMs);
+		}
+		_frameInBlock++;
+		if(_frameInBlock < _settings.warmupFrames + _settings.framesPerBlock)
+		{
+			return;
+		}
+		_blockMeans.push_back(meanWithInterval(_blockFrameTimes).mean);
+		_blockFrameTimes.clear();
+		_frameInBlock = 0;
+		_currentBlock++;
+		if(_currentBlock >= _blockStates.size())
+		{
+			_currentBlock = 0;
+			_isRunning = false;
+		}
+	}
+
+
+	float GroupPerformanceMeter::getProgress() const
+	{
+		if(_blockStates.empty())
+		{
+			return 0.0f;
+		}
+		if(!_isRunning)
+		{
+			return 1.0f;
+		}
+		const uint32_t framesPerBlock = _settings.warmupFrames + _settings.framesPerBlock;
+		return static_cast<float>(_currentBlock * framesPerBlock + _frameInBlock) / static_cast<float>(_blockStates.size() * framesPerBlock);
+	}
+
+
+	GroupPerformanceMeter::Result GroupPerformanceMeter::getResult() const
+	{
+		Result toReturn;
+		// the deltas between the two blocks of a pair are close to independent, unlike consecutive frame times, so the mean delta and its
+		// interval are determined over them. As all blocks have the same number of frames, the mean of the pair deltas is the difference of
+		// the mean frame times.
+		std::vector<double> pairDeltas;
+		for(size_t i = 0; i + 1 < _blockMeans.size(); i += 2)
+		{
+			const double activeMean = _blockStates[i] ? _blockMeans[i] : _blockMeans[i + 1];
+			const double inactiveMean = _blockStates[i] ? _blockMeans[i + 1] : _blockMeans[i];
+			pairDeltas.push_back(activeMean - inactiveMean);
+		}
+		const MeanWithInterval pairDelta = meanWithInterval(pairDeltas);
+		toReturn.meanDeltaMs = pairDelta.mean;
+		toReturn.confidenceIntervalMs = pairDelta.confidenceInterval95;
+		toReturn.isSignificant = pairDelta.isSignificant();
+		std::vector<double> activeFrameTimes = _activeFrameTimes;
+		std::vector<double> inactiveFrameTimes = _inactiveFrameTimes;
+		toReturn.inactiveFrameTimeMs = median(inactiveFrameTimes);
+		toReturn.medianDeltaMs = median(activeFrameTimes) - toReturn.inactiveFrameTimeMs;
+		toReturn.amountFramesMeasured = static_cast<uint32_t>(activeFrameTimes.size() + inactiveFrameTimes.size());
+		return toReturn;
+	}
+}
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Measures what a toggle group saves in frame time, by switching it on and off in blocks of frames and comparing the frame times. The
+	/// blocks come in pairs, one with the group on and one with it off, in random order per pair, so neither state systematically gets the
+	/// frames right after a change or a slow trend in frame time. Only used on the present thread.
+	/// </summary>
+	class GroupPerformanceMeter
+	{
+	public:
+		struct Settings
+		{
+			uint32_t amountBlockPairs = 12;
+			uint32_t framesPerBlock = 12;
+			uint32_t warmupFrames = 3;			// frames at the start of a block which aren't measured, so the change has reached the GPU.
+		};
+
+		/// <summary>
+		/// Frame time with the group active minus frame time with the group inactive. Negative is a saving.
+		/// </summary>
+		struct Result
+		{
+			double meanDeltaMs = 0.0;
+			double medianDeltaMs = 0.0;
+			double confidenceIntervalMs = 0.0;		// half width of the 95% confidence interval of meanDeltaMs, over the block pairs.
+			double inactiveFrameTimeMs = 0.0;		// median frame time with the group inactive.
+			bool isSignificant = false;
+			uint32_t amountFramesMeasured = 0;
+		};
+
+		/// <summary>
+		/// Starts measuring the group with the id specified. wasGroupActive is the state to restore when done.
+		/// </summary>
+		void start(int groupId, bool wasGroupActive, const Settings& settings, uint32_t seed);
+		void stop();
+		/// <summary>
+		/// Called at every present with the time of the present. After the call, getRequiredActiveState returns the state the group has to
+		/// be in for the coming frame.
+		/// </summary>
+		void onFramePresented(std::chrono::steady_clock::time_point presentTime);
+
+		bool isRunning() const { return _isRunning; }
+		int getGroupId() const { return _groupId; }
+		bool wasGroupActive() const { return _wasGroupActive; }
+		bool getRequiredActiveState() const { return _blockStates[_currentBlock]; }
+		float getProgress() const;
+		Result getResult() const;
+
+	private:
+		Settings _settings;
+		int _groupId = -1;
+		bool _wasGroupActive = false;
+		bool _isRunning = false;
+		std::vector<bool> _blockStates;					// per block whether the group is active in it.
+		uint32_t _currentBlock = 0;
+		uint32_t _frameInBlock = 0;
+		std::vector<double> _blockFrameTimes;
+		std::vector<double> _activeFrameTimes;
+		std::vector<double> _inactiveFrameTimes;
+		std::vector<double> _blockMeans;				// mean frame time per completed block.
+		bool _hasLastPresentTime = false;
+		std::chrono::steady_clock::time_point _lastPresentTime;
+	};
+}
@@ -0,0 +1,270 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "HashListCodec.h"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define HASHLISTCODEC_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+namespace ShaderToggler
+{
+	static constexpr char HASH_SEPARATOR = ',';
+	static constexpr size_t HASH_HEX_DIGITS = 8;
+
+
+	static uint32_t byteSwap(uint32_t value)
+	{
+#ifdef _MSC_VER
+		return _byteswap_ulong(value);
+#else
+		return __builtin_bswap32(value);
+#endif
+	}
+
+
+	static void appendHex(uint32_t value, size_t digits, std::string& destination)
+	{
+		static constexpr char hexDigits[] = "0123456789ABCDEF";
+		char buffer[HASH_HEX_DIGITS];
+		for(size_t i = 0; i < digits; i++)
+		{
+			buffer[digits - 1 - i] = hexDigits[(value >> (i * 4)) & 0xF];
+		}
+		destination.append(buffer, digits);
+	}
+
+
+	/// <summary>
+	/// Returns the element of a list without the spaces and tabs around it, which hand edited lists can have after a separator.
+	/// </summary>
+	static std::string_view trimElement(std::string_view element)
+	{
+		const size_t start = element.find_first_not_of(" \t");
+		if(start == std::string_view::npos)
+		{
+			return std::string_view();
+		}
+		return element.substr(start, element.find_last_not_of(" \t") - start + 1);
+	}
+
+
+	/// <summary>
+	/// Scalar decode of a hexadecimal value of 1 to 8 digits.
+	/// </summary>
+	static bool decodeHexScalar(std::string_view digits, uint32_t& value)
+	{
+		if(digits.size() <= 0 || digits.size() > HASH_HEX_DIGITS)
+		{
+			return false;
+		}
+		value = 0;
+		for(const char c : digits)
+		{
+			uint32_t nibble;
+			if(c >= '0' && c <= '9')
+			{
+				nibble = c - '0';
+			}
+			else if(c >= 'a' && c <= 'f')
+			{
+				nibble = c - 'a' + 10;
+			}
+			else if(c >= 'A' && c <= 'F')
+			{
+				nibble = c - 'A' + 10;
+			}
+			else
+			{
+				return false;
+			}
+			value = (value << 4) | nibble;
+		}
+		return true;
+	}
+
+
+	/// <summary>
+	/// Decodes exactly 8 hexadecimal digits starting at source. Reads exactly 8 bytes.
+	/// </summary>
+	static bool decodeHex8(const char* source, uint32_t& value)
+	{
+#ifdef HASHLISTCODEC_SSE2
+		const __m128i characters = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+		// lowercase: sets bit 5, which digits already have set.
+		const __m128i lowered = _mm_or_si128(characters, _mm_set1_epi8(0x20));
+		const __m128i isLetter = _mm_cmpgt_epi8(lowered, _mm_set1_epi8('a' - 1));
+		// digits: c - '0'. letters: c - 'a' + 10 == (c - '0') - 39
+		__m128i nibbles = _mm_sub_epi8(lowered, _mm_set1_epi8('0'));
+		nibbles = _mm_sub_epi8(nibbles, _mm_and_si128(isLetter, _mm_set1_epi8(39)));
+		// valid if the nibble is in 0-15 and it's a letter exactly when it's 10 or up.
+		const __m128i inRange = _mm_cmpeq_epi8(_mm_and_si128(nibbles, _mm_set1_epi8(static_cast<char>(0xF0))), _mm_setzero_si128());
+		const __m128i isTenOrUp = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+		const __m128i isValid = _mm_and_si128(inRange, _mm_cmpeq_epi8(isTenOrUp, isLetter));
+		if((_mm_movemask_epi8(isValid) & 0xFF) != 0xFF)
+		{
+			return false;
+		}
+		// combine pairs of nibbles into bytes: each 16 bit lane holds (first nibble | second nibble << 8).
+		const __m128i highNibbles = _mm_and_si128(_mm_slli_epi16(nibbles, 4), _mm_set1_epi16(0x00F0));
+		const __m128i lowNibbles = _mm_srli_epi16(nibbles, 8);
+		const __m128i bytes = _mm_packus_epi16(_mm_or_si128(highNibbles, lowNibbles), _mm_setzero_si128());
+		// the first digit pair is the most significant byte.
+		value = byteSwap(static_cast<uint32_t>(_mm_cvtsi128_si32(bytes)));
+		return true;
+#else
+		return decodeHexScalar(std::string_view(source, HASH_HEX_DIGITS), value);
+#endif
+	}
+
+
+	/// <summary>
+	/// Makes sure the decoded hashes are sorted ascending without duplicates. Lists written by the addon already are, hand edited ones might not be.
+	/// </summary>
+	static void normalizeHashes(std::vector<uint32_t>& hashes)
+	{
+		if(!std::is_sorted(hashes.begin(), hashes.end()))
+		{
+			std::sort(hashes.begin(), hashes.end());
+		}
+		hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+	}
+
+
+	void encodeHashList(const std::vector<uint32_t>& sortedHashes, std::string& destination)
+	{
+		destination.reserve(destination.size() + sortedHashes.size() * (HASH_HEX_DIGITS + 1));
+		for(size_t i = 0; i < sortedHashes.size(); i++)
+		{
+			if(i > 0)
+			{
+				destination.push_back(HASH_SEPARATOR);
+			}
+			appendHex(sortedHashes[i], HASH_HEX_DIGITS, destination);
+		}
+	}
+
+
+	void encodeHashListDelta(const std::vector<uint32_t>& sortedHashes, std::string& destination)
+	{
+		uint32_t previous = 0;
+		for(size_t i = 0; i < sortedHashes.size(); i++)
+		{
+			if(i > 0)
+			{
+				destination.push_back(HASH_SEPARATOR);
+			}
+			const uint32_t delta = sortedHashes[i] - previous;
+			size_t digits = 1;
+			while(digits < HASH_HEX_DIGITS && (delta >> (digits * 4)) != 0)
+			{
+				digits++;
+			}
+			appendHex(delta, digits, destination);
+			previous = sortedHashes[i];
+		}
+	}
+
+
+	bool decodeHashList(std::string_view encodedHashes, std::vector<uint32_t>& hashes)
+	{
+		hashes.clear();
+		hashes.reserve(encodedHashes.size() / (HASH_HEX_DIGITS + 1) + 1);
+		size_t position = 0;
+		while(position < encodedHashes.size())
+		{
+			uint32_t hash;
+			const size_t remaining = encodedHashes.size() - position;
+			if(remaining >= HASH_HEX_DIGITS && (remaining == HASH_HEX_DIGITS || encodedHashes[position + HASH_HEX_DIGITS] == HASH_SEPARATOR))
+			{
+				// fast path: a full width value.
+				if(!decodeHex8(encodedHashes.data() + position, hash))
+				{
+					hashes.clear();
+					return false;
+				}
+				position += HASH_HEX_DIGITS + 1;
+			}
+			else
+			{
+				size_t end = encodedHashes.find(HASH_SEPARATOR, position);
+				if(end == std::string_view::npos)
+				{
+					end = encodedHashes.size();
+				}
+				if(!decodeHexScalar(trimElement(encodedHashes.substr(position, end - position)), hash))
+				{
+					hashes.clear();
+					return false;
+				}
+				position = end + 1;
+			}
+			hashes.push_back(hash);
+		}
+		normalizeHashes(hashes);
+		return true;
+	}
+
+
+	bool decodeHashListDelta(std::string_view encodedHashes, std::vector<uint32_t>& hashes)
+	{
+		hashes.clear();
+		size_t position = 0;
+		uint32_t previous = 0;
+		while(position < encodedHashes.size())
+		{
+			size_t end = encodedHashes.find(HASH_SEPARATOR, position);
+			if(end == std::string_view::npos)
+			{
+				end = encodedHashes.size();
+			}
+			uint32_t delta;
+			if(!decodeHexScalar(trimElement(encodedHashes.substr(position, end - position)), delta))
+			{
+				hashes.clear();
+				return false;
+			}
+			previous += delta;
+			hashes.push_back(previous);
+			position = end + 1;
+		}
+		normalizeHashes(hashes);
+		return true;
+	}
+}
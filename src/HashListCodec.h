@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Encodes a sorted list of shader hashes as a single line of comma separated, fixed width (8 digit) hexadecimal values. Used by the v2
+	/// profile layout, which stores one such list per shader stage instead of a ShaderHashN key per hash.
+	/// </summary>
+	/// <param name="sortedHashes">the hashes to encode, sorted ascending</param>
+	/// <param name="destination">the string to append the encoded list to</param>
+	void encodeHashList(const std::vector<uint32_t>& sortedHashes, std::string& destination);
+	/// <summary>
+	/// Encodes a sorted list of shader hashes as a single line of comma separated hexadecimal deltas, where every value is the difference with
+	/// the previous hash (the first is relative to 0). Deltas don't have a fixed width so the result is smaller for large lists, at the cost of
+	/// a scalar decode.
+	/// </summary>
+	/// <param name="sortedHashes">the hashes to encode, sorted ascending</param>
+	/// <param name="destination">the string to append the encoded list to</param>
+	void encodeHashListDelta(const std::vector<uint32_t>& sortedHashes, std::string& destination);
+	/// <summary>
+	/// Decodes a list produced by encodeHashList into a sorted array without duplicates. Fixed width values are decoded with SSE2, other widths
+	/// (e.g. from a hand edited file) fall back to a scalar decode. Spaces and tabs around a value are ignored.
+	/// </summary>
+	/// <param name="encodedHashes"></param>
+	/// <param name="hashes">receives the decoded hashes, sorted ascending</param>
+	/// <returns>true if the list was valid, false otherwise, in which case hashes is empty</returns>
+	bool decodeHashList(std::string_view encodedHashes, std::vector<uint32_t>& hashes);
+	/// <summary>
+	/// Decodes a list produced by encodeHashListDelta into a sorted array without duplicates. Spaces and tabs around a value are ignored.
+	/// </summary>
+	/// <param name="encodedHashes"></param>
+	/// <param name="hashes">receives the decoded hashes, sorted ascending</param>
+	/// <returns>true if the list was valid, false otherwise, in which case hashes is empty</returns>
+	bool decodeHashListDelta(std::string_view encodedHashes, std::vector<uint32_t>& hashes);
+}
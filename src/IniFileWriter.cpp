@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "IniFileWriter.h"
+
+#include <charconv>
+#include <fstream>
+
+namespace ShaderToggler
+{
+	IniFileWriter::IniFileWriter()
+	{
+		_buffer.reserve(16 * 1024);
+	}
+
+
+	void IniFileWriter::writeSection(std::string_view sectionName)
+	{
+		// same layout as CDataFile::Save for a section without a comment: an empty line, followed by the section header.
+		_buffer.append("\n[");
+		_buffer.append(sectionName);
+		_buffer.append("]\n");
+	}
+
+
+	void IniFileWriter::writeValue(std::string_view key, std::string_view value)
+	{
+		if(key.size() <= 0 || value.size() <= 0)
+		{
+			return;
+		}
+		_buffer.append(key);
+		_buffer.push_back('=');
+		_buffer.append(value);
+		_buffer.push_back('\n');
+	}
+
+
+	void IniFileWriter::writeInt(std::string_view key, int value)
+	{
+		char valueBuffer[16];
+		const auto result = std::to_chars(valueBuffer, valueBuffer + sizeof(valueBuffer), value);
+		writeValue(key, std::string_view(valueBuffer, result.ptr - valueBuffer));
+	}
+
+
+	void IniFileWriter::writeUInt(std::string_view key, uint32_t value)
+	{
+		char valueBuffer[16];
+		const auto result = std::to_chars(valueBuffer, valueBuffer + sizeof(valueBuffer), value);
+		writeValue(key, std::string_view(valueBuffer, result.ptr - valueBuffer));
+	}
+
+
+	void IniFileWriter::writeBool(std::string_view key, bool value)
+	{
+		writeValue(key, value ? "True" : "False");
+	}
+
+
+	bool IniFileWriter::save(const std::string& fileName) const
+	{
+		// text mode, like CDataFile::Save, so line endings are translated the same way.
+		std::fstream file(fileName.c_str(), std::ios::out | std::ios::trunc);
+		if(!file.is_open())
+		{
+			return false;
+		}
+		file.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+		file.flush();
+		return file.good();
+	}
+}
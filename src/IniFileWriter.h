@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Streaming writer for ini files. Sections and keys are appended to an in-memory buffer in the order they're written, which is then written
+	/// to disk in one go. The output has the same layout as what CDataFile::Save produces for the same sections and keys, and is byte-identical
+	/// to it as long as no line is longer than MAX_BUFFER_LEN - 1 characters: CDataFile::Save cuts longer lines off there, while this writer
+	/// writes every line in full, like the packed hash lists of large groups. Unlike CDataFile, no lookups are done: the caller is responsible
+	/// for not writing a section or key twice.
+	/// </summary>
+	class IniFileWriter
+	{
+	public:
+		IniFileWriter();
+
+		/// <summary>
+		/// Starts a new section. All keys written after this call are part of this section.
+		/// </summary>
+		/// <param name="sectionName"></param>
+		void writeSection(std::string_view sectionName);
+		/// <summary>
+		/// Writes a key with the value specified to the current section. Like CDataFile, keys with an empty value aren't written.
+		/// </summary>
+		/// <param name="key"></param>
+		/// <param name="value"></param>
+		void writeValue(std::string_view key, std::string_view value);
+		void writeInt(std::string_view key, int value);
+		void writeUInt(std::string_view key, uint32_t value);
+		void writeBool(std::string_view key, bool value);
+		/// <summary>
+		/// Writes the buffered contents to the file specified, replacing the file if it exists.
+		/// </summary>
+		/// <param name="fileName"></param>
+		/// <returns>true if the file was written successfully, false otherwise</returns>
+		bool save(const std::string& fileName) const;
+
+		const std::string& getContents() const { return _buffer; }
+
+	private:
+		std::string _buffer;
+	};
+}
@@ -31,6 +31,8 @@
 /////////////////////////////////////////////////////////////////////////
 #include "KeyData.h"
 
+#include <reshade_api.hpp>
+
 namespace ShaderToggler
 {
 	KeyData::KeyData(): _keyCode(0), _shiftRequired(false), _altRequired(false), _ctrlRequired(false)
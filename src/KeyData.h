@@ -31,10 +31,13 @@
 /////////////////////////////////////////////////////////////////////////
 #pragma once
 
-#include <reshade_api.hpp>
-
 #include "stdafx.h"
 
+namespace reshade::api
+{
+	struct effect_runtime;
+}
+
 namespace ShaderToggler
 {
 	/// <summary>
@@ -36,11 +36,25 @@
 #include <imgui.h>
 #include <reshade.hpp>
 #include "crc32_hash.hpp"
+#include "AblationProfiler.h"
+#include "CollectionPhase.h"
+#include "FrameTimeGovernor.h"
+#include "PipelineCreationProfiler.h"
+#include "GroupPerformanceMeter.h"
 #include "ShaderManager.h"
-#include "CDataFile.h"
+#include "ProfileHotReloader.h"
+#include "ProfileLoader.h"
+#include "ProfileSaver.h"
+#include "RetireQueue.h"
+#include "SubmissionCostProfiler.h"
 #include "ToggleGroup.h"
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <vector>
 #include <filesystem>
+#include <unordered_map>
+#include <utility>
 
 using namespace reshade::api;
 using namespace ShaderToggler;
@@ -48,26 +62,116 @@ using namespace ShaderToggler;
 extern "C" __declspec(dllexport) const char *NAME = "Shader Toggler";
 extern "C" __declspec(dllexport) const char *DESCRIPTION = "Add-on which allows you to define groups of game shaders to toggle on/off with one key press.";
 
+/// <summary>
+/// Shader stages checked by a draw call check kernel. Used as bit flags.
+/// </summary>
+enum DrawCheckStage : uint32_t
+{
+	PixelStage = 0x1,
+	VertexStage = 0x2,
+	ComputeStage = 0x4,
+	AllStages = 0x7
+};
+
+// The shaders bound per stage are resolved when a pipeline is bound, so a draw call only has to read them. A stage with nothing bound has
+// a shader id of ShaderIdBitset::NO_ID.
 struct __declspec(uuid("038B03AA-4C75-443B-A695-752D80797037")) CommandListDataContainer {
-    uint64_t activePixelShaderPipeline;
-    uint64_t activeVertexShaderPipeline;
-	uint64_t activeComputeShaderPipeline;
+	ShaderToggler::PipelineShader activePixelShader;
+	ShaderToggler::PipelineShader activeVertexShader;
+	ShaderToggler::PipelineShader activeComputeShader;
+	uint64_t lastBoundPipeline = 0;				// the pipeline the shaders above were resolved for, 0 if none since the last reset.
+	uint32_t lastBoundPipelineGeneration = 0;	// g_pipelineGeneration at the time lastBoundPipeline was resolved.
+	ShaderToggler::DrawThrottleCounters throttleCounters;	// draws done per throttled group in this command list, in the current frame.
+	bool isReissuingDraw = false;				// true while a draw with fewer instances is issued, so the draw hook lets it through.
+};
+
+/// <summary>
+/// What the draw call checks need of the active groups: per active group its throttle settings, and per shader stage and shader id a bitmask of
+/// the active groups with that shader. Built on the present thread whenever a group is toggled or changed, and immutable once published, so draw
+/// calls on other threads never read the live groups, which the present thread is free to change, add and remove.
+/// </summary>
+struct ActiveGroupTable
+{
+	struct Entry
+	{
+		ShaderToggler::DrawThrottleMode throttleMode;
+		uint32_t throttleValue;
+		uint32_t throttleSlot;
+	};
+
+	// maskWordsPerShader words per shader id, bit i of word w is entries[w * 64 + i]. The masks stop at the highest id of a shader in an active
+	// group, as the hashes of the groups are interned when the table is built: a shader with a higher id isn't in any of them.
+	std::vector<uint64_t> pixelShaderGroupMasks;
+	std::vector<uint64_t> vertexShaderGroupMasks;
+	std::vector<uint64_t> computeShaderGroupMasks;
+	size_t maskWordsPerShader = 1;
+	std::vector<Entry> entries;
+	uint32_t activeStages = 0;			// DrawCheckStage flags of the stages with hashes in any entry.
 };
 
 #define FRAMECOUNT_COLLECTION_PHASE_DEFAULT 250;
+#define FRAMECOUNT_COLLECTION_CONVERGENCE_DEFAULT 30;
+#define FRAMECOUNT_ACTIVITY_WINDOW_DEFAULT 120;
 #define HASH_FILE_NAME	"ShaderToggler.ini"
+#define COMPILED_PROFILE_FILE_NAME	"ShaderToggler.bin"
+#define SHADER_COST_FILE_NAME	"ShaderTogglerShaderCost.csv"
+#define PIPELINE_TRACE_FILE_NAME	"ShaderTogglerPipelineTrace.json"
+#define AUTOSAVE_DELAY_MS	2000
+#define HOT_RELOAD_POLL_INTERVAL_MS	1000
+#define SUBMISSION_COST_TOP_SHADER_COUNT	25
 
 static ShaderToggler::ShaderManager g_pixelShaderManager;
 static ShaderToggler::ShaderManager g_vertexShaderManager;
 static ShaderToggler::ShaderManager g_computeShaderManager;
 static KeyData g_keyCollector;
-static atomic_uint32_t g_activeCollectorFrameCounter = 0;
+static CollectionPhase g_collectionPhase;
 static std::vector<ToggleGroup> g_toggleGroups;
 static atomic_int g_toggleGroupIdKeyBindingEditing = -1;
 static atomic_int g_toggleGroupIdShaderEditing = -1;
 static float g_overlayOpacity = 1.0f;
 static int g_startValueFramecountCollectionPhase = FRAMECOUNT_COLLECTION_PHASE_DEFAULT;
+static bool g_stopCollectingWhenConverged = true;		// if true, the collection phase ends early once no new shaders show up for g_framecountCollectionConvergence frames.
+static int g_framecountCollectionConvergence = FRAMECOUNT_COLLECTION_CONVERGENCE_DEFAULT;
+static atomic_bool g_trackShaderActivity = false;		// if true, the last frame each shader was bound in is tracked, so hunting can start without a collection phase.
+static int g_framecountActivityWindow = FRAMECOUNT_ACTIVITY_WINDOW_DEFAULT;	// shaders bound in this many last frames are the ones hunted when activity is tracked.
+static std::atomic<uint32_t> g_activityFrame = 1;		// frame number used by the activity tracking and the draw throttling. Starts at 1, as 0 means 'never seen'.
+static uint32_t g_activityTrackingStartFrame = 0;		// g_activityFrame at the moment activity tracking was switched on.
 static std::string g_iniFileName = "";
+static std::string g_compiledProfileFileName = "";
+static std::string g_shaderCostFileName = "";
+static std::string g_pipelineTraceFileName = "";
+static bool g_deltaEncodeHashLists = false;			// read from/written to the General section. Delta encoded hash lists are smaller, fixed width ones load faster.
+static bool g_autoSave = false;						// read from/written to the General section. If true, group edits are saved automatically after a short delay.
+static ProfileSaver g_profileSaver;
+static ProfileLoader g_profileLoader;
+static bool g_profileIsLive = false;					// set on the render thread when the profile loaded by g_profileLoader has been adopted.
+static ProfileHotReloader g_profileHotReloader;
+static std::unique_ptr<ProfileHotReloader::ReloadedProfile> g_pendingReloadedProfile;	// reloaded profile waiting for editing to end before it's applied.
+static std::string g_lastReloadDescription = "";
+static std::string g_profileLoadError = "";			// why the ini file couldn't be read. While set, the groups aren't saved, so the file isn't overwritten.
+static int g_amountEffectRuntimes = 0;				// effect runtimes alive. The background threads are stopped when the last one is destroyed.
+static std::atomic<const ActiveGroupTable*> g_activeGroupTable = nullptr;	// the active groups as read by the draw call checks.
+static RetireQueue<ActiveGroupTable> g_retiredActiveGroupTables;	// replaced tables, kept alive while draw calls might still read them.
+static bool g_activeGroupsFilterIsDirty = true;
+static uint64_t g_presentCounter = 0;
+static std::atomic<uint32_t> g_pipelineGeneration = 0;	// bumped for every destroyed pipeline, so a handle reused for a new pipeline isn't mistaken for the last bound one.
+static atomic_bool g_collectFilterStatistics = false;
+static std::atomic<uint64_t> g_filterRejectCount = 0;			// lookups of shaders which aren't in any active group
+static std::atomic<uint64_t> g_filterHitCount = 0;				// lookups of shaders which are in an active group
+static AblationProfiler g_ablationProfiler;
+static AblationProfiler::Settings g_ablationSettings;
+static bool g_ablationStartPending = false;			// set when the profiler has to start as soon as the activity tracker has covered its window.
+static ShaderManager* g_ablatedShaderManager = nullptr;	// the manager in which the profiler currently blocks a shader, if any.
+static std::string g_ablationStatusMessage = "";
+static GroupPerformanceMeter g_groupPerformanceMeter;
+static std::unordered_map<int, GroupPerformanceMeter::Result> g_groupPerformanceResults;	// last measurement per group id.
+static bool g_frameTimeGovernorEnabled = false;		// if true, performance groups are switched on and off to keep the frame time within the budget.
+static FrameTimeGovernor g_frameTimeGovernor;
+static std::vector<int> g_governorActivatedGroupIds;	// ids of the groups the governor switched on, in the order it switched them on.
+static std::chrono::steady_clock::time_point g_lastPresentTime;
+static SubmissionCostProfiler g_submissionCostProfiler;
+static PipelineCreationProfiler g_pipelineCreationProfiler;
+static std::string g_pipelineTraceStatusMessage = "";
 
 /// <summary>
 /// Calculates a crc32 hash from the passed in shader bytecode. The hash is used to identity the shader in future runs.
@@ -98,58 +202,159 @@ void addDefaultGroup()
 
 
 /// <summary>
-/// Loads the defined hashes and groups from the shaderToggler.ini file.
+/// Creates a copy of the currently known toggle groups and the settings stored with them, which can be saved without touching the live groups.
+/// </summary>
+ProfileSnapshot createProfileSnapshot()
+{
+	ProfileSnapshot toReturn;
+	toReturn.groups = g_toggleGroups;
+	toReturn.deltaEncodeHashLists = g_deltaEncodeHashLists;
+	toReturn.autoSave = g_autoSave;
+	return toReturn;
+}
+
+
+/// <summary>
+/// Starts watching the ini file for changes made outside the addon, if it isn't watched already.
+/// </summary>
+static void startHotReloading()
+{
+	if(!g_profileHotReloader.isWatching())
+	{
+		g_profileHotReloader.startWatching(g_iniFileName, std::make_unique<PollingFileChangeWatcher>(g_iniFileName), std::chrono::milliseconds(HOT_RELOAD_POLL_INTERVAL_MS));
+	}
+}
+
+
+/// <summary>
+/// Adopts the profile loaded in the background, once it's available. Called at the start of each frame, on the render thread, so the groups are
+/// made live between frames. Until then there are no groups, so no draw calls are blocked.
 /// </summary>
-void loadShaderTogglerIniFile()
+void adoptLoadedProfile()
 {
-	// Will assume it's started at the start of the application and therefore no groups are present.
-	CDataFile iniFile;
-	if(!iniFile.Load(g_iniFileName))
+	if(g_profileIsLive)
 	{
-		// not there
 		return;
 	}
-	int groupCounter = 0;
-	const int numberOfGroups = iniFile.GetInt("AmountGroups", "General");
-	if(numberOfGroups==INT_MIN)
+	std::unique_ptr<ProfileSnapshot> loadedProfile = g_profileLoader.takeLoadedProfile();
+	if(nullptr == loadedProfile)
 	{
-		// old format file?
-		addDefaultGroup();
-		groupCounter=-1;	// enforce old format read for pre 1.0 ini file.
+		return;
 	}
-	else
+	g_deltaEncodeHashLists = loadedProfile->deltaEncodeHashLists;
+	g_autoSave = loadedProfile->autoSave;
+	g_profileLoadError = loadedProfile->loadError;
+	g_toggleGroups = std::move(loadedProfile->groups);
+	g_profileIsLive = true;
+	g_activeGroupsFilterIsDirty = true;
+
+	// from now on, changes made to the ini file outside the addon are merged into the live groups.
+	startHotReloading();
+}
+
+
+/// <summary>
+/// Merges the groups of an ini file which was changed outside the addon into the live groups. The file is parsed on a background thread; this
+/// only applies the differences, so groups which didn't change keep their state. Called at the start of each frame, on the render thread.
+/// </summary>
+void applyReloadedProfile()
+{
+	std::unique_ptr<ProfileHotReloader::ReloadedProfile> reloadedProfile = g_profileHotReloader.takeReloadedProfile();
+	if(nullptr != reloadedProfile)
 	{
-		for(int i=0;i<numberOfGroups;i++)
-		{
-			g_toggleGroups.push_back(ToggleGroup("", ToggleGroup::getNewGroupId()));
-		}
+		g_pendingReloadedProfile = std::move(reloadedProfile);
 	}
-	for(auto& group: g_toggleGroups)
+	if(nullptr == g_pendingReloadedProfile)
+	{
+		return;
+	}
+	bool isEditing = g_toggleGroupIdShaderEditing >= 0 || g_toggleGroupIdKeyBindingEditing >= 0;
+	for(auto& group : g_toggleGroups)
+	{
+		isEditing |= group.isEditing();
+	}
+	if(isEditing)
+	{
+		// applied when the editing is done, so the changes made by the user aren't overwritten halfway through.
+		return;
+	}
+	reloadedProfile = std::move(g_pendingReloadedProfile);
+
+	// the file we wrote ourselves is already live. If a save is still in progress, it'll overwrite the file anyway, so the live groups win.
+	const ProfileSaver::SaveState saveState = g_profileSaver.getStatus().state;
+	if(reloadedProfile->stamp == g_profileSaver.getLastSavedIniFileStamp() || saveState == ProfileSaver::SaveState::Pending || saveState == ProfileSaver::SaveState::Saving)
 	{
-		group.loadState(iniFile, groupCounter);		// groupCounter is normally 0 or greater. For when the old format is detected, it's -1 (and there's 1 group).
-		groupCounter++;
+		return;
 	}
+	g_profileLoadError = reloadedProfile->profile.loadError;
+	if(!g_profileLoadError.empty())
+	{
+		// the live groups are kept as they are.
+		return;
+	}
+	g_deltaEncodeHashLists = reloadedProfile->profile.deltaEncodeHashLists;
+	g_autoSave = reloadedProfile->profile.autoSave;
+	const ProfileHotReloader::ChangeSummary changes = ProfileHotReloader::applyProfileChanges(g_toggleGroups, std::move(reloadedProfile->profile.groups));
+	g_activeGroupsFilterIsDirty = true;
+	g_lastReloadDescription = "Ini file reloaded: " + std::to_string(changes.groupsChanged) + " group(s) changed, " + std::to_string(changes.groupsAdded) + 
+							  " added, " + std::to_string(changes.groupsRemoved) + " removed.";
 }
 
 
 /// <summary>
-/// Saves the currently known toggle groups with their shader hashes to the shadertoggler.ini file
+/// Saves the currently known toggle groups with their shader hashes to the shadertoggler.ini file. The groups are copied and written on a
+/// background thread, so this doesn't stall the frame. Progress is reported through g_profileSaver.getStatus().
 /// </summary>
 void saveShaderTogglerIniFile()
 {
-	// format: first section with # of groups, then per group a section with pixel and vertex shaders, as well as their name and key value.
-	// groups are stored with "Group" + group counter, starting with 0.
-	CDataFile iniFile;
-	iniFile.SetInt("AmountGroups", g_toggleGroups.size(), "",  "General");
+	if(!g_profileLoadError.empty())
+	{
+		return;
+	}
+	g_profileSaver.requestSave(createProfileSnapshot(), std::chrono::milliseconds(0));
+}
+
+
+/// <summary>
+/// Called after a group has been changed. If autosave is enabled, schedules a save after a short delay. Every change in that period moves the
+/// save further out, so a burst of edits results in a single save.
+/// </summary>
+void requestAutoSave()
+{
+	if(g_autoSave && g_profileLoadError.empty())
+	{
+		g_profileSaver.requestSave(createProfileSnapshot(), std::chrono::milliseconds(AUTOSAVE_DELAY_MS));
+	}
+}
+
+
+static void onInitEffectRuntime(effect_runtime* runtime)
+{
+	g_amountEffectRuntimes++;
+	// started here rather than in DllMain, as the load thread can't be started nor joined safely under the loader lock.
+	g_profileLoader.startLoading(g_iniFileName, g_compiledProfileFileName);
+	if(g_profileIsLive)
+	{
+		// watching was stopped when the previous runtime was destroyed.
+		startHotReloading();
+	}
+}
+
 
-	int groupCounter = 0;
-	for(const auto& group: g_toggleGroups)
+/// <summary>
+/// Stops and joins the background threads when the last effect runtime goes away. This is the last point where that's possible: DllMain runs
+/// under the loader lock, which threads need to exit. A pending autosave is written right away, so the last edits aren't lost.
+/// </summary>
+static void onDestroyEffectRuntime(effect_runtime* runtime)
+{
+	g_amountEffectRuntimes--;
+	if(g_amountEffectRuntimes > 0)
 	{
-		group.saveState(iniFile, groupCounter);
-		groupCounter++;
+		return;
 	}
-	iniFile.SetFileName(g_iniFileName);
-	iniFile.Save();
+	g_profileLoader.stop();
+	g_profileSaver.stop();
+	g_profileHotReloader.stopWatching();
 }
 
 
@@ -167,35 +372,63 @@ static void onDestroyCommandList(command_list *commandList)
 static void onResetCommandList(command_list *commandList)
 {
 	CommandListDataContainer &commandListData = commandList->get_private_data<CommandListDataContainer>();
-	commandListData.activePixelShaderPipeline = -1;
-	commandListData.activeVertexShaderPipeline = -1;
-	commandListData.activeComputeShaderPipeline = -1;
+	commandListData = CommandListDataContainer();
 }
 
 
 static void onInitPipeline(device *device, pipeline_layout, uint32_t subobjectCount, const pipeline_subobject *subobjects, pipeline pipelineHandle)
 {
+	// when the pipeline creations are profiled, the time spent here and in hashing is recorded with the hashes.
+	const bool profileCreation = g_pipelineCreationProfiler.isRunning();
+	PipelineCreationProfiler::PipelineCreation creation;
+	if(profileCreation)
+	{
+		creation.startTime = std::chrono::steady_clock::now();
+	}
+	auto hashShader = [&](void* shaderData, PipelineCreationProfiler::ShaderStage stage)
+	{
+		if(!profileCreation)
+		{
+			return calculateShaderHash(shaderData);
+		}
+		const auto hashingStartTime = std::chrono::steady_clock::now();
+		const uint32_t shaderHash = calculateShaderHash(shaderData);
+		creation.hashingTime += std::chrono::steady_clock::now() - hashingStartTime;
+		creation.bytesHashed += nullptr == shaderData ? 0 : static_cast<shader_desc*>(shaderData)->code_size;
+		creation.shaderHashes[stage] = shaderHash;
+		return shaderHash;
+	};
+
 	// shader has been created, we will now create a hash and store it with the handle we got.
 	for (uint32_t i = 0; i < subobjectCount; ++i)
 	{
 		switch (subobjects[i].type)
 		{
 			case pipeline_subobject_type::vertex_shader:
-				g_vertexShaderManager.addHashHandlePair(calculateShaderHash(subobjects[i].data), pipelineHandle.handle);
+				g_vertexShaderManager.addHashHandlePair(hashShader(subobjects[i].data, PipelineCreationProfiler::VertexShaderStage), pipelineHandle.handle);
 				break;
 			case pipeline_subobject_type::pixel_shader:
-				g_pixelShaderManager.addHashHandlePair(calculateShaderHash(subobjects[i].data), pipelineHandle.handle);
+				g_pixelShaderManager.addHashHandlePair(hashShader(subobjects[i].data, PipelineCreationProfiler::PixelShaderStage), pipelineHandle.handle);
 				break;
 			case pipeline_subobject_type::compute_shader:
-				g_computeShaderManager.addHashHandlePair(calculateShaderHash(subobjects[i].data), pipelineHandle.handle);
+				g_computeShaderManager.addHashHandlePair(hashShader(subobjects[i].data, PipelineCreationProfiler::ComputeShaderStage), pipelineHandle.handle);
 				break;
 		}
 	}
+
+	if(profileCreation)
+	{
+		creation.endTime = std::chrono::steady_clock::now();
+		creation.frame = g_activityFrame.load(std::memory_order_relaxed);
+		creation.threadId = GetCurrentThreadId();
+		g_pipelineCreationProfiler.onPipelineCreated(creation);
+	}
 }
 
 
 static void onDestroyPipeline(device *device, pipeline pipelineHandle)
 {
+	g_pipelineGeneration.fetch_add(1, std::memory_order_relaxed);
 	g_pixelShaderManager.removeHandle(pipelineHandle.handle);
 	g_vertexShaderManager.removeHandle(pipelineHandle.handle);
 	g_computeShaderManager.removeHandle(pipelineHandle.handle);
@@ -216,6 +449,11 @@ static void displayShaderManagerInfo(ShaderManager& toDisplay, const char* shade
 	if(toDisplay.isInHuntingMode())
 	{
 		ImGui::Text("# of %s shaders active: %d. # of %s shaders in group: %d", shaderType, toDisplay.getAmountShaderHashesCollected(), shaderType, toDisplay.getMarkedShaderCount());
+		if(toDisplay.isBisecting())
+		{
+			ImGui::Text("Bisecting %s shaders: %d candidates left. Half of them is hidden: is the element gone?", shaderType, toDisplay.getBisectionCandidateCount());
+			return;
+		}
 		ImGui::Text("Current selected %s shader: %d / %d.", shaderType, toDisplay.getActiveHuntedShaderIndex(), toDisplay.getAmountShaderHashesCollected());
 		if(toDisplay.isHuntedShaderMarked())
 		{
@@ -230,6 +468,41 @@ static void displayShaderManagerStats(ShaderManager& toDisplay, const char* shad
 }
 
 
+static void displayCollectionProgress()
+{
+	ImGui::Text("Collecting active shaders... frame %d / %d", g_collectionPhase.getFramesCollected(), g_collectionPhase.getMaxFrameCount());
+	if(g_collectionPhase.isAdaptive())
+	{
+		// progress towards convergence: the collection phase ends when the bar is full.
+		const float convergence = static_cast<float>(g_collectionPhase.getFramesWithoutNewShaders()) / static_cast<float>(g_collectionPhase.getConvergenceFrameCount());
+		char progressText[64];
+		snprintf(progressText, sizeof(progressText), "no new shaders for %d / %d frames", g_collectionPhase.getFramesWithoutNewShaders(), g_collectionPhase.getConvergenceFrameCount());
+		ImGui::ProgressBar(convergence, ImVec2(-1.0f, 0.0f), progressText);
+	}
+}
+
+
+static void displayProfileLoadStats()
+{
+	if(g_profileIsLive)
+	{
+		ImGui::Text("Toggle groups loaded in %.2f ms.", g_profileLoader.getLoadTimeInMilliseconds());
+		if(!g_lastReloadDescription.empty())
+		{
+			ImGui::TextUnformatted(g_lastReloadDescription.c_str());
+		}
+		if(!g_profileLoadError.empty())
+		{
+			ImGui::TextWrapped("%s The toggle groups aren't saved, so the ini file isn't overwritten.", g_profileLoadError.c_str());
+		}
+	}
+	else
+	{
+		ImGui::Text("Loading toggle groups...");
+	}
+}
+
+
 static void onReshadeOverlay(reshade::api::effect_runtime *runtime)
 {
 	if(g_toggleGroupIdShaderEditing>=0)
@@ -255,11 +528,11 @@ static void onReshadeOverlay(reshade::api::effect_runtime *runtime)
 		displayShaderManagerStats(g_vertexShaderManager, "vertex");
 		displayShaderManagerStats(g_pixelShaderManager, "pixel");
 		displayShaderManagerStats(g_computeShaderManager, "compute");
+		displayProfileLoadStats();
 
-		if(g_activeCollectorFrameCounter > 0)
+		if(g_collectionPhase.isCollecting())
 		{
-			const uint32_t counterValue = g_activeCollectorFrameCounter;
-			ImGui::Text("Collecting active shaders... frames to go: %d", counterValue);
+			displayCollectionProgress();
 		}
 		else
 		{
@@ -276,152 +549,674 @@ static void onReshadeOverlay(reshade::api::effect_runtime *runtime)
 }
 
 
-static void onBindPipeline(command_list* commandList, pipeline_stage stages, pipeline pipelineHandle)
+/// <summary>
+/// Resolves the shaders of the pipeline bound into the command list's active shaders.
+/// </summary>
+static void bindPipeline(command_list* commandList, pipeline_stage stages, pipeline pipelineHandle)
 {
-	if(nullptr != commandList && pipelineHandle.handle != 0)
+	if(nullptr == commandList || pipelineHandle.handle == 0)
+	{
+		return;
+	}
+	CommandListDataContainer& commandListData = commandList->get_private_data<CommandListDataContainer>();
+	const bool isCollecting = g_collectionPhase.isCollecting();
+	const bool trackShaderActivity = g_trackShaderActivity.load(std::memory_order_relaxed);
+	const uint32_t pipelineGeneration = g_pipelineGeneration.load(std::memory_order_relaxed);
+	if(!isCollecting && commandListData.lastBoundPipeline == pipelineHandle.handle && commandListData.lastBoundPipelineGeneration == pipelineGeneration)
 	{
-		const bool handleHasPixelShaderAttached = g_pixelShaderManager.isKnownHandle(pipelineHandle.handle);
-		const bool handleHasVertexShaderAttached = g_vertexShaderManager.isKnownHandle(pipelineHandle.handle);
-		const bool handleHasComputeShaderAttached = g_computeShaderManager.isKnownHandle(pipelineHandle.handle);
-		if(!handleHasPixelShaderAttached && !handleHasVertexShaderAttached && !handleHasComputeShaderAttached)
+		// re-bind of the pipeline the active shaders were resolved for last: nothing changes.
+		if(trackShaderActivity)
 		{
-			// draw call with unknown handle, don't collect it
-			return;
+			const uint32_t frame = g_activityFrame.load(std::memory_order_relaxed);
+			g_pixelShaderManager.markShaderSeen(commandListData.activePixelShader.shaderId, frame);
+			g_vertexShaderManager.markShaderSeen(commandListData.activeVertexShader.shaderId, frame);
+			g_computeShaderManager.markShaderSeen(commandListData.activeComputeShader.shaderId, frame);
 		}
-		CommandListDataContainer& commandListData = commandList->get_private_data<CommandListDataContainer>();
-		// always do the following code as that has to run for every bind on a pipeline:
-		if(g_activeCollectorFrameCounter > 0)
+		return;
+	}
+
+	const PipelineShader pixelShader = g_pixelShaderManager.getPipelineShader(pipelineHandle.handle);
+	const PipelineShader vertexShader = g_vertexShaderManager.getPipelineShader(pipelineHandle.handle);
+	const PipelineShader computeShader = g_computeShaderManager.getPipelineShader(pipelineHandle.handle);
+	if(trackShaderActivity)
+	{
+		const uint32_t frame = g_activityFrame.load(std::memory_order_relaxed);
+		g_pixelShaderManager.markShaderSeen(pixelShader.shaderId, frame);
+		g_vertexShaderManager.markShaderSeen(vertexShader.shaderId, frame);
+		g_computeShaderManager.markShaderSeen(computeShader.shaderId, frame);
+	}
+	const bool handleHasPixelShaderAttached = pixelShader.shaderId != ShaderIdBitset::NO_ID;
+	const bool handleHasVertexShaderAttached = vertexShader.shaderId != ShaderIdBitset::NO_ID;
+	const bool handleHasComputeShaderAttached = computeShader.shaderId != ShaderIdBitset::NO_ID;
+	if(!handleHasPixelShaderAttached && !handleHasVertexShaderAttached && !handleHasComputeShaderAttached)
+	{
+		// draw call with unknown handle, don't collect it. The active shaders stay as they are, so a re-bind can skip the lookups too.
+		commandListData.lastBoundPipeline = isCollecting ? 0 : pipelineHandle.handle;
+		commandListData.lastBoundPipelineGeneration = pipelineGeneration;
+		return;
+	}
+	if(isCollecting)
+	{
+		// in collection mode, only the stages bound are made active.
+		g_pixelShaderManager.addActiveShader(pixelShader.shaderId);
+		g_vertexShaderManager.addActiveShader(vertexShader.shaderId);
+		g_computeShaderManager.addActiveShader(computeShader.shaderId);
+		const bool bindsPixelStage = (stages & pipeline_stage::pixel_shader) == pipeline_stage::pixel_shader;
+		const bool bindsVertexStage = (stages & pipeline_stage::vertex_shader) == pipeline_stage::vertex_shader;
+		const bool bindsComputeStage = (stages & pipeline_stage::compute_shader) == pipeline_stage::compute_shader;
+		commandListData.activePixelShader = handleHasPixelShaderAttached && bindsPixelStage ? pixelShader : commandListData.activePixelShader;
+		commandListData.activeVertexShader = handleHasVertexShaderAttached && bindsVertexStage ? vertexShader : commandListData.activeVertexShader;
+		commandListData.activeComputeShader = handleHasComputeShaderAttached && bindsComputeStage ? computeShader : commandListData.activeComputeShader;
+		commandListData.lastBoundPipeline = 0;
+		return;
+	}
+	commandListData.activePixelShader = handleHasPixelShaderAttached ? pixelShader : commandListData.activePixelShader;
+	commandListData.activeVertexShader = handleHasVertexShaderAttached ? vertexShader : commandListData.activeVertexShader;
+	commandListData.activeComputeShader = handleHasComputeShaderAttached ? computeShader : commandListData.activeComputeShader;
+	commandListData.lastBoundPipeline = pipelineHandle.handle;
+	commandListData.lastBoundPipelineGeneration = pipelineGeneration;
+}
+
+
+static SubmissionCostProfiler::BoundShaders getBoundShaders(const CommandListDataContainer& commandListData)
+{
+	return { commandListData.activePixelShader, commandListData.activeVertexShader, commandListData.activeComputeShader };
+}
+
+
+static void onBindPipeline(command_list* commandList, pipeline_stage stages, pipeline pipelineHandle)
+{
+	if(nullptr == commandList || !g_submissionCostProfiler.isRunning())
+	{
+		bindPipeline(commandList, stages, pipelineHandle);
+		return;
+	}
+	const CommandListDataContainer& commandListData = commandList->get_private_data<CommandListDataContainer>();
+	const SubmissionCostProfiler::BoundShaders previouslyBound = getBoundShaders(commandListData);
+	bindPipeline(commandList, stages, pipelineHandle);
+	g_submissionCostProfiler.onBind(previouslyBound, getBoundShaders(commandListData), g_activityFrame.load(std::memory_order_relaxed));
+}
+
+
+/// <summary>
+/// Counts the draw about to be recorded on the command list specified for the shaders bound, if the submission cost profiler runs.
+/// </summary>
+static void profileDraw(command_list* commandList)
+{
+	if(nullptr == commandList || !g_submissionCostProfiler.isRunning())
+	{
+		return;
+	}
+	const CommandListDataContainer& commandListData = commandList->get_private_data<CommandListDataContainer>();
+	if(!commandListData.isReissuingDraw)
+	{
+		g_submissionCostProfiler.onDraw(getBoundShaders(commandListData), g_activityFrame.load(std::memory_order_relaxed));
+	}
+}
+
+
+/// <summary>
+/// Returns true if the shader with the id specified is in an active group's shaders of the stage specified, and that group blocks the draw: a
+/// throttled group only blocks the draws its throttle counters don't keep. The groups with the shader are the bits set in its group mask, so
+/// shaders which aren't in any active group cost one load.
+/// </summary>
+template<std::vector<uint64_t> ActiveGroupTable::* StageGroupMasks>
+static bool isBlockedByActiveGroup(const ActiveGroupTable* activeGroupTable, uint32_t shaderId, DrawThrottleCounters& throttleCounters)
+{
+	const bool collectStatistics = g_collectFilterStatistics.load(std::memory_order_relaxed);
+	bool isInActiveGroup = false;
+	bool isBlocked = false;
+	if(nullptr != activeGroupTable)
+	{
+		const std::vector<uint64_t>& groupMasks = activeGroupTable->*StageGroupMasks;
+		const size_t maskWords = activeGroupTable->maskWordsPerShader;
+		const size_t firstMaskWord = static_cast<size_t>(shaderId) * maskWords;
+		for(size_t word = 0; firstMaskWord < groupMasks.size() && word < maskWords; word++)
 		{
-			// in collection mode
-			if(handleHasPixelShaderAttached)
-			{
-				g_pixelShaderManager.addActivePipelineHandle(pipelineHandle.handle);
-			}
-			if(handleHasVertexShaderAttached)
+			for(uint64_t groupMask = groupMasks[firstMaskWord + word]; groupMask != 0; groupMask &= groupMask - 1)
 			{
-				g_vertexShaderManager.addActivePipelineHandle(pipelineHandle.handle);
-			}
-			if(handleHasComputeShaderAttached)
-			{
-				g_computeShaderManager.addActivePipelineHandle(pipelineHandle.handle);
+				isInActiveGroup = true;
+				const auto& entry = activeGroupTable->entries[word * 64 + std::countr_zero(groupMask)];
+				if(entry.throttleMode == DrawThrottleMode::ReduceInstances)
+				{
+					throttleCounters.reduceInstances(entry.throttleValue);
+					continue;
+				}
+				isBlocked |= entry.throttleSlot == DrawThrottleCounters::NO_SLOT || !throttleCounters.keepDraw(entry.throttleSlot, entry.throttleMode, entry.throttleValue);
 			}
 		}
-		else
+	}
+	if(collectStatistics)
+	{
+		(isInActiveGroup ? g_filterHitCount : g_filterRejectCount).fetch_add(1, std::memory_order_relaxed);
+	}
+	return isBlocked;
+}
+
+
+/// <summary>
+/// Checks the shader bound to one stage: against the shader manager's hunting state if hunting, and against the active groups if CheckGroups is set.
+/// </summary>
+template<bool IsHunting, bool CheckGroups, std::vector<uint64_t> ActiveGroupTable::* StageGroupMasks>
+static bool isBlockedStage(ShaderManager& shaderManager, const PipelineShader& pipelineShader, const ActiveGroupTable* activeGroupTable, DrawThrottleCounters& throttleCounters)
+{
+	if constexpr(!IsHunting && !CheckGroups)
+	{
+		return false;
+	}
+	else
+	{
+		if(pipelineShader.shaderId == ShaderIdBitset::NO_ID)
 		{
-			commandListData.activePixelShaderPipeline = handleHasPixelShaderAttached ? pipelineHandle.handle : commandListData.activePixelShaderPipeline;
-			commandListData.activeVertexShaderPipeline = handleHasVertexShaderAttached ? pipelineHandle.handle : commandListData.activeVertexShaderPipeline;
-			commandListData.activeComputeShaderPipeline = handleHasComputeShaderAttached ? pipelineHandle.handle : commandListData.activeComputeShaderPipeline;
+			// nothing bound to this stage since the last reset
+			return false;
 		}
-		if((stages & pipeline_stage::pixel_shader) == pipeline_stage::pixel_shader)
+		bool blockCall = false;
+		if constexpr(IsHunting)
 		{
-			if(handleHasPixelShaderAttached)
-			{
-				if(g_activeCollectorFrameCounter > 0)
-				{
-					// in collection mode
-					g_pixelShaderManager.addActivePipelineHandle(pipelineHandle.handle);
-				}
-				commandListData.activePixelShaderPipeline = pipelineHandle.handle;
-			}
+			blockCall |= shaderManager.isBlockedShader(pipelineShader.shaderId);
 		}
-		if((stages & pipeline_stage::vertex_shader) == pipeline_stage::vertex_shader)
+		if constexpr(CheckGroups)
 		{
-			if(handleHasVertexShaderAttached)
-			{
-				if(g_activeCollectorFrameCounter > 0)
-				{
-					// in collection mode
-					g_vertexShaderManager.addActivePipelineHandle(pipelineHandle.handle);
-				}
-				commandListData.activeVertexShaderPipeline = pipelineHandle.handle;
-			}
+			blockCall |= isBlockedByActiveGroup<StageGroupMasks>(activeGroupTable, pipelineShader.shaderId, throttleCounters);
 		}
-		if((stages & pipeline_stage::compute_shader) == pipeline_stage::compute_shader)
+		return blockCall;
+	}
+}
+
+
+/// <summary>
+/// Draw call check, specialized for the current state: whether shaders are being hunted, and which stages have shaders in active groups. Stages
+/// without anything to check cost nothing, and when no group is active and nothing is hunted, the check returns right away. The kernel to use
+/// is selected by selectBlockDrawCallKernel whenever that state changes.
+/// </summary>
+/// <returns>the percentage of the draw call's instances to draw: 0 if the draw call has to be blocked, DrawThrottleCounters::ALL_INSTANCES if
+/// it's drawn as is</returns>
+template<bool IsHunting, uint32_t ActiveGroupStages>
+static uint32_t blockDrawCallKernel(command_list* commandList)
+{
+	if constexpr(!IsHunting && ActiveGroupStages == 0)
+	{
+		return DrawThrottleCounters::ALL_INSTANCES;
+	}
+	else
+	{
+		if(nullptr==commandList)
 		{
-			if(handleHasComputeShaderAttached)
-			{
-				if(g_activeCollectorFrameCounter > 0)
-				{
-					// in collection mode
-					g_computeShaderManager.addActivePipelineHandle(pipelineHandle.handle);
-				}
-				commandListData.activeComputeShaderPipeline = pipelineHandle.handle;
-			}
+			return DrawThrottleCounters::ALL_INSTANCES;
+		}
+
+		CommandListDataContainer &commandListData = commandList->get_private_data<CommandListDataContainer>();
+		if(commandListData.isReissuingDraw)
+		{
+			// the draw with fewer instances issued for a draw which was checked already.
+			return DrawThrottleCounters::ALL_INSTANCES;
 		}
+		// the active group table and the hunting states are only read inside this section, so they can't be freed while this draw uses them.
+		const ReaderEpochs::ReadSection readSection;
+		const ActiveGroupTable* activeGroupTable = (ActiveGroupStages != 0) ? g_activeGroupTable.load(std::memory_order_acquire) : nullptr;
+		DrawThrottleCounters& throttleCounters = commandListData.throttleCounters;
+		if constexpr(ActiveGroupStages != 0)
+		{
+			throttleCounters.beginDraw(g_activityFrame.load(std::memory_order_relaxed));
+		}
+		bool blockCall = isBlockedStage<IsHunting, (ActiveGroupStages & PixelStage) != 0, &ActiveGroupTable::pixelShaderGroupMasks>(g_pixelShaderManager, commandListData.activePixelShader, activeGroupTable, throttleCounters);
+		blockCall |= isBlockedStage<IsHunting, (ActiveGroupStages & VertexStage) != 0, &ActiveGroupTable::vertexShaderGroupMasks>(g_vertexShaderManager, commandListData.activeVertexShader, activeGroupTable, throttleCounters);
+		blockCall |= isBlockedStage<IsHunting, (ActiveGroupStages & ComputeStage) != 0, &ActiveGroupTable::computeShaderGroupMasks>(g_computeShaderManager, commandListData.activeComputeShader, activeGroupTable, throttleCounters);
+		if(blockCall)
+		{
+			return 0;
+		}
+		return ActiveGroupStages != 0 ? throttleCounters.getKeptInstancePercentage() : DrawThrottleCounters::ALL_INSTANCES;
 	}
 }
 
 
+typedef uint32_t (*BlockDrawCallKernel)(command_list* commandList);
+
+template<bool IsHunting, uint32_t... ActiveGroupStages>
+static constexpr std::array<BlockDrawCallKernel, sizeof...(ActiveGroupStages)> makeBlockDrawCallKernels(std::integer_sequence<uint32_t, ActiveGroupStages...>)
+{
+	return { &blockDrawCallKernel<IsHunting, ActiveGroupStages>... };
+}
+
+// indexed by [is hunting][active group stages]
+static constexpr std::array<BlockDrawCallKernel, AllStages + 1> g_blockDrawCallKernels[2] = 
+{
+	makeBlockDrawCallKernels<false>(std::make_integer_sequence<uint32_t, AllStages + 1>()),
+	makeBlockDrawCallKernels<true>(std::make_integer_sequence<uint32_t, AllStages + 1>())
+};
+static std::atomic<BlockDrawCallKernel> g_blockDrawCallKernel = g_blockDrawCallKernels[0][0];
+
+
 /// <summary>
-/// This function will return true if the command list specified has one or more shader hashes which are currently marked to be hidden. Otherwise false.
+/// Returns true if shader activity is tracked and has been for at least the activity window.
 /// </summary>
-/// <param name="commandList"></param>
-/// <returns>true if the draw call has to be blocked</returns>
-bool blockDrawCallForCommandList(command_list* commandList)
+static bool hasTrackedActivityWindow()
+{
+	return g_trackShaderActivity && g_activityFrame.load(std::memory_order_relaxed) - g_activityTrackingStartFrame >= static_cast<uint32_t>(g_framecountActivityWindow);
+}
+
+
+static uint32_t getFirstFrameOfActivityWindow()
+{
+	const uint32_t currentFrame = g_activityFrame.load(std::memory_order_relaxed);
+	const uint32_t activityWindow = static_cast<uint32_t>(g_framecountActivityWindow);
+	return currentFrame > activityWindow ? currentFrame - activityWindow : 1;
+}
+
+
+static void startTrackingShaderActivity()
 {
-	if(nullptr==commandList)
+	if(!g_trackShaderActivity)
 	{
-		return false;
+		g_activityTrackingStartFrame = g_activityFrame.load(std::memory_order_relaxed);
+		g_trackShaderActivity = true;
 	}
+}
 
-	const CommandListDataContainer &commandListData = commandList->get_private_data<CommandListDataContainer>();
-	uint32_t shaderHash = g_pixelShaderManager.getShaderHash(commandListData.activePixelShaderPipeline);
-	bool blockCall = g_pixelShaderManager.isBlockedShader(shaderHash);
-	for(auto& group : g_toggleGroups)
+
+/// <summary>
+/// Selects the draw call check kernel matching the current hunting state and the stages of the active groups. Called on the present thread,
+/// whenever one of these changes.
+/// </summary>
+void selectBlockDrawCallKernel()
+{
+	// the ablation profiler blocks shaders through the hunting state, so it needs the hunting check as well.
+	const bool isHunting = g_pixelShaderManager.isInHuntingMode() || g_vertexShaderManager.isInHuntingMode() || g_computeShaderManager.isInHuntingMode()
+						   || g_ablationProfiler.isRunning();
+	const ActiveGroupTable* activeGroupTable = g_activeGroupTable.load(std::memory_order_relaxed);
+	const uint32_t activeGroupStages = nullptr == activeGroupTable ? 0 : activeGroupTable->activeStages;
+	g_blockDrawCallKernel.store(g_blockDrawCallKernels[isHunting ? 1 : 0][activeGroupStages & AllStages], std::memory_order_release);
+}
+
+
+/// <summary>
+/// Sets the bit of the entry specified in the group masks of the shaders with the hashes specified, interning hashes of shaders not seen yet.
+/// </summary>
+static void addToGroupMasks(ShaderManager& shaderManager, const ShaderHashSet& hashes, size_t entryIndex, size_t maskWordsPerShader, std::vector<uint64_t>& groupMasks,
+							std::vector<uint32_t>& shaderIds)
+{
+	shaderManager.internShaderHashes(hashes.getHashes(), shaderIds);
+	for(const uint32_t shaderId : shaderIds)
 	{
-		blockCall |= group.isBlockedPixelShader(shaderHash);
+		const size_t firstMaskWord = static_cast<size_t>(shaderId) * maskWordsPerShader;
+		if(groupMasks.size() < firstMaskWord + maskWordsPerShader)
+		{
+			groupMasks.resize(firstMaskWord + maskWordsPerShader, 0);
+		}
+		groupMasks[firstMaskWord + entryIndex / 64] |= uint64_t(1) << (entryIndex % 64);
 	}
-	shaderHash = g_vertexShaderManager.getShaderHash(commandListData.activeVertexShaderPipeline);
-	blockCall |= g_vertexShaderManager.isBlockedShader(shaderHash);
+}
+
+
+/// <summary>
+/// Rebuilds the active group table from the live groups and publishes it for the draw call checks. Called on the present thread whenever a
+/// group is toggled or a group's shaders change. Replaced tables are kept alive until no draw call on another thread can still be reading them.
+/// </summary>
+void rebuildActiveGroupsFilter()
+{
+	auto newTable = std::make_unique<ActiveGroupTable>();
+	std::vector<const ToggleGroup*> tableGroups;
+	uint32_t amountThrottleSlotsUsed = 0;
 	for(auto& group : g_toggleGroups)
 	{
-		blockCall |= group.isBlockedVertexShader(shaderHash);
+		// throttled groups beyond the number of counter slots are left out of the table, so they draw everything rather than nothing. Reducing
+		// instances doesn't count draws, so needs no slot.
+		const bool isThrottled = group.isActive() && group.getThrottleMode() != DrawThrottleMode::HideAll && group.getThrottleMode() != DrawThrottleMode::ReduceInstances
+								 && amountThrottleSlotsUsed < DrawThrottleCounters::MAX_SLOTS;
+		group.setThrottleSlot(isThrottled ? amountThrottleSlotsUsed++ : DrawThrottleCounters::NO_SLOT);
+		if(group.isActive() && !group.isThrottleOverflowing())
+		{
+			newTable->activeStages |= group.getPixelShaderHashes().empty() ? 0 : PixelStage;
+			newTable->activeStages |= group.getVertexShaderHashes().empty() ? 0 : VertexStage;
+			newTable->activeStages |= group.getComputeShaderHashes().empty() ? 0 : ComputeStage;
+			newTable->entries.push_back({ group.getThrottleMode(), group.getThrottleValue(), group.getThrottleSlot() });
+			tableGroups.push_back(&group);
+		}
 	}
-	shaderHash = g_computeShaderManager.getShaderHash(commandListData.activeComputeShaderPipeline);
-	blockCall |= g_computeShaderManager.isBlockedShader(shaderHash);
-	for(auto& group : g_toggleGroups)
+	newTable->maskWordsPerShader = std::max<size_t>(1, (tableGroups.size() + 63) / 64);
+	std::vector<uint32_t> shaderIds;
+	for(size_t entryIndex = 0; entryIndex < tableGroups.size(); entryIndex++)
+	{
+		const ToggleGroup& group = *tableGroups[entryIndex];
+		addToGroupMasks(g_pixelShaderManager, group.getPixelShaderHashes(), entryIndex, newTable->maskWordsPerShader, newTable->pixelShaderGroupMasks, shaderIds);
+		addToGroupMasks(g_vertexShaderManager, group.getVertexShaderHashes(), entryIndex, newTable->maskWordsPerShader, newTable->vertexShaderGroupMasks, shaderIds);
+		addToGroupMasks(g_computeShaderManager, group.getComputeShaderHashes(), entryIndex, newTable->maskWordsPerShader, newTable->computeShaderGroupMasks, shaderIds);
+	}
+	g_retiredActiveGroupTables.retire(g_activeGroupTable.exchange(newTable.release(), std::memory_order_acq_rel));
+	g_activeGroupsFilterIsDirty = false;
+	selectBlockDrawCallKernel();
+}
+
+
+/// <summary>
+/// This function will return true if the command list specified has one or more shader hashes which are currently marked to be hidden. Otherwise false.
+/// </summary>
+/// <param name="commandList"></param>
+/// <returns>true if the draw call has to be blocked</returns>
+bool blockDrawCallForCommandList(command_list* commandList)
+{
+	// draws which can't be re-issued with fewer instances are drawn as is when their instances are to be reduced.
+	return g_blockDrawCallKernel.load(std::memory_order_acquire)(commandList) == 0;
+}
+
+
+/// <summary>
+/// Returns the number of instances the draw call about to be recorded on the command list specified has to be drawn with: 0 if it has to be
+/// blocked, instanceCount if it's drawn as is. When its instances are reduced, at least one instance is kept.
+/// </summary>
+static uint32_t getInstanceCountToDraw(command_list* commandList, uint32_t instanceCount)
+{
+	const uint32_t keptInstancePercentage = g_blockDrawCallKernel.load(std::memory_order_acquire)(commandList);
+	if(keptInstancePercentage >= DrawThrottleCounters::ALL_INSTANCES || keptInstancePercentage == 0)
 	{
-		blockCall |= group.isBlockedComputeShader(shaderHash);
+		return keptInstancePercentage == 0 ? 0 : instanceCount;
 	}
-	return blockCall;
+	const uint64_t reducedInstanceCount = static_cast<uint64_t>(instanceCount) * keptInstancePercentage / DrawThrottleCounters::ALL_INSTANCES;
+	return std::max(static_cast<uint32_t>(reducedInstanceCount), 1u);
+}
+
+
+/// <summary>
+/// Issues the draw specified on the command list instead of the draw being intercepted. The draw hooks let the draw through, as it's issued
+/// from within the hook for the same command list.
+/// </summary>
+/// <returns>true, so the intercepted draw is cancelled</returns>
+template<typename IssueDraw>
+static bool reissueDraw(command_list* commandList, IssueDraw issueDraw)
+{
+	CommandListDataContainer& commandListData = commandList->get_private_data<CommandListDataContainer>();
+	commandListData.isReissuingDraw = true;
+	issueDraw();
+	commandListData.isReissuingDraw = false;
+	return true;
 }
 
 
 static bool onDraw(command_list* commandList, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance)
 {
-	// check if for this command list the active shader handles are part of the blocked set. If so, return true
-	return blockDrawCallForCommandList(commandList);
+	// check if for this command list the active shader handles are part of the blocked set. If so, return true. If the instances are to be
+	// reduced, the draw is cancelled and issued again with fewer instances.
+	profileDraw(commandList);
+	const uint32_t instanceCountToDraw = getInstanceCountToDraw(commandList, instance_count);
+	if(instanceCountToDraw >= instance_count || instanceCountToDraw == 0)
+	{
+		return instanceCountToDraw < instance_count;
+	}
+	return reissueDraw(commandList, [=]() { commandList->draw(vertex_count, instanceCountToDraw, first_vertex, first_instance); });
 }
 
 
 static bool onDrawIndexed(command_list* commandList, uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance)
 {
 	// same as onDraw
-	return blockDrawCallForCommandList(commandList);
+	profileDraw(commandList);
+	const uint32_t instanceCountToDraw = getInstanceCountToDraw(commandList, instance_count);
+	if(instanceCountToDraw >= instance_count || instanceCountToDraw == 0)
+	{
+		return instanceCountToDraw < instance_count;
+	}
+	return reissueDraw(commandList, [=]() { commandList->draw_indexed(index_count, instanceCountToDraw, first_index, vertex_offset, first_instance); });
 }
 
 
 static bool onDrawOrDispatchIndirect(command_list* commandList, indirect_command type, resource buffer, uint64_t offset, uint32_t draw_count, uint32_t stride)
 {
+	profileDraw(commandList);
 	switch(type)
 	{
-		case indirect_command::unknown:
-		case indirect_command::draw:
-		case indirect_command::draw_indexed:
-		case indirect_command::dispatch:
-			// same as OnDraw
-			return blockDrawCallForCommandList(commandList);
-		// the rest aren't blocked
+		case indirect_command::unknown:
+		case indirect_command::draw:
+		case indirect_command::draw_indexed:
+		case indirect_command::dispatch:
+			// same as OnDraw
+			return blockDrawCallForCommandList(commandList);
+		// the rest aren't blocked
+	}
+	return false;
+}
+
+
+/// <summary>
+/// Advances the ablation profiler by a frame and blocks the shader it wants blocked in the coming frame. Starts it first if a start is pending
+/// and the shaders active in the activity window are known.
+/// </summary>
+static void updateAblationProfiler()
+{
+	if(g_ablationStartPending && hasTrackedActivityWindow())
+	{
+		g_ablationStartPending = false;
+		const uint32_t firstFrame = getFirstFrameOfActivityWindow();
+		std::vector<AblationProfiler::Candidate> candidates;
+		for(auto [shaderManager, shaderType] : { std::pair(&g_pixelShaderManager, "pixel"), std::pair(&g_vertexShaderManager, "vertex"), std::pair(&g_computeShaderManager, "compute") })
+		{
+			for(const PipelineShader& shader : shaderManager->getShadersSeenSince(firstFrame))
+			{
+				candidates.push_back({ shaderManager, shaderType, shader.shaderId, shader.shaderHash });
+			}
+		}
+		g_ablationStatusMessage = candidates.empty() ? "No active shaders found." : "";
+		g_ablationProfiler.start(std::move(candidates), g_ablationSettings);
+		selectBlockDrawCallKernel();
+	}
+	if(!g_ablationProfiler.isRunning() && nullptr == g_ablatedShaderManager)
+	{
+		return;
+	}
+	g_ablationProfiler.onFramePresented(std::chrono::steady_clock::now());
+	const AblationProfiler::Candidate* blockedCandidate = g_ablationProfiler.getBlockedCandidate();
+	ShaderManager* shaderManagerToBlockIn = nullptr == blockedCandidate ? nullptr : blockedCandidate->shaderManager;
+	if(nullptr != g_ablatedShaderManager && g_ablatedShaderManager != shaderManagerToBlockIn)
+	{
+		g_ablatedShaderManager->setAblatedShader(ShaderIdBitset::NO_ID);
+	}
+	if(nullptr != blockedCandidate)
+	{
+		blockedCandidate->shaderManager->setAblatedShader(blockedCandidate->shaderId);
+	}
+	g_ablatedShaderManager = shaderManagerToBlockIn;
+	if(!g_ablationProfiler.isRunning())
+	{
+		// done (or stopped): back to the kernel without the hunting check.
+		selectBlockDrawCallKernel();
+	}
+}
+
+
+/// <summary>
+/// Advances the measurement of a group's performance by a frame and puts the group in the state required for the coming frame. When done,
+/// the group gets its original state back and the result is stored.
+/// </summary>
+static void updateGroupPerformanceMeter()
+{
+	if(!g_groupPerformanceMeter.isRunning())
+	{
+		return;
+	}
+	const auto group = std::find_if(g_toggleGroups.begin(), g_toggleGroups.end(), [](const ToggleGroup& g) { return g.getId() == g_groupPerformanceMeter.getGroupId(); });
+	if(group == g_toggleGroups.end())
+	{
+		// removed while being measured.
+		g_groupPerformanceMeter.stop();
+		return;
+	}
+	g_groupPerformanceMeter.onFramePresented(std::chrono::steady_clock::now());
+	const bool requiredActiveState = g_groupPerformanceMeter.isRunning() ? g_groupPerformanceMeter.getRequiredActiveState() : g_groupPerformanceMeter.wasGroupActive();
+	if(group->isActive() != requiredActiveState)
+	{
+		group->toggleActive();
+		g_activeGroupsFilterIsDirty = true;
+	}
+	if(!g_groupPerformanceMeter.isRunning())
+	{
+		g_groupPerformanceResults[group->getId()] = g_groupPerformanceMeter.getResult();
+	}
+}
+
+
+/// <summary>
+/// Stops a running group measurement and gives the group its original state back.
+/// </summary>
+static void stopGroupPerformanceMeter()
+{
+	if(!g_groupPerformanceMeter.isRunning())
+	{
+		return;
+	}
+	g_groupPerformanceMeter.stop();
+	for(auto& group : g_toggleGroups)
+	{
+		if(group.getId() == g_groupPerformanceMeter.getGroupId() && group.isActive() != g_groupPerformanceMeter.wasGroupActive())
+		{
+			group.toggleActive();
+			g_activeGroupsFilterIsDirty = true;
+		}
+	}
+}
+
+
+/// <summary>
+/// Switches off the groups the frame time governor switched on and resets it.
+/// </summary>
+static void stopFrameTimeGovernor()
+{
+	for(auto& group : g_toggleGroups)
+	{
+		if(group.isActive() && std::find(g_governorActivatedGroupIds.begin(), g_governorActivatedGroupIds.end(), group.getId()) != g_governorActivatedGroupIds.end())
+		{
+			group.toggleActive();
+			g_activeGroupsFilterIsDirty = true;
+		}
+	}
+	g_governorActivatedGroupIds.clear();
+	g_frameTimeGovernor.reset();
+}
+
+
+/// <summary>
+/// Feeds the frame time of the last frame to the frame time governor and switches the performance group it asks for on or off.
+/// </summary>
+static void updateFrameTimeGovernor()
+{
+	const auto now = std::chrono::steady_clock::now();
+	const bool hasLastPresentTime = g_lastPresentTime != std::chrono::steady_clock::time_point();
+	const double frameTimeMs = std::chrono::duration<double, std::milli>(now - g_lastPresentTime).count();
+	g_lastPresentTime = now;
+	if(!g_frameTimeGovernorEnabled || !hasLastPresentTime)
+	{
+		return;
+	}
+	if(g_groupPerformanceMeter.isRunning() || g_ablationProfiler.isRunning() || g_ablationStartPending || g_toggleGroupIdShaderEditing >= 0)
+	{
+		// these hide shaders themselves, so the frame times don't reflect the groups switched on.
+		return;
+	}
+
+	// a group the governor switched on which was switched off or removed by the user isn't the governor's anymore. As what it measured
+	// per group no longer lines up, it starts over with the groups it still has switched on staying on.
+	const size_t amountActivated = g_governorActivatedGroupIds.size();
+	std::erase_if(g_governorActivatedGroupIds, [](int groupId)
+	{
+		const auto group = std::find_if(g_toggleGroups.begin(), g_toggleGroups.end(), [groupId](const ToggleGroup& g) { return g.getId() == groupId; });
+		return group == g_toggleGroups.end() || !group->isActive() || !group->isPerformanceGroup();
+	});
+	if(g_governorActivatedGroupIds.size() != amountActivated)
+	{
+		g_governorActivatedGroupIds.clear();
+		g_frameTimeGovernor.reset();
+	}
+
+	ToggleGroup* nextGroup = nullptr;
+	for(auto& group : g_toggleGroups)
+	{
+		if(group.isPerformanceGroup() && !group.isActive() && !group.isEmpty() && (nullptr == nextGroup || group.getPerformancePriority() > nextGroup->getPerformancePriority()))
+		{
+			nextGroup = &group;
+		}
+	}
+	switch(g_frameTimeGovernor.onFramePresented(frameTimeMs, nullptr != nextGroup))
+	{
+		case FrameTimeGovernor::Decision::ActivateNext:
+			nextGroup->toggleActive();
+			g_governorActivatedGroupIds.push_back(nextGroup->getId());
+			g_activeGroupsFilterIsDirty = true;
+			break;
+		case FrameTimeGovernor::Decision::DeactivateLast:
+			for(auto& group : g_toggleGroups)
+			{
+				if(group.getId() == g_governorActivatedGroupIds.back() && group.isActive())
+				{
+					group.toggleActive();
+					g_activeGroupsFilterIsDirty = true;
+				}
+			}
+			g_governorActivatedGroupIds.pop_back();
+			break;
+		default:
+			break;
+	}
+}
+
+
+/// <summary>
+/// Handles the hunting keys for one shader manager.
+/// </summary>
+static void handleHuntingKeys(effect_runtime* runtime, ShaderManager& shaderManager, uint32_t previousKey, uint32_t nextKey, uint32_t markKey)
+{
+	if(runtime->is_key_pressed(previousKey))
+	{
+		if(shaderManager.isBisecting())
+		{
+			shaderManager.answerBisection(true);
+		}
+		else
+		{
+			shaderManager.huntPreviousShader(runtime->is_key_down(VK_CONTROL));
+		}
+	}
+	if(runtime->is_key_pressed(nextKey))
+	{
+		if(shaderManager.isBisecting())
+		{
+			shaderManager.answerBisection(false);
+		}
+		else
+		{
+			shaderManager.huntNextShader(runtime->is_key_down(VK_CONTROL));
+		}
+	}
+	if(runtime->is_key_pressed(markKey))
+	{
+		if(runtime->is_key_down(VK_MENU))
+		{
+			shaderManager.toggleBisection();
+		}
+		else
+		{
+			shaderManager.toggleMarkOnHuntedShader();
+		}
 	}
-	return false;
 }
 
 
 static void onReshadePresent(effect_runtime* runtime)
 {
-	if(g_activeCollectorFrameCounter>0)
+	adoptLoadedProfile();
+	applyReloadedProfile();
+	g_presentCounter++;
+	g_retiredActiveGroupTables.collect();
+	g_pixelShaderManager.onFramePresented();
+	g_vertexShaderManager.onFramePresented();
+	g_computeShaderManager.onFramePresented();
+	g_pipelineCreationProfiler.onFramePresented(g_activityFrame.load(std::memory_order_relaxed), std::chrono::steady_clock::now());
+	g_activityFrame.fetch_add(1, std::memory_order_relaxed);
+	g_submissionCostProfiler.onFramePresented();
+
+	if(g_collectionPhase.isCollecting())
 	{
-		--g_activeCollectorFrameCounter;
+		g_collectionPhase.onFramePresented(g_pixelShaderManager.getAmountShaderHashesCollected() + g_vertexShaderManager.getAmountShaderHashesCollected() 
+										   + g_computeShaderManager.getAmountShaderHashesCollected());
 	}
 
 	for(auto& group: g_toggleGroups)
@@ -429,6 +1224,7 @@ static void onReshadePresent(effect_runtime* runtime)
 		if(group.isToggleKeyPressed(runtime))
 		{
 			group.toggleActive();
+			g_activeGroupsFilterIsDirty = true;
 			// if the group's shaders are being edited, it should toggle the ones currently marked.
 			if(group.getId() == g_toggleGroupIdShaderEditing)
 			{
@@ -439,6 +1235,14 @@ static void onReshadePresent(effect_runtime* runtime)
 		}
 	}
 
+	updateGroupPerformanceMeter();
+	updateFrameTimeGovernor();
+	if(g_activeGroupsFilterIsDirty)
+	{
+		rebuildActiveGroupsFilter();
+	}
+	updateAblationProfiler();
+
 	// hardcoded hunting keys.
 	// If Ctrl is pressed too, it'll step to the next marked shader (if any)
 	// Numpad 1: previous pixel shader
@@ -450,42 +1254,11 @@ static void onReshadePresent(effect_runtime* runtime)
 	// Numpad 7: previous compute shader
 	// Numpad 8: next compute shader
 	// Numpad 9: mark current compute shader as part of the toggle group
-	if(runtime->is_key_pressed(49))
-	{
-		g_pixelShaderManager.huntPreviousShader(runtime->is_key_down(VK_CONTROL));
-	}
-	if(runtime->is_key_pressed(50))
-	{
-		g_pixelShaderManager.huntNextShader(runtime->is_key_down(VK_CONTROL));
-	}
-	if(runtime->is_key_pressed(51))
-	{
-		g_pixelShaderManager.toggleMarkOnHuntedShader();
-	}
-	if(runtime->is_key_pressed(52))
-	{
-		g_vertexShaderManager.huntPreviousShader(runtime->is_key_down(VK_CONTROL));
-	}
-	if(runtime->is_key_pressed(53))
-	{
-		g_vertexShaderManager.huntNextShader(runtime->is_key_down(VK_CONTROL));
-	}
-	if(runtime->is_key_pressed(54))
-	{
-		g_vertexShaderManager.toggleMarkOnHuntedShader();
-	}
-	if(runtime->is_key_pressed(55))
-	{
-		g_computeShaderManager.huntPreviousShader(runtime->is_key_down(VK_CONTROL));
-	}
-	if(runtime->is_key_pressed(56))
-	{
-		g_computeShaderManager.huntNextShader(runtime->is_key_down(VK_CONTROL));
-	}
-	if(runtime->is_key_pressed(57))
-	{
-		g_computeShaderManager.toggleMarkOnHuntedShader();
-	}
+	// Alt + Numpad 3/6/9 starts/stops bisecting the pixel/vertex/compute shaders. While bisecting, the previous key (Numpad 1/4/7) answers
+	// 'the element is gone' and the next key (Numpad 2/5/8) answers 'the element is still visible'.
+	handleHuntingKeys(runtime, g_pixelShaderManager, 49, 50, 51);
+	handleHuntingKeys(runtime, g_vertexShaderManager, 52, 53, 54);
+	handleHuntingKeys(runtime, g_computeShaderManager, 55, 56, 57);
 }
 
 
@@ -499,6 +1272,7 @@ void endKeyBindingEditing(bool acceptCollectedBinding, ToggleGroup& groupEditing
 	if (acceptCollectedBinding && g_toggleGroupIdKeyBindingEditing == groupEditing.getId() && g_keyCollector.isValid())
 	{
 		groupEditing.setToggleKey(g_keyCollector);
+		requestAutoSave();
 	}
 	g_toggleGroupIdKeyBindingEditing = -1;
 	g_keyCollector.clear();
@@ -533,9 +1307,12 @@ void endShaderEditing(bool acceptCollectedShaderHashes, ToggleGroup& groupEditin
 	if(acceptCollectedShaderHashes && g_toggleGroupIdShaderEditing == groupEditing.getId())
 	{
 		groupEditing.storeCollectedHashes(g_pixelShaderManager.getMarkedShaderHashes(), g_vertexShaderManager.getMarkedShaderHashes(), g_computeShaderManager.getMarkedShaderHashes());
+		g_activeGroupsFilterIsDirty = true;
 		g_pixelShaderManager.stopHuntingMode();
 		g_vertexShaderManager.stopHuntingMode();
 		g_computeShaderManager.stopHuntingMode();
+		selectBlockDrawCallKernel();
+		requestAutoSave();
 	}
 	g_toggleGroupIdShaderEditing = -1;
 }
@@ -555,14 +1332,30 @@ void startShaderEditing(ToggleGroup& groupEditing)
 	{
 		endShaderEditing(false, groupEditing);
 	}
+	// the measurement would toggle the group while its shaders are edited.
+	stopGroupPerformanceMeter();
 	g_toggleGroupIdShaderEditing = groupEditing.getId();
-	g_activeCollectorFrameCounter = g_startValueFramecountCollectionPhase;
-	g_pixelShaderManager.startHuntingMode(groupEditing.getPixelShaderHashes());
-	g_vertexShaderManager.startHuntingMode(groupEditing.getVertexShaderHashes());
-	g_computeShaderManager.startHuntingMode(groupEditing.getComputeShaderHashes());
+	g_pixelShaderManager.startHuntingMode(groupEditing.getPixelShaderHashes().getHashes());
+	g_vertexShaderManager.startHuntingMode(groupEditing.getVertexShaderHashes().getHashes());
+	g_computeShaderManager.startHuntingMode(groupEditing.getComputeShaderHashes().getHashes());
+	if(hasTrackedActivityWindow())
+	{
+		// the tracker has covered the whole window, so the shaders used in it are known already: no collection phase needed.
+		const uint32_t firstFrame = getFirstFrameOfActivityWindow();
+		g_pixelShaderManager.collectShadersSeenSince(firstFrame);
+		g_vertexShaderManager.collectShadersSeenSince(firstFrame);
+		g_computeShaderManager.collectShadersSeenSince(firstFrame);
+		g_collectionPhase.stop();
+	}
+	else
+	{
+		g_collectionPhase.start(g_startValueFramecountCollectionPhase, g_stopCollectingWhenConverged ? g_framecountCollectionConvergence : 0);
+	}
 
 	// after copying them to the managers, we can now clear the group's shader.
 	groupEditing.clearHashes();
+	g_activeGroupsFilterIsDirty = true;
+	selectBlockDrawCallKernel();
 }
 
 
@@ -580,6 +1373,330 @@ static void showHelpMarker(const char* desc)
 }
 
 
+static void displaySaveStatus()
+{
+	const ProfileSaver::SaveStatus status = g_profileSaver.getStatus();
+	switch(status.state)
+	{
+		case ProfileSaver::SaveState::Pending:
+		case ProfileSaver::SaveState::Saving:
+			ImGui::TextDisabled("Saving...");
+			break;
+		case ProfileSaver::SaveState::Succeeded:
+			ImGui::TextDisabled("Saved.");
+			break;
+		case ProfileSaver::SaveState::Failed:
+			ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.3f, 0.3f, 1.0f));
+			ImGui::Text("Save failed: %s", status.message.c_str());
+			ImGui::PopStyleColor();
+			break;
+		default:
+			break;
+	}
+}
+
+
+static void displayFilterStatistics()
+{
+	bool collectStatistics = g_collectFilterStatistics;
+	if(ImGui::Checkbox("Collect draw call lookup statistics", &collectStatistics))
+	{
+		g_collectFilterStatistics = collectStatistics;
+	}
+	ImGui::SameLine();
+	showHelpMarker("Draw calls look up the active groups with their shaders in a bitmask per shader, so shaders that aren't in any active group are skipped with a single read. Counting how often that happens costs a little performance, so it's off by default.");
+	const uint64_t rejectCount = g_filterRejectCount;
+	const uint64_t hitCount = g_filterHitCount;
+	const uint64_t lookupCount = rejectCount + hitCount;
+	if(lookupCount > 0)
+	{
+		ImGui::Text("Shader lookups: %llu. In no active group: %.2f%%. In an active group: %.2f%%.", lookupCount, 100.0 * rejectCount / lookupCount, 100.0 * hitCount / lookupCount);
+	}
+	if(ImGui::Button("Reset statistics"))
+	{
+		g_filterRejectCount = 0;
+		g_filterHitCount = 0;
+	}
+}
+
+
+static void displayAblationProfiler()
+{
+	ImGui::PushTextWrapPos();
+	ImGui::TextUnformatted("Measures what each active shader costs in frame time, by hiding the shaders one at a time and comparing the frame time against the frame time right before. Keep the camera still while it runs.");
+	ImGui::PopTextWrapPos();
+	if(g_ablationStartPending)
+	{
+		ImGui::TextUnformatted("Waiting for the shader activity tracker to see which shaders are active...");
+	}
+	else if(g_ablationProfiler.isRunning())
+	{
+		char progressText[64];
+		snprintf(progressText, sizeof(progressText), "%d frames to go", g_ablationProfiler.getFramesToGo());
+		ImGui::ProgressBar(g_ablationProfiler.getProgress(), ImVec2(-1.0f, 0.0f), progressText);
+	}
+	if(g_ablationStartPending || g_ablationProfiler.isRunning())
+	{
+		if(ImGui::Button("Stop"))
+		{
+			g_ablationStartPending = false;
+			g_ablationProfiler.stop();
+			// stopped during a baseline phase no shader is ablated, so updateAblationProfiler has nothing left to do and won't get to this.
+			selectBlockDrawCallKernel();
+		}
+	}
+	else
+	{
+		ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.5f);
+		int framesPerSample = g_ablationSettings.framesPerSample;
+		int warmupFrames = g_ablationSettings.warmupFrames;
+		int rounds = g_ablationSettings.rounds;
+		ImGui::SliderInt("# of frames measured per sample", &framesPerSample, 3, 60);
+		ImGui::SliderInt("# of frames skipped before measuring", &warmupFrames, 0, 10);
+		ImGui::SliderInt("# of rounds", &rounds, 1, 10);
+		ImGui::PopItemWidth();
+		g_ablationSettings.framesPerSample = framesPerSample;
+		g_ablationSettings.warmupFrames = warmupFrames;
+		g_ablationSettings.rounds = rounds;
+		if(g_toggleGroupIdShaderEditing >= 0)
+		{
+			ImGui::TextUnformatted("Finish editing the group's shaders before profiling.");
+		}
+		else if(g_groupPerformanceMeter.isRunning())
+		{
+			ImGui::TextUnformatted("Wait for the group measurement to finish before profiling.");
+		}
+		else if(ImGui::Button("Profile active shaders"))
+		{
+			// the candidates are the shaders the activity tracker saw in its window.
+			startTrackingShaderActivity();
+			g_ablationStartPending = true;
+		}
+	}
+	if(!g_ablationProfiler.hasResults())
+	{
+		return;
+	}
+	const std::vector<AblationProfiler::Result> results = g_ablationProfiler.getResults();
+	if(ImGui::BeginTable("ShaderCost", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 12)))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Shader");
+		ImGui::TableSetupColumn("Frame time delta (ms)");
+		ImGui::TableSetupColumn("95% interval (ms)");
+		ImGui::TableSetupColumn("Samples");
+		ImGui::TableHeadersRow();
+		for(const auto& result : results)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%s %08X", result.candidate.shaderType, result.candidate.shaderHash);
+			ImGui::TableNextColumn();
+			ImGui::Text("%+.3f", result.meanDeltaMs);
+			ImGui::TableNextColumn();
+			ImGui::Text("+/- %.3f", result.confidenceIntervalMs);
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", result.amountSamples);
+		}
+		ImGui::EndTable();
+	}
+	if(ImGui::Button("Export to CSV"))
+	{
+		std::string errorMessage;
+		g_ablationStatusMessage = g_ablationProfiler.writeCsv(g_shaderCostFileName, errorMessage) ? "Written to " + g_shaderCostFileName : errorMessage;
+	}
+	if(!g_ablationStatusMessage.empty())
+	{
+		ImGui::SameLine();
+		ImGui::TextUnformatted(g_ablationStatusMessage.c_str());
+	}
+}
+
+
+/// <summary>
+/// Returns the names of the groups with the shader hash specified in the stage specified, separated by commas.
+/// </summary>
+static std::string getNamesOfGroupsWithShader(SubmissionCostProfiler::ShaderStage stage, uint32_t shaderHash)
+{
+	std::string groupNames;
+	for(const auto& group : g_toggleGroups)
+	{
+		const ShaderHashSet& hashes = stage == SubmissionCostProfiler::PixelShaderStage ? group.getPixelShaderHashes()
+									  : stage == SubmissionCostProfiler::VertexShaderStage ? group.getVertexShaderHashes() : group.getComputeShaderHashes();
+		if(hashes.contains(shaderHash))
+		{
+			groupNames += (groupNames.empty() ? "" : ", ") + group.getName();
+		}
+	}
+	return groupNames;
+}
+
+
+static void displaySubmissionCostProfiler()
+{
+	ImGui::PushTextWrapPos();
+	ImGui::TextUnformatted("Counts, per shader, the draws and pipeline binds the game does with it and the CPU time spent between these calls while it's bound. Shaders with a lot of CPU time are worth hiding when the game is limited by the CPU rather than the GPU.");
+	ImGui::PopTextWrapPos();
+	if(g_submissionCostProfiler.isRunning())
+	{
+		if(ImGui::Button("Stop"))
+		{
+			g_submissionCostProfiler.stop();
+		}
+	}
+	else if(ImGui::Button("Profile CPU cost"))
+	{
+		g_submissionCostProfiler.start();
+	}
+	const uint32_t framesProfiled = g_submissionCostProfiler.getFramesProfiled();
+	if(framesProfiled == 0)
+	{
+		return;
+	}
+	ImGui::SameLine();
+	ImGui::Text("%u frames profiled", framesProfiled);
+	const std::vector<SubmissionCostProfiler::Result> results = g_submissionCostProfiler.getTopShaders(SUBMISSION_COST_TOP_SHADER_COUNT);
+	static const char* stageNames[] = { "pixel", "vertex", "compute" };
+	if(ImGui::BeginTable("ShaderCpuCost", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 12)))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Shader");
+		ImGui::TableSetupColumn("CPU time per frame (ms)");
+		ImGui::TableSetupColumn("Draws per frame");
+		ImGui::TableSetupColumn("Binds per frame");
+		ImGui::TableSetupColumn("In groups");
+		ImGui::TableHeadersRow();
+		for(const auto& result : results)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%s %08X", stageNames[result.stage], result.shaderHash);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", static_cast<double>(result.totals.timeNs) / 1000000.0 / framesProfiled);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", static_cast<double>(result.totals.draws) / framesProfiled);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", static_cast<double>(result.totals.binds) / framesProfiled);
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(getNamesOfGroupsWithShader(result.stage, result.shaderHash).c_str());
+		}
+		ImGui::EndTable();
+	}
+}
+
+
+static void displayPipelineCreationProfiler()
+{
+	ImGui::PushTextWrapPos();
+	ImGui::TextUnformatted("Records which pipelines, with which shaders, are created in which frame, and how long the addon spends on them, to find the shaders whose creation causes stutters. The timeline can be exported as a trace to open in chrome://tracing or Perfetto.");
+	ImGui::PopTextWrapPos();
+	if(g_pipelineCreationProfiler.isRunning())
+	{
+		if(ImGui::Button("Stop"))
+		{
+			g_pipelineCreationProfiler.stop();
+		}
+	}
+	else if(ImGui::Button("Record pipeline creations"))
+	{
+		g_pipelineTraceStatusMessage = "";
+		g_pipelineCreationProfiler.start();
+	}
+	const PipelineCreationProfiler::Summary summary = g_pipelineCreationProfiler.getSummary();
+	if(summary.amountFrames == 0)
+	{
+		return;
+	}
+	ImGui::Text("%u frames, median frame time %.2f ms. %u pipelines created, the addon spent %.2f ms on them.", summary.amountFrames, summary.medianFrameTimeMs,
+				summary.amountPipelinesCreated, summary.addOnTimeMs);
+	ImGui::Text("%u frames took more than %.0fx the median, %u of which created pipelines. The addon spent %.2f ms in those, %.2f ms of which hashing.", summary.amountSpikes,
+				PipelineCreationProfiler::SPIKE_FACTOR, summary.amountSpikesWithPipelinesCreated, summary.addOnTimeInSpikesMs, summary.hashingTimeInSpikesMs);
+	if(ImGui::Button("Export trace"))
+	{
+		std::string errorMessage;
+		g_pipelineTraceStatusMessage = g_pipelineCreationProfiler.writeChromeTrace(g_pipelineTraceFileName, errorMessage) ? "Written to " + g_pipelineTraceFileName : errorMessage;
+	}
+	if(!g_pipelineTraceStatusMessage.empty())
+	{
+		ImGui::SameLine();
+		ImGui::TextUnformatted(g_pipelineTraceStatusMessage.c_str());
+	}
+}
+
+
+static void displayFrameTimeGovernor()
+{
+	ImGui::PushTextWrapPos();
+	ImGui::TextUnformatted("Switches performance groups on, highest priority first, while the frame time is over the budget, and off again when there's enough headroom. Mark a group as performance group in its edit section.");
+	ImGui::PopTextWrapPos();
+	if(ImGui::Checkbox("Keep the frame time within the budget", &g_frameTimeGovernorEnabled) && !g_frameTimeGovernorEnabled)
+	{
+		stopFrameTimeGovernor();
+	}
+	FrameTimeGovernor::Settings settings = g_frameTimeGovernor.getSettings();
+	float budgetMs = static_cast<float>(settings.budgetMs);
+	int percentile = static_cast<int>(settings.percentile * 100.0 + 0.5);
+	int windowFrames = static_cast<int>(settings.windowFrames);
+	ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.5f);
+	ImGui::SliderFloat("Frame time budget (ms)", &budgetMs, 4.0f, 50.0f, "%.1f");
+	ImGui::SliderInt("Frame time percentile", &percentile, 50, 99);
+	ImGui::SameLine();
+	showHelpMarker("The percentile of the frame times which has to stay within the budget. A higher percentile reacts to stutters more.");
+	ImGui::SliderInt("# of frames per decision", &windowFrames, 10, 300);
+	ImGui::SameLine();
+	showHelpMarker("The percentile is taken over this many frames, and after switching a group on or off, this many frames are measured before the next change.");
+	ImGui::PopItemWidth();
+	settings.budgetMs = budgetMs;
+	settings.percentile = percentile / 100.0;
+	settings.windowFrames = static_cast<uint32_t>(windowFrames);
+	g_frameTimeGovernor.setSettings(settings);
+	if(g_frameTimeGovernorEnabled)
+	{
+		ImGui::Text("Frame time percentile: %.2f ms. Groups switched on: %d", g_frameTimeGovernor.getFrameTimePercentileMs(), g_frameTimeGovernor.getAmountActivated());
+	}
+}
+
+
+/// <summary>
+/// Displays the measure button of a group and the result of its last measurement, if any.
+/// </summary>
+static void displayGroupPerformance(ToggleGroup& group)
+{
+	ImGui::SameLine();
+	if(g_groupPerformanceMeter.isRunning())
+	{
+		if(g_groupPerformanceMeter.getGroupId() == group.getId())
+		{
+			if(ImGui::Button("Stop"))
+			{
+				stopGroupPerformanceMeter();
+			}
+			ImGui::SameLine();
+			ImGui::Text("Measuring... %.0f%%", g_groupPerformanceMeter.getProgress() * 100.0f);
+			return;
+		}
+	}
+	const bool canMeasure = !g_groupPerformanceMeter.isRunning() && g_toggleGroupIdShaderEditing < 0 && !g_ablationProfiler.isRunning();
+	ImGui::BeginDisabled(!canMeasure);
+	if(ImGui::Button("Measure"))
+	{
+		g_groupPerformanceMeter.start(group.getId(), group.isActive(), GroupPerformanceMeter::Settings(), static_cast<uint32_t>(g_presentCounter));
+	}
+	ImGui::EndDisabled();
+	if(ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+	{
+		ImGui::SetTooltip("Switches the group on and off for a few hundred frames and measures the difference in frame time. Keep the camera still while it runs.");
+	}
+	const auto result = g_groupPerformanceResults.find(group.getId());
+	if(result != g_groupPerformanceResults.end())
+	{
+		const GroupPerformanceMeter::Result& measured = result->second;
+		ImGui::Text("    When active: mean %+.3f ms (+/- %.3f ms, %s), median %+.3f ms on a frame time of %.2f ms.", measured.meanDeltaMs,
+					measured.confidenceIntervalMs, measured.isSignificant ? "significant" : "not significant", measured.medianDeltaMs, measured.inactiveFrameTimeMs);
+	}
+}
+
+
 static void displaySettings(reshade::api::effect_runtime* runtime)
 {
 	if(g_toggleGroupIdKeyBindingEditing >= 0)
@@ -602,6 +1719,7 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 		ImGui::TextUnformatted("* Numpad 7 and Numpad 8: previous/next compute shader");
 		ImGui::TextUnformatted("* Ctrl + Numpad 7 and Ctrl + Numpad 8: previous/next marked compute shader in the group");
 		ImGui::TextUnformatted("* Numpad 9: mark/unmark the current compute shader as being part of the group");
+		ImGui::TextUnformatted("* Alt + Numpad 3, 6 or 9: start/stop bisecting the pixel, vertex or compute shaders. Half of the remaining shaders is hidden each step: press Numpad 1, 4 or 7 if the element you're looking for is gone, Numpad 2, 5 or 8 if it's still visible. When one shader is left it becomes the current shader, so you can mark it.");
 		ImGui::TextUnformatted("\nWhen you step through the shaders, the current shader is disabled in the 3D scene so you can see if that's the shader you were looking for.");
 		ImGui::TextUnformatted("When you're done, make sure you click 'Save all toggle groups' to preserve the groups you defined so next time you start your game they're loaded in and you can use them right away.");
 		ImGui::PopTextWrapPos();
@@ -617,15 +1735,83 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 		ImGui::SliderInt("# of frames to collect", &g_startValueFramecountCollectionPhase, 10, 1000);
 		ImGui::SameLine();
 		showHelpMarker("This is the number of frames the addon will collect active shaders. Set this to a high number if the shader you want to mark is only used occasionally. Only shaders that are used in the frames collected can be marked.");
+		ImGui::AlignTextToFramePadding();
+		ImGui::Checkbox("Stop collecting when no new shaders show up", &g_stopCollectingWhenConverged);
+		ImGui::SameLine();
+		showHelpMarker("If checked, collecting active shaders stops early once no new shader has been used for the number of frames below. The number of frames to collect above is then the maximum.");
+		if(g_stopCollectingWhenConverged)
+		{
+			ImGui::AlignTextToFramePadding();
+			ImGui::SliderInt("# of frames without new shaders", &g_framecountCollectionConvergence, 5, 500);
+			ImGui::SameLine();
+			showHelpMarker("Collecting active shaders stops after this many frames in a row in which no new shader was used. Raise it if the shader you want to mark is only used occasionally.");
+		}
+		ImGui::AlignTextToFramePadding();
+		bool trackShaderActivity = g_trackShaderActivity;
+		if(ImGui::Checkbox("Track shader activity in the background", &trackShaderActivity))
+		{
+			if(trackShaderActivity)
+			{
+				startTrackingShaderActivity();
+			}
+			else
+			{
+				g_trackShaderActivity = false;
+			}
+		}
+		ImGui::SameLine();
+		showHelpMarker("If checked, the addon keeps track of the last frame each shader was used in. Clicking 'Change shaders' then starts with the shaders used in the last number of frames below right away, without collecting active shaders first.");
+		if(g_trackShaderActivity)
+		{
+			ImGui::AlignTextToFramePadding();
+			ImGui::SliderInt("# of recent frames to hunt in", &g_framecountActivityWindow, 10, 1000);
+		}
 		ImGui::PopItemWidth();
 	}
 	ImGui::Separator();
 
+	if(ImGui::CollapsingHeader("Statistics"))
+	{
+		displayFilterStatistics();
+	}
+	ImGui::Separator();
+
+	if(ImGui::CollapsingHeader("Shader cost profiler"))
+	{
+		displayAblationProfiler();
+	}
+	ImGui::Separator();
+
+	if(ImGui::CollapsingHeader("Shader CPU cost profiler"))
+	{
+		displaySubmissionCostProfiler();
+	}
+	ImGui::Separator();
+
+	if(ImGui::CollapsingHeader("Pipeline creation profiler"))
+	{
+		displayPipelineCreationProfiler();
+	}
+	ImGui::Separator();
+
+	if(ImGui::CollapsingHeader("Frame time governor"))
+	{
+		displayFrameTimeGovernor();
+	}
+	ImGui::Separator();
+
 	if(ImGui::CollapsingHeader("List of Toggle Groups", ImGuiTreeNodeFlags_DefaultOpen))
 	{
+		displayProfileLoadStats();
+		if(!g_profileIsLive)
+		{
+			// groups created now would be replaced by the ones loaded.
+			return;
+		}
 		if(ImGui::Button(" New "))
 		{
 			addDefaultGroup();
+			requestAutoSave();
 		}
 		ImGui::Separator();
 
@@ -678,6 +1864,20 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 				ImGui::SameLine();
 				ImGui::Text(" (Active at startup)");
 			}
+			if(std::find(g_governorActivatedGroupIds.begin(), g_governorActivatedGroupIds.end(), group.getId()) != g_governorActivatedGroupIds.end())
+			{
+				ImGui::SameLine();
+				ImGui::Text(" (Switched on by the governor)");
+			}
+			if(group.isThrottleOverflowing())
+			{
+				ImGui::TextWrapped("More than %u throttled groups are active, so this group's throttle isn't applied and it draws everything.", DrawThrottleCounters::MAX_SLOTS);
+			}
+			if(!group.getLoadError().empty())
+			{
+				ImGui::TextWrapped("%s Saving writes the group without them.", group.getLoadError().c_str());
+			}
+			displayGroupPerformance(group);
 			if(group.isEditing())
 			{
 				ImGui::Separator();
@@ -691,8 +1891,11 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 				ImGui::AlignTextToFramePadding();
 				ImGui::Text("Name");
 				ImGui::SameLine(ImGui::GetWindowWidth() * 0.25f);
-				ImGui::InputText("##Name", tmpBuffer, 149);
-				group.setName(tmpBuffer);
+				if(ImGui::InputText("##Name", tmpBuffer, 149))
+				{
+					group.setName(tmpBuffer);
+					requestAutoSave();
+				}
 				ImGui::PopItemWidth();
 
 				// Key binding of group
@@ -728,8 +1931,58 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 				ImGui::Text(" ");
 				ImGui::SameLine(ImGui::GetWindowWidth() * 0.25f);
 				bool isDefaultActive = group.isActiveAtStartup();
-				ImGui::Checkbox("Is active at startup", &isDefaultActive);
-				group.setIsActiveAtStartup(isDefaultActive);
+				if(ImGui::Checkbox("Is active at startup", &isDefaultActive))
+				{
+					group.setIsActiveAtStartup(isDefaultActive);
+					requestAutoSave();
+				}
+				ImGui::Text(" ");
+				ImGui::SameLine(ImGui::GetWindowWidth() * 0.25f);
+				bool isPerformanceGroup = group.isPerformanceGroup();
+				if(ImGui::Checkbox("Is performance group", &isPerformanceGroup))
+				{
+					group.setIsPerformanceGroup(isPerformanceGroup);
+					requestAutoSave();
+				}
+				ImGui::SameLine();
+				showHelpMarker("If checked, the frame time governor may switch this group on when the frame time is over budget. Groups with a higher priority are switched on first.");
+				if(group.isPerformanceGroup())
+				{
+					ImGui::AlignTextToFramePadding();
+					ImGui::Text("Priority");
+					ImGui::SameLine(ImGui::GetWindowWidth() * 0.25f);
+					int performancePriority = group.getPerformancePriority();
+					if(ImGui::InputInt("##Priority", &performancePriority))
+					{
+						group.setPerformancePriority(performancePriority);
+						requestAutoSave();
+					}
+				}
+
+				// Throttle of group
+				static const char* throttleModeNames[] = { "Hide all draws", "Keep every n-th draw", "Keep the first n draws per frame", "Keep n percent of the instances" };
+				ImGui::AlignTextToFramePadding();
+				ImGui::Text("When active");
+				ImGui::SameLine(ImGui::GetWindowWidth() * 0.25f);
+				int throttleMode = static_cast<int>(group.getThrottleMode());
+				int throttleValue = static_cast<int>(group.getThrottleValue());
+				bool throttleChanged = ImGui::Combo("##Throttle", &throttleMode, throttleModeNames, IM_ARRAYSIZE(throttleModeNames));
+				ImGui::SameLine();
+				showHelpMarker("Instead of hiding all draws with the group's shaders, only a part of them can be hidden, e.g. for particles, grass or decals. Draws are counted per command list, per frame. For instanced draws, e.g. foliage or crowds, the draws can be kept with only a part of their instances instead.");
+				if(throttleMode != static_cast<int>(DrawThrottleMode::HideAll))
+				{
+					ImGui::AlignTextToFramePadding();
+					ImGui::Text("n");
+					ImGui::SameLine(ImGui::GetWindowWidth() * 0.25f);
+					throttleChanged |= ImGui::InputInt("##ThrottleValue", &throttleValue);
+				}
+				if(throttleChanged)
+				{
+					// setThrottle clamps the value to the mode's range, it only has to be kept from going negative here.
+					group.setThrottle(static_cast<DrawThrottleMode>(throttleMode), static_cast<uint32_t>(std::max(throttleValue, 1)));
+					g_activeGroupsFilterIsDirty = true;
+					requestAutoSave();
+				}
 				ImGui::PopItemWidth();
 
 				if(!isKeyEditing)
@@ -754,11 +2007,17 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 			g_toggleGroupIdShaderEditing = -1;
 			g_pixelShaderManager.stopHuntingMode();
 			g_vertexShaderManager.stopHuntingMode();
+			selectBlockDrawCallKernel();
 		}
 		for(const auto& group : toRemove)
 		{
 			std::erase(g_toggleGroups, group);
 		}
+		if(toRemove.size() > 0)
+		{
+			g_activeGroupsFilterIsDirty = true;
+			requestAutoSave();
+		}
 
 		ImGui::Separator();
 		if(g_toggleGroups.size() > 0)
@@ -767,7 +2026,16 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 			{
 				saveShaderTogglerIniFile();
 			}
+			ImGui::SameLine();
+			displaySaveStatus();
+		}
+		if(ImGui::Checkbox("Save automatically", &g_autoSave))
+		{
+			// the setting itself is stored in the profile, so it's saved regardless of its new value.
+			saveShaderTogglerIniFile();
 		}
+		ImGui::SameLine();
+		showHelpMarker("If checked, the toggle groups are saved automatically a few seconds after you've changed a group.");
 	}
 }
 
@@ -790,6 +2058,10 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 			const std::filesystem::path basePath = dllPath.parent_path();																// <installpath>
 			const std::string& hashFileName = HASH_FILE_NAME;
 			g_iniFileName = (basePath / hashFileName).string();																			// <installpath>/shadertoggler.ini
+			g_compiledProfileFileName = (basePath / COMPILED_PROFILE_FILE_NAME).string();												// <installpath>/shadertoggler.bin
+			g_shaderCostFileName = (basePath / SHADER_COST_FILE_NAME).string();															// <installpath>/shadertogglershadercost.csv
+			g_pipelineTraceFileName = (basePath / PIPELINE_TRACE_FILE_NAME).string();													// <installpath>/shadertogglerpipelinetrace.json
+			g_profileSaver.setFileNames(g_iniFileName, g_compiledProfileFileName);
 			reshade::register_event<reshade::addon_event::init_pipeline>(onInitPipeline);
 			reshade::register_event<reshade::addon_event::init_command_list>(onInitCommandList);
 			reshade::register_event<reshade::addon_event::destroy_command_list>(onDestroyCommandList);
@@ -797,16 +2069,19 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 			reshade::register_event<reshade::addon_event::destroy_pipeline>(onDestroyPipeline);
 			reshade::register_event<reshade::addon_event::reshade_overlay>(onReshadeOverlay);
 			reshade::register_event<reshade::addon_event::reshade_present>(onReshadePresent);
+			reshade::register_event<reshade::addon_event::init_effect_runtime>(onInitEffectRuntime);
+			reshade::register_event<reshade::addon_event::destroy_effect_runtime>(onDestroyEffectRuntime);
 			reshade::register_event<reshade::addon_event::bind_pipeline>(onBindPipeline);
 			reshade::register_event<reshade::addon_event::draw>(onDraw);
 			reshade::register_event<reshade::addon_event::draw_indexed>(onDrawIndexed);
 			reshade::register_event<reshade::addon_event::draw_or_dispatch_indirect>(onDrawOrDispatchIndirect);
 			reshade::register_overlay(nullptr, &displaySettings);
-			loadShaderTogglerIniFile();
 		}
 		break;
 	case DLL_PROCESS_DETACH:
 		reshade::unregister_event<reshade::addon_event::reshade_present>(onReshadePresent);
+		reshade::unregister_event<reshade::addon_event::init_effect_runtime>(onInitEffectRuntime);
+		reshade::unregister_event<reshade::addon_event::destroy_effect_runtime>(onDestroyEffectRuntime);
 		reshade::unregister_event<reshade::addon_event::destroy_pipeline>(onDestroyPipeline);
 		reshade::unregister_event<reshade::addon_event::init_pipeline>(onInitPipeline);
 		reshade::unregister_event<reshade::addon_event::reshade_overlay>(onReshadeOverlay);
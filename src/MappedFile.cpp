@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ShaderToggler
+{
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+
+	bool MappedFile::open(const std::string& fileName)
+	{
+		close();
+#ifdef _WIN32
+		// the file may be replaced or deleted while it's mapped, which leaves the mapped bytes as they are, but not written to: that would change
+		// the bytes under the reader. A writer which got in first makes the open fail with a sharing violation, which is retried for a moment.
+		for(int attempt = 0; attempt < OPEN_ATTEMPTS; attempt++)
+		{
+			_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if(_file != INVALID_HANDLE_VALUE || GetLastError() != ERROR_SHARING_VIOLATION)
+			{
+				break;
+			}
+			Sleep(OPEN_RETRY_INTERVAL_MS);
+		}
+		if(_file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		if(!GetFileSizeEx(_file, &fileSize))
+		{
+			close();
+			return false;
+		}
+		_size = static_cast<size_t>(fileSize.QuadPart);
+		if(_size == 0)
+		{
+			// an empty file can't be mapped, but it's a valid (empty) file.
+			return true;
+		}
+		_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(nullptr == _mapping)
+		{
+			close();
+			return false;
+		}
+		_data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+		_file = ::open(fileName.c_str(), O_RDONLY);
+		if(_file < 0)
+		{
+			return false;
+		}
+		struct stat fileStat;
+		if(fstat(_file, &fileStat) != 0)
+		{
+			close();
+			return false;
+		}
+		_size = static_cast<size_t>(fileStat.st_size);
+		if(_size == 0)
+		{
+			return true;
+		}
+		void* view = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+		_data = (view == MAP_FAILED) ? nullptr : static_cast<const char*>(view);
+#endif
+		if(nullptr == _data)
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+
+
+	void MappedFile::close()
+	{
+#ifdef _WIN32
+		if(nullptr != _data)
+		{
+			UnmapViewOfFile(_data);
+		}
+		if(nullptr != _mapping)
+		{
+			CloseHandle(_mapping);
+		}
+		if(_file != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(_file);
+		}
+		_mapping = nullptr;
+		_file = INVALID_HANDLE_VALUE;
+#else
+		if(nullptr != _data)
+		{
+			munmap(const_cast<char*>(_data), _size);
+		}
+		if(_file >= 0)
+		{
+			::close(_file);
+		}
+		_file = -1;
+#endif
+		_data = nullptr;
+		_size = 0;
+	}
+}
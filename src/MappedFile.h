@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Read-only memory mapping of a whole file. The file is unmapped and closed when the instance is destroyed. An empty file can't be mapped,
+	/// but is opened successfully with an empty view. Only for files which are replaced as a whole (written to a temporary file which is then
+	/// renamed over them), never rewritten in place: the mapped bytes would change under the reader, and on POSIX reading a mapped file which
+	/// was truncated raises SIGBUS. On Windows, writers are kept out while the file is mapped.
+	/// </summary>
+	class MappedFile
+	{
+	public:
+		static constexpr int OPEN_ATTEMPTS = 10;				// attempts to open a file a writer has open, before giving up.
+		static constexpr int OPEN_RETRY_INTERVAL_MS = 20;
+
+		MappedFile() = default;
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/// <summary>
+		/// Opens and maps the file specified. Any previously mapped file is closed first.
+		/// </summary>
+		/// <param name="fileName"></param>
+		/// <returns>true if the file was opened and mapped, false otherwise</returns>
+		bool open(const std::string& fileName);
+		void close();
+
+		const char* getData() const { return _data; }
+		size_t getSize() const { return _size; }
+		std::string_view getContents() const { return nullptr == _data ? std::string_view() : std::string_view(_data, _size); }
+
+	private:
+#ifdef _WIN32
+		HANDLE _file = INVALID_HANDLE_VALUE;
+		HANDLE _mapping = nullptr;
+#else
+		int _file = -1;
+#endif
+		const char* _data = nullptr;
+		size_t _size = 0;
+	};
+}
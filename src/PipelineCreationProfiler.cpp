@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "PipelineCreationProfiler.h"
+
+#include <fstream>
+#include <unordered_map>
+
+namespace ShaderToggler
+{
+	static double toMilliseconds(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+
+
+	void PipelineCreationProfiler::start()
+	{
+		std::lock_guard lock(_eventsMutex);
+		_pipelineCreations.clear();
+		_frames.clear();
+		_startTime = std::chrono::steady_clock::now();
+		_hasLastPresentTime = false;
+		_summary = Summary();
+		_addOnAndHashingTimePerPendingFrame.clear();
+		_lowerFrameTimes = {};
+		_upperFrameTimes = {};
+		_isRunning = true;
+	}
+
+
+	void PipelineCreationProfiler::stop()
+	{
+		_isRunning = false;
+	}
+
+
+	void PipelineCreationProfiler::onPipelineCreated(const PipelineCreation& creation)
+	{
+		if(!isRunning())
+		{
+			return;
+		}
+		std::lock_guard lock(_eventsMutex);
+		if(_pipelineCreations.size() + _frames.size() < MAX_EVENTS)
+		{
+			_pipelineCreations.push_back(creation);
+			const double addOnTimeMs = toMilliseconds(creation.endTime - creation.startTime);
+			_summary.amountPipelinesCreated++;
+			_summary.addOnTimeMs += addOnTimeMs;
+			auto& times = _addOnAndHashingTimePerPendingFrame[creation.frame];
+			times.first += addOnTimeMs;
+			times.second += toMilliseconds(creation.hashingTime);
+		}
+	}
+
+
+	void PipelineCreationProfiler::onFramePresented(uint32_t frame, std::chrono::steady_clock::time_point presentTime)
+	{
+		if(!isRunning())
+		{
+			return;
+		}
+		std::lock_guard lock(_eventsMutex);
+		if(_hasLastPresentTime && _pipelineCreations.size() + _frames.size() < MAX_EVENTS)
+		{
+			Frame presented = { frame, _lastPresentTime, presentTime };
+			const double frameTimeMs = toMilliseconds(presentTime - _lastPresentTime);
+			addFrameTime(frameTimeMs);
+			_summary.amountFrames++;
+			_summary.medianFrameTimeMs = _upperFrameTimes.top();
+			presented.isSpike = frameTimeMs > _summary.medianFrameTimeMs * SPIKE_FACTOR;
+			if(presented.isSpike)
+			{
+				_summary.amountSpikes++;
+				const auto times = _addOnAndHashingTimePerPendingFrame.find(frame);
+				if(times != _addOnAndHashingTimePerPendingFrame.end())
+				{
+					_summary.amountSpikesWithPipelinesCreated++;
+					_summary.addOnTimeInSpikesMs += times->second.first;
+					_summary.hashingTimeInSpikesMs += times->second.second;
+				}
+			}
+			_frames.push_back(presented);
+		}
+		// the frame is done, as are the ones before it. The first frame has no present recorded, so isn't in the summary.
+		_addOnAndHashingTimePerPendingFrame.erase(_addOnAndHashingTimePerPendingFrame.begin(), _addOnAndHashingTimePerPendingFrame.upper_bound(frame));
+		_lastPresentTime = presentTime;
+		_hasLastPresentTime = true;
+	}
+
+
+	PipelineCreationProfiler::Summary PipelineCreationProfiler::getSummary() const
+	{
+		std::lock_guard lock(_eventsMutex);
+		return _summary;
+	}
+
+
+	bool PipelineCreationProfiler::writeChromeTrace(const std::string& fileName, std::string& errorMessage) const
+	{
+		std::vector<PipelineCreation> pipelineCreations;
+		std::vector<Frame> frames;
+		std::chrono::steady_clock::time_point startTime;
+		{
+			std::lock_guard lock(_eventsMutex);
+			pipelineCreations = _pipelineCreations;
+			frames = _frames;
+			startTime = _startTime;
+		}
+		std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+		if(!file.is_open())
+		{
+			errorMessage = "Couldn't open " + fileName;
+			return false;
+		}
+		std::unordered_map<uint32_t, uint32_t> pipelinesCreatedPerFrame;
+		for(const auto& creation : pipelineCreations)
+		{
+			pipelinesCreatedPerFrame[creation.frame]++;
+		}
+		auto toMicroseconds = [startTime](std::chrono::steady_clock::time_point time) { return std::chrono::duration<double, std::micro>(time - startTime).count(); };
+
+		// complete ('X') events: the frames on the present thread's track, the pipeline creations on the track of the thread they were
+		// created on, with the hashing as a nested event.
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Frames\"}}";
+		char line[512];
+		for(const auto& frame : frames)
+		{
+			const auto pipelinesCreated = pipelinesCreatedPerFrame.find(frame.frame);
+			const uint32_t amountPipelinesCreated = pipelinesCreated == pipelinesCreatedPerFrame.end() ? 0 : pipelinesCreated->second;
+			const double frameTimeMs = toMilliseconds(frame.endTime - frame.startTime);
+			snprintf(line, sizeof(line), ",\n{\"name\":\"Frame %u%s\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,"
+					 "\"args\":{\"frame\":%u,\"frameTimeMs\":%.3f,\"pipelinesCreated\":%u,\"isSpike\":%s}}", frame.frame, frame.isSpike ? " (spike)" : "",
+					 toMicroseconds(frame.startTime), toMicroseconds(frame.endTime) - toMicroseconds(frame.startTime), frame.frame, frameTimeMs, amountPipelinesCreated,
+					 frame.isSpike ? "true" : "false");
+			file << line;
+		}
+		for(const auto& creation : pipelineCreations)
+		{
+			const double startUs = toMicroseconds(creation.startTime);
+			snprintf(line, sizeof(line), ",\n{\"name\":\"init_pipeline\",\"cat\":\"pipeline\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+					 "\"args\":{\"frame\":%u,\"vertexShader\":\"%08X\",\"pixelShader\":\"%08X\",\"computeShader\":\"%08X\",\"bytesHashed\":%llu}}", creation.threadId, startUs,
+					 toMicroseconds(creation.endTime) - startUs, creation.frame, creation.shaderHashes[VertexShaderStage], creation.shaderHashes[PixelShaderStage],
+					 creation.shaderHashes[ComputeShaderStage], static_cast<unsigned long long>(creation.bytesHashed));
+			file << line;
+			// the hashing is spread over the event; it's shown as one block at its start, so the share is visible.
+			snprintf(line, sizeof(line), ",\n{\"name\":\"hash shaders\",\"cat\":\"pipeline\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", creation.threadId,
+					 startUs, std::chrono::duration<double, std::micro>(creation.hashingTime).count());
+			file << line;
+		}
+		file << "\n]}\n";
+		file.close();
+		if(file.fail())
+		{
+			errorMessage = "Couldn't write " + fileName;
+			return false;
+		}
+		return true;
+	}
+
+
+	void PipelineCreationProfiler::addFrameTime(double frameTimeMs)
+	{
+		// keeps the upper heap holding the larger half, so its top is the same median as Statistics' median(): the element at index n / 2.
+		if(_upperFrameTimes.empty() || frameTimeMs >= _upperFrameTimes.top())
+		{
+			_upperFrameTimes.push(frameTimeMs);
+		}
+		else
+		{
+			_lowerFrameTimes.push(frameTimeMs);
+		}
+		if(_lowerFrameTimes.size() > _upperFrameTimes.size())
+		{
+			_upperFrameTimes.push(_lowerFrameTimes.top());
+			_lowerFrameTimes.pop();
+		}
+		else if(_upperFrameTimes.size() > _lowerFrameTimes.size() + 1)
+		{
+			_lowerFrameTimes.push(_upperFrameTimes.top());
+			_upperFrameTimes.pop();
+		}
+	}
+}
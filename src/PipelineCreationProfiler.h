@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Records a timeline of the pipelines created per frame, to find out which shaders are created when the frame time spikes. Every
+	/// init_pipeline event is stored with its time, the frame it happened in, the shader hashes involved, the bytes hashed and how long the
+	/// add-on spent in the event and hashing. Every present is stored with its present to present time. The timeline is exported as Chrome
+	/// trace event JSON, which can be opened in chrome://tracing or Perfetto. The pipeline events can come from any thread.
+	/// The summary is kept up to date as the events come in, so reading it each frame is cheap. A frame is a spike if it took longer than
+	/// SPIKE_FACTOR times the median of the frame times recorded up to and including it.
+	/// </summary>
+	class PipelineCreationProfiler
+	{
+	public:
+		static constexpr uint32_t MAX_EVENTS = 200000;		// events beyond this are dropped, to bound the memory used.
+		static constexpr double SPIKE_FACTOR = 2.0;			// a frame is a spike if it takes this many times the median frame time.
+
+		enum ShaderStage : uint32_t
+		{
+			VertexShaderStage = 0,
+			PixelShaderStage,
+			ComputeShaderStage,
+			ShaderStageCount
+		};
+
+		struct PipelineCreation
+		{
+			std::chrono::steady_clock::time_point startTime;
+			std::chrono::steady_clock::time_point endTime;
+			std::chrono::steady_clock::duration hashingTime = std::chrono::steady_clock::duration::zero();
+			std::array<uint32_t, ShaderStageCount> shaderHashes = {};	// 0 for stages without a shader
+			uint64_t bytesHashed = 0;
+			uint32_t frame = 0;
+			uint32_t threadId = 0;
+		};
+
+		struct Summary
+		{
+			uint32_t amountFrames = 0;
+			uint32_t amountPipelinesCreated = 0;
+			uint32_t amountSpikes = 0;
+			uint32_t amountSpikesWithPipelinesCreated = 0;
+			double medianFrameTimeMs = 0.0;
+			double addOnTimeMs = 0.0;				// time spent in the init_pipeline events, in total
+			double addOnTimeInSpikesMs = 0.0;		// of which in frames which are spikes
+			double hashingTimeInSpikesMs = 0.0;		// of which hashing
+		};
+
+		/// <summary>
+		/// Starts recording. The timeline of a previous run is discarded.
+		/// </summary>
+		void start();
+		void stop();
+		bool isRunning() const { return _isRunning.load(std::memory_order_relaxed); }
+		/// <summary>
+		/// Records a pipeline creation. Called from the init_pipeline hook, on any thread.
+		/// </summary>
+		void onPipelineCreated(const PipelineCreation& creation);
+		/// <summary>
+		/// Records the end of the frame specified. Called at every present.
+		/// </summary>
+		void onFramePresented(uint32_t frame, std::chrono::steady_clock::time_point presentTime);
+
+		/// <summary>
+		/// Returns the counts and times over the timeline recorded so far. Only copies the summary, which is updated as the events come in.
+		/// </summary>
+		Summary getSummary() const;
+		/// <summary>
+		/// Writes the timeline recorded so far as Chrome trace event JSON to the file specified. The timeline is copied first, so the file
+		/// is written without blocking the threads recording events.
+		/// </summary>
+		bool writeChromeTrace(const std::string& fileName, std::string& errorMessage) const;
+
+	private:
+		struct Frame
+		{
+			uint32_t frame = 0;
+			std::chrono::steady_clock::time_point startTime;
+			std::chrono::steady_clock::time_point endTime;
+			bool isSpike = false;
+		};
+
+		void addFrameTime(double frameTimeMs);
+
+		std::atomic_bool _isRunning = false;
+		mutable std::mutex _eventsMutex;
+		std::vector<PipelineCreation> _pipelineCreations;
+		std::vector<Frame> _frames;
+		std::chrono::steady_clock::time_point _startTime;
+		std::chrono::steady_clock::time_point _lastPresentTime;
+		bool _hasLastPresentTime = false;
+		Summary _summary;
+		// the add-on and hashing time in ms per frame number, of the frames which haven't been presented yet.
+		std::map<uint32_t, std::pair<double, double>> _addOnAndHashingTimePerPendingFrame;
+		// the frame times recorded, split at the median: the lower half in a max heap, the upper half, which is the larger one, in a min heap.
+		std::priority_queue<double> _lowerFrameTimes;
+		std::priority_queue<double, std::vector<double>, std::greater<double>> _upperFrameTimes;
+	};
+}
@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "ProfileHotReloader.h"
+
+#include <algorithm>
+
+#include "ProfileLoader.h"
+
+namespace ShaderToggler
+{
+	ProfileHotReloader::ProfileHotReloader(): _state(std::make_shared<SharedState>())
+	{
+	}
+
+
+	ProfileHotReloader::~ProfileHotReloader()
+	{
+		{
+			std::unique_lock lock(_state->mutex);
+			_state->stopRequested = true;
+		}
+		_state->wakeUp.notify_all();
+		if(_watchThread.joinable())
+		{
+			// stopWatching() wasn't called. Not joined, see ProfileSaver's destructor.
+			_watchThread.detach();
+		}
+	}
+
+
+	void ProfileHotReloader::startWatching(const std::string& iniFileName, std::unique_ptr<FileChangeWatcher> watcher, std::chrono::milliseconds pollInterval)
+	{
+		if(_watchThread.joinable())
+		{
+			return;
+		}
+		_watchThread = std::thread(watchLoop, _state, iniFileName, std::move(watcher), pollInterval);
+	}
+
+
+	void ProfileHotReloader::stopWatching()
+	{
+		{
+			std::unique_lock lock(_state->mutex);
+			_state->stopRequested = true;
+		}
+		_state->wakeUp.notify_all();
+		if(_watchThread.joinable())
+		{
+			_watchThread.join();
+		}
+		std::unique_lock lock(_state->mutex);
+		_state->stopRequested = false;
+	}
+
+
+	std::unique_ptr<ProfileHotReloader::ReloadedProfile> ProfileHotReloader::takeReloadedProfile()
+	{
+		std::unique_lock lock(_state->mutex);
+		return std::move(_state->reloadedProfile);
+	}
+
+
+	void ProfileHotReloader::watchLoop(std::shared_ptr<SharedState> state, std::string iniFileName, std::unique_ptr<FileChangeWatcher> watcher, std::chrono::milliseconds pollInterval)
+	{
+		std::unique_lock lock(state->mutex);
+		while(!state->stopRequested)
+		{
+			state->wakeUp.wait_for(lock, pollInterval);
+			if(state->stopRequested)
+			{
+				break;
+			}
+			lock.unlock();
+
+			FileStamp newStamp;
+			std::unique_ptr<ReloadedProfile> reloadedProfile;
+			if(watcher->checkForChange(newStamp))
+			{
+				reloadedProfile = std::make_unique<ReloadedProfile>();
+				reloadedProfile->stamp = newStamp;
+				if(!ProfileLoader::loadIniFile(iniFileName, reloadedProfile->profile))
+				{
+					reloadedProfile.reset();
+				}
+			}
+
+			lock.lock();
+			if(nullptr != reloadedProfile)
+			{
+				// a profile which hasn't been picked up yet is outdated now.
+				state->reloadedProfile = std::move(reloadedProfile);
+			}
+		}
+	}
+
+
+	ProfileHotReloader::ChangeSummary ProfileHotReloader::applyProfileChanges(std::vector<ToggleGroup>& liveGroups, std::vector<ToggleGroup>&& reloadedGroups)
+	{
+		ChangeSummary toReturn;
+		std::vector<bool> isMatched(liveGroups.size(), false);
+		std::vector<ToggleGroup> mergedGroups;
+		mergedGroups.reserve(reloadedGroups.size());
+		for(auto& reloadedGroup : reloadedGroups)
+		{
+			// the first live group with this name which isn't matched yet, so groups sharing a name are matched by their position among them.
+			size_t liveIndex = 0;
+			while(liveIndex < liveGroups.size() && (isMatched[liveIndex] || liveGroups[liveIndex].getName() != reloadedGroup.getName()))
+			{
+				liveIndex++;
+			}
+			if(liveIndex == liveGroups.size())
+			{
+				mergedGroups.push_back(std::move(reloadedGroup));
+				toReturn.groupsAdded++;
+				continue;
+			}
+			isMatched[liveIndex] = true;
+			ToggleGroup& liveGroup = liveGroups[liveIndex];
+			if(!liveGroup.hasSameDefinition(reloadedGroup))
+			{
+				liveGroup.applyDefinition(std::move(reloadedGroup));
+				toReturn.groupsChanged++;
+			}
+			mergedGroups.push_back(std::move(liveGroup));
+		}
+		toReturn.groupsRemoved = static_cast<int>(std::count(isMatched.begin(), isMatched.end(), false));
+		liveGroups = std::move(mergedGroups);
+		return toReturn;
+	}
+}
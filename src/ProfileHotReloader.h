@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FileChangeWatcher.h"
+#include "ProfileSaver.h"
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Watches the ini file for changes made outside the addon and re-parses it on a background thread. The result is picked up on the render
+	/// thread with takeReloadedProfile and merged into the live groups with applyProfileChanges, which only touches the groups that changed.
+	/// </summary>
+	class ProfileHotReloader
+	{
+	public:
+		/// <summary>
+		/// A re-parsed ini file, together with the stamp of the file it was read from.
+		/// </summary>
+		struct ReloadedProfile
+		{
+			ProfileSnapshot profile;
+			FileStamp stamp;
+		};
+
+		/// <summary>
+		/// The result of applyProfileChanges, for reporting.
+		/// </summary>
+		struct ChangeSummary
+		{
+			int groupsChanged = 0;
+			int groupsAdded = 0;
+			int groupsRemoved = 0;
+		};
+
+		ProfileHotReloader();
+		~ProfileHotReloader();
+
+		/// <summary>
+		/// Starts watching the ini file specified with the watcher specified. Changes are checked for every pollInterval.
+		/// </summary>
+		void startWatching(const std::string& iniFileName, std::unique_ptr<FileChangeWatcher> watcher, std::chrono::milliseconds pollInterval);
+		/// <summary>
+		/// Stops and joins the watch thread. Call this when the effect runtime goes away, not from DllMain. Watching can be started again after.
+		/// </summary>
+		void stopWatching();
+		bool isWatching() const { return _watchThread.joinable(); }
+		/// <summary>
+		/// Returns the most recently re-parsed profile if the ini file has changed since the last call, nullptr otherwise.
+		/// </summary>
+		std::unique_ptr<ReloadedProfile> takeReloadedProfile();
+
+		/// <summary>
+		/// Merges the groups of the reloaded profile into the live groups specified. Groups are matched by name, so groups which were moved
+		/// around in the file keep their state; groups sharing a name are matched in the order they appear. Groups which are unchanged aren't
+		/// touched at all. Changed groups get the new definition but keep their id and whether they're currently toggled on. Groups without a
+		/// match are added, live groups not in the file anymore are removed. Afterwards the live groups are in the order of the file.
+		/// </summary>
+		static ChangeSummary applyProfileChanges(std::vector<ToggleGroup>& liveGroups, std::vector<ToggleGroup>&& reloadedGroups);
+
+	private:
+		struct SharedState
+		{
+			std::mutex mutex;
+			std::condition_variable wakeUp;
+			std::unique_ptr<ReloadedProfile> reloadedProfile;
+			bool stopRequested = false;
+		};
+
+		static void watchLoop(std::shared_ptr<SharedState> state, std::string iniFileName, std::unique_ptr<FileChangeWatcher> watcher, std::chrono::milliseconds pollInterval);
+
+		std::shared_ptr<SharedState> _state;
+		std::thread _watchThread;
+	};
+}
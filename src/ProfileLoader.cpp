@@ -0,0 +1,208 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "ProfileLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <thread>
+
+#include "CDataFile.h"
+#include "CompiledProfile.h"
+
+namespace ShaderToggler
+{
+	ProfileLoader::ProfileLoader(): _state(std::make_shared<SharedState>())
+	{
+	}
+
+
+	ProfileLoader::~ProfileLoader()
+	{
+		if(_loadThread.joinable())
+		{
+			// stop() wasn't called. Not joined, see ProfileSaver's destructor.
+			_loadThread.detach();
+		}
+	}
+
+
+	void ProfileLoader::startLoading(const std::string& iniFileName, const std::string& compiledProfileFileName)
+	{
+		if(_loadStarted)
+		{
+			return;
+		}
+		_loadStarted = true;
+		_loadThread = std::thread(loadWorker, _state, iniFileName, compiledProfileFileName);
+	}
+
+
+	void ProfileLoader::stop()
+	{
+		if(_loadThread.joinable())
+		{
+			_loadThread.join();
+		}
+	}
+
+
+	std::unique_ptr<ProfileSnapshot> ProfileLoader::takeLoadedProfile()
+	{
+		if(!_state->isLoaded.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+		// the worker is done once isLoaded is set, so this doesn't wait for more than the thread's exit.
+		stop();
+		return std::unique_ptr<ProfileSnapshot>(_state->loadedProfile.exchange(nullptr, std::memory_order_acq_rel));
+	}
+
+
+	void ProfileLoader::loadWorker(std::shared_ptr<SharedState> state, std::string iniFileName, std::string compiledProfileFileName)
+	{
+		const auto startTime = std::chrono::steady_clock::now();
+		auto loadedProfile = std::make_unique<ProfileSnapshot>();
+		loadProfile(iniFileName, compiledProfileFileName, *loadedProfile);
+		state->loadTimeInMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		state->loadedProfile.store(loadedProfile.release(), std::memory_order_release);
+		state->isLoaded.store(true, std::memory_order_release);
+	}
+
+
+	bool ProfileLoader::loadProfile(const std::string& iniFileName, const std::string& compiledProfileFileName, ProfileSnapshot& toFill)
+	{
+		// If the compiled profile was compiled from the ini file as it is now, the groups are read from that, which doesn't need any parsing. The
+		// stamp is read before parsing, so if the ini file changes halfway, the compiled profile doesn't match it and is regenerated next time.
+		const FileStamp iniFileStamp = FileStamp::read(iniFileName);
+		{
+			CompiledProfile compiledProfile;
+			if(compiledProfile.open(compiledProfileFileName) && compiledProfile.isCompiledFrom(iniFileStamp))
+			{
+				loadFromCompiledProfile(compiledProfile, toFill);
+				return true;
+			}
+		}
+		if(!loadIniFile(iniFileName, toFill))
+		{
+			return false;
+		}
+		if(!toFill.loadError.empty() || std::any_of(toFill.groups.begin(), toFill.groups.end(), [](const ToggleGroup& group) { return !group.getLoadError().empty(); }))
+		{
+			// what couldn't be read would be missing from the compiled profile as well, which would then be used instead of the fixed ini file.
+			return true;
+		}
+
+		// the compiled profile is missing or outdated, regenerate it so the next start can use it.
+		std::string errorMessage;
+		ProfileSaver::writeCompiledProfile(toFill, iniFileStamp, compiledProfileFileName, errorMessage);
+		return true;
+	}
+
+
+	void ProfileLoader::loadFromCompiledProfile(const CompiledProfile& compiledProfile, ProfileSnapshot& toFill)
+	{
+		toFill.deltaEncodeHashLists = (compiledProfile.getFlags() & CompiledProfile::FLAG_DELTA_ENCODE_HASHES) != 0;
+		toFill.autoSave = (compiledProfile.getFlags() & CompiledProfile::FLAG_AUTO_SAVE) != 0;
+		toFill.groups.reserve(compiledProfile.getGroupCount());
+		for(uint32_t i = 0; i < compiledProfile.getGroupCount(); i++)
+		{
+			ToggleGroup toAdd("", ToggleGroup::getNewGroupId());
+			toAdd.loadState(compiledProfile, i);
+			toFill.groups.push_back(toAdd);
+		}
+	}
+
+
+	bool ProfileLoader::loadIniFile(const std::string& iniFileName, ProfileSnapshot& toFill)
+	{
+		CDataFile iniFile;
+		if(!iniFile.Load(iniFileName))
+		{
+			// not there
+			return false;
+		}
+		const int formatVersion = iniFile.GetInt("FormatVersion", "General");
+		if(formatVersion != INT_MIN && formatVersion > ProfileSaver::INI_FORMAT_VERSION)
+		{
+			toFill.loadError = "The ini file has format version " + std::to_string(formatVersion) + ", this version of the addon can only read up to version " + 
+							   std::to_string(ProfileSaver::INI_FORMAT_VERSION) + ".";
+			return true;
+		}
+		int groupCounter = 0;
+		const int numberOfGroups = iniFile.GetInt("AmountGroups", "General");
+		if(numberOfGroups==INT_MIN && (iniFile.HasSection("PixelShaders") || iniFile.HasSection("VertexShaders")))
+		{
+			// old format file? Has just one group with the shaders, which is toggled with caps lock.
+			ToggleGroup toAdd("Default", ToggleGroup::getNewGroupId());
+			toAdd.setToggleKey(VK_CAPITAL, false, false, false);
+			toFill.groups.push_back(toAdd);
+			groupCounter=-1;	// enforce old format read for pre 1.0 ini file.
+		}
+		else
+		{
+			// a file which is still being written, or was cut short, is refused rather than read as a profile with fewer (or no) groups. Each
+			// group's own section is written after its hash lists, so the last group's section is the last thing to show up.
+			if(numberOfGroups < 0)
+			{
+				toFill.loadError = "The ini file has no valid AmountGroups in [General], it's possibly incomplete.";
+				return true;
+			}
+			int amountGroupSections = 0;
+			while(iniFile.HasSection("Group" + std::to_string(amountGroupSections)))
+			{
+				amountGroupSections++;
+			}
+			if(numberOfGroups != amountGroupSections)
+			{
+				toFill.loadError = "The ini file has AmountGroups=" + std::to_string(numberOfGroups) + " but " + std::to_string(amountGroupSections) + 
+								   " group sections, it's possibly incomplete.";
+				return true;
+			}
+			toFill.deltaEncodeHashLists = iniFile.GetBool("DeltaEncodeHashes", "General");
+			toFill.autoSave = iniFile.GetBool("AutoSave", "General");
+			for(int i=0;i<numberOfGroups;i++)
+			{
+				toFill.groups.push_back(ToggleGroup("", ToggleGroup::getNewGroupId()));
+			}
+		}
+		for(auto& group: toFill.groups)
+		{
+			group.loadState(iniFile, groupCounter);		// groupCounter is normally 0 or greater. For when the old format is detected, it's -1 (and there's 1 group).
+			groupCounter++;
+		}
+		return true;
+	}
+}
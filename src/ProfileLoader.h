@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "ProfileSaver.h"
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Loads the profile (the compiled profile if it's up to date, otherwise the ini file) on a background thread, so the file I/O and parsing
+	/// don't delay the first frame. The thread is started when the first effect runtime is created rather than from DllMain, where threads
+	/// can't be started nor joined safely. The loaded profile is published once it's complete;
+	/// until then there are no groups, so no draw call is blocked and nothing has to wait for the load.
+	/// </summary>
+	class ProfileLoader
+	{
+	public:
+		ProfileLoader();
+		~ProfileLoader();
+
+		/// <summary>
+		/// Starts loading the profile on a background thread. Only the first call starts a load, subsequent calls do nothing.
+		/// </summary>
+		void startLoading(const std::string& iniFileName, const std::string& compiledProfileFileName);
+		/// <summary>
+		/// Waits for a load in progress to finish and joins the load thread. Not to be called from DllMain.
+		/// </summary>
+		void stop();
+		/// <summary>
+		/// Returns the loaded profile if loading has finished, nullptr otherwise. The profile is handed out once: subsequent calls return nullptr.
+		/// </summary>
+		std::unique_ptr<ProfileSnapshot> takeLoadedProfile();
+		bool isLoaded() const { return _state->isLoaded.load(std::memory_order_acquire); }
+		/// <summary>
+		/// The time it took to load the profile, in milliseconds. Only valid when isLoaded() returns true.
+		/// </summary>
+		double getLoadTimeInMilliseconds() const { return _state->loadTimeInMilliseconds; }
+
+		/// <summary>
+		/// Reads the profile synchronously from the files specified into the snapshot specified. If the compiled profile was compiled from the ini
+		/// file as it is now (same size and last write time) it's used, otherwise the ini file is parsed and the compiled profile is regenerated from it.
+		/// </summary>
+		/// <returns>true if a profile was found, false otherwise</returns>
+		static bool loadProfile(const std::string& iniFileName, const std::string& compiledProfileFileName, ProfileSnapshot& toFill);
+		/// <summary>
+		/// Parses the ini file specified into the snapshot specified. The compiled profile isn't used nor updated. If the file is there but can't
+		/// be read, e.g. because it was written by a newer version, or looks incomplete (AmountGroups missing or not matching the group sections
+		/// present), toFill.loadError is set and no groups are read.
+		/// </summary>
+		/// <returns>true if the ini file was found, false otherwise</returns>
+		static bool loadIniFile(const std::string& iniFileName, ProfileSnapshot& toFill);
+
+	private:
+		// shared with the worker thread, so it stays valid if the loader is destroyed while the profile is still loading.
+		struct SharedState
+		{
+			std::atomic<ProfileSnapshot*> loadedProfile = nullptr;
+			std::atomic_bool isLoaded = false;
+			double loadTimeInMilliseconds = 0.0;		// written before isLoaded is set
+
+			~SharedState() { delete loadedProfile.load(); }
+		};
+
+		static void loadWorker(std::shared_ptr<SharedState> state, std::string iniFileName, std::string compiledProfileFileName);
+		static void loadFromCompiledProfile(const CompiledProfile& compiledProfile, ProfileSnapshot& toFill);
+
+		std::shared_ptr<SharedState> _state;
+		std::thread _loadThread;
+		bool _loadStarted = false;
+	};
+}
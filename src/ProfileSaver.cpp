@@ -0,0 +1,221 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "ProfileSaver.h"
+
+#include <filesystem>
+
+#include "CompiledProfile.h"
+#include "IniFileWriter.h"
+
+namespace ShaderToggler
+{
+	ProfileSaver::ProfileSaver(): _state(std::make_shared<SharedState>())
+	{
+	}
+
+
+	ProfileSaver::~ProfileSaver()
+	{
+		{
+			std::unique_lock lock(_state->mutex);
+			_state->stopRequested = true;
+		}
+		_state->wakeUp.notify_all();
+		if(_saveThread.joinable())
+		{
+			// stop() wasn't called. Not joined: this runs while the dll is detached, under the loader lock, and the thread can't exit while that's
+			// held. The thread owns a reference to the shared state, so it can safely finish on its own.
+			_saveThread.detach();
+		}
+	}
+
+
+	void ProfileSaver::setFileNames(const std::string& iniFileName, const std::string& compiledProfileFileName)
+	{
+		std::unique_lock lock(_state->mutex);
+		_state->iniFileName = iniFileName;
+		_state->compiledProfileFileName = compiledProfileFileName;
+	}
+
+
+	void ProfileSaver::requestSave(ProfileSnapshot&& snapshot, std::chrono::milliseconds delay)
+	{
+		{
+			std::unique_lock lock(_state->mutex);
+			_state->pendingSnapshot = std::make_unique<ProfileSnapshot>(std::move(snapshot));
+			_state->pendingDueTime = std::chrono::steady_clock::now() + delay;
+			_state->status.state = SaveState::Pending;
+			_state->status.message.clear();
+		}
+		// started on first use rather than at dll load, as threads can't be started safely from DllMain.
+		if(!_saveThread.joinable())
+		{
+			_saveThread = std::thread(saveLoop, _state);
+		}
+		_state->wakeUp.notify_all();
+	}
+
+
+	ProfileSaver::SaveStatus ProfileSaver::getStatus()
+	{
+		std::unique_lock lock(_state->mutex);
+		return _state->status;
+	}
+
+
+	FileStamp ProfileSaver::getLastSavedIniFileStamp()
+	{
+		std::unique_lock lock(_state->mutex);
+		return _state->lastSavedIniFileStamp;
+	}
+
+
+	void ProfileSaver::stop()
+	{
+		{
+			std::unique_lock lock(_state->mutex);
+			_state->stopRequested = true;
+		}
+		_state->wakeUp.notify_all();
+		if(_saveThread.joinable())
+		{
+			_saveThread.join();
+		}
+		std::unique_lock lock(_state->mutex);
+		_state->stopRequested = false;
+	}
+
+
+	void ProfileSaver::saveLoop(std::shared_ptr<SharedState> state)
+	{
+		std::unique_lock lock(state->mutex);
+		while(true)
+		{
+			if(nullptr == state->pendingSnapshot)
+			{
+				if(state->stopRequested)
+				{
+					break;
+				}
+				state->wakeUp.wait(lock);
+				continue;
+			}
+			// a pending snapshot is flushed when stopping, regardless of its due time, so the last edits aren't lost.
+			if(!state->stopRequested && std::chrono::steady_clock::now() < state->pendingDueTime)
+			{
+				// a newer request might come in while waiting, which replaces the snapshot and moves the due time.
+				state->wakeUp.wait_until(lock, state->pendingDueTime);
+				continue;
+			}
+
+			const std::unique_ptr<ProfileSnapshot> snapshot = std::move(state->pendingSnapshot);
+			const std::string iniFileName = state->iniFileName;
+			const std::string compiledProfileFileName = state->compiledProfileFileName;
+			state->status.state = SaveState::Saving;
+			lock.unlock();
+
+			// the ini file is written first, so the compiled profile can record the stamp of the ini file it matches and is used at the next start.
+			std::string errorMessage;
+			const bool iniFileWritten = writeIniFile(*snapshot, iniFileName, errorMessage);
+			const FileStamp iniFileStamp = FileStamp::read(iniFileName);
+			const bool succeeded = iniFileWritten && writeCompiledProfile(*snapshot, iniFileStamp, compiledProfileFileName, errorMessage);
+
+			lock.lock();
+			if(iniFileWritten)
+			{
+				state->lastSavedIniFileStamp = iniFileStamp;
+			}
+			if(nullptr == state->pendingSnapshot)
+			{
+				state->status.state = succeeded ? SaveState::Succeeded : SaveState::Failed;
+				state->status.message = errorMessage;
+			}
+		}
+	}
+
+
+	bool ProfileSaver::writeIniFile(const ProfileSnapshot& snapshot, const std::string& fileName, std::string& errorMessage)
+	{
+		// format: first section with # of groups, then per group a section with pixel and vertex shaders, as well as their name and key value.
+		// groups are stored with "Group" + group counter, starting with 0. Everything is streamed into the writer in file order, in one pass.
+		IniFileWriter iniFile;
+		iniFile.writeSection("General");
+		iniFile.writeInt("FormatVersion", INI_FORMAT_VERSION);
+		iniFile.writeInt("AmountGroups", static_cast<int>(snapshot.groups.size()));
+		iniFile.writeBool("DeltaEncodeHashes", snapshot.deltaEncodeHashLists);
+		iniFile.writeBool("AutoSave", snapshot.autoSave);
+
+		int groupCounter = 0;
+		for(const auto& group : snapshot.groups)
+		{
+			group.saveState(iniFile, groupCounter, snapshot.deltaEncodeHashLists);
+			groupCounter++;
+		}
+
+		const std::string temporaryFileName = fileName + ".tmp";
+		if(!iniFile.save(temporaryFileName))
+		{
+			errorMessage = "Couldn't write " + temporaryFileName;
+			return false;
+		}
+		return replaceFile(temporaryFileName, fileName, errorMessage);
+	}
+
+
+	bool ProfileSaver::writeCompiledProfile(const ProfileSnapshot& snapshot, const FileStamp& iniFileStamp, const std::string& fileName, std::string& errorMessage)
+	{
+		uint32_t flags = snapshot.deltaEncodeHashLists ? CompiledProfile::FLAG_DELTA_ENCODE_HASHES : 0;
+		flags |= snapshot.autoSave ? CompiledProfile::FLAG_AUTO_SAVE : 0;
+		if(!CompiledProfile::write(fileName, snapshot.groups, flags, iniFileStamp))
+		{
+			errorMessage = "Couldn't write " + fileName;
+			return false;
+		}
+		return true;
+	}
+
+
+	bool ProfileSaver::replaceFile(const std::string& temporaryFileName, const std::string& fileName, std::string& errorMessage)
+	{
+		// rename replaces an existing destination in one step, so readers either see the old or the new file, never a partial one.
+		std::error_code errorCode;
+		std::filesystem::rename(temporaryFileName, fileName, errorCode);
+		if(errorCode)
+		{
+			errorMessage = "Couldn't replace " + fileName + ": " + errorCode.message();
+			std::filesystem::remove(temporaryFileName, errorCode);
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FileChangeWatcher.h"
+#include "ToggleGroup.h"
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Copy of everything that's written to the profile files: the toggle groups and the settings stored in the General section.
+	/// </summary>
+	struct ProfileSnapshot
+	{
+		std::vector<ToggleGroup> groups;
+		bool deltaEncodeHashLists = false;
+		bool autoSave = false;
+		std::string loadError;			// only set by the loader: why the profile file couldn't be read, empty if it was read.
+	};
+
+
+	/// <summary>
+	/// Saves the profile (the ini file and the compiled profile) on a background thread, so the render thread never waits for serialization or
+	/// file I/O. Files are written to a temporary file first, which then replaces the real file, so a failed or interrupted save never leaves a
+	/// truncated profile behind. Save requests coming in while an earlier one is still waiting are coalesced: only the last snapshot is written.
+	/// </summary>
+	class ProfileSaver
+	{
+	public:
+		// version of the ini layout, written as FormatVersion in the General section. 1 (no FormatVersion key) has a ShaderHashN key per hash,
+		// 2 has a single hash list per stage. Files with a newer version than this are not read, so they aren't overwritten with missing data.
+		static constexpr int INI_FORMAT_VERSION = 2;
+
+		enum class SaveState
+		{
+			Idle,
+			Pending,
+			Saving,
+			Succeeded,
+			Failed
+		};
+
+		struct SaveStatus
+		{
+			SaveState state = SaveState::Idle;
+			std::string message;
+		};
+
+		ProfileSaver();
+		~ProfileSaver();
+
+		void setFileNames(const std::string& iniFileName, const std::string& compiledProfileFileName);
+		/// <summary>
+		/// Queues the snapshot specified for saving after the delay specified. If a save is already pending, it's replaced by this one.
+		/// </summary>
+		/// <param name="snapshot"></param>
+		/// <param name="delay">time to wait before saving, used to debounce automatic saves. 0 saves right away.</param>
+		void requestSave(ProfileSnapshot&& snapshot, std::chrono::milliseconds delay);
+		SaveStatus getStatus();
+		/// <summary>
+		/// Returns the stamp of the ini file as it was after the last successful save, so changes caused by the saver itself can be recognized.
+		/// </summary>
+		FileStamp getLastSavedIniFileStamp();
+		/// <summary>
+		/// Writes a pending snapshot right away, without waiting for its delay, and stops and joins the save thread. Call this when the effect
+		/// runtime goes away, not from DllMain. A later requestSave starts the thread again.
+		/// </summary>
+		void stop();
+
+		/// <summary>
+		/// Writes the snapshot specified to the ini file specified, via a temporary file which then replaces the ini file.
+		/// </summary>
+		/// <returns>true if successful, false otherwise, in which case errorMessage contains the reason</returns>
+		static bool writeIniFile(const ProfileSnapshot& snapshot, const std::string& fileName, std::string& errorMessage);
+		/// <summary>
+		/// Writes the snapshot specified to the compiled profile file specified, via a temporary file which then replaces the compiled profile.
+		/// iniFileStamp is the stamp of the ini file with the same contents, which the compiled profile has to match to be used.
+		/// </summary>
+		/// <returns>true if successful, false otherwise, in which case errorMessage contains the reason</returns>
+		static bool writeCompiledProfile(const ProfileSnapshot& snapshot, const FileStamp& iniFileStamp, const std::string& fileName, std::string& errorMessage);
+
+	private:
+		struct SharedState
+		{
+			std::mutex mutex;
+			std::condition_variable wakeUp;
+			std::unique_ptr<ProfileSnapshot> pendingSnapshot;
+			std::chrono::steady_clock::time_point pendingDueTime;
+			std::string iniFileName;
+			std::string compiledProfileFileName;
+			SaveStatus status;
+			FileStamp lastSavedIniFileStamp;
+			bool stopRequested = false;
+		};
+
+		static void saveLoop(std::shared_ptr<SharedState> state);
+		static bool replaceFile(const std::string& temporaryFileName, const std::string& fileName, std::string& errorMessage);
+
+		std::shared_ptr<SharedState> _state;
+		std::thread _saveThread;
+	};
+}
@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "ReaderEpochs.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace ShaderToggler
+{
+	namespace
+	{
+		/// <summary>
+		/// The epoch a reading thread announced. Records are handed to threads the first time they read and handed back when they exit, so
+		/// they're reused rather than freed and the list only grows to the most threads which ever read at the same time.
+		/// </summary>
+		struct alignas(64) ReaderRecord
+		{
+			std::atomic<uint64_t> epoch = ReaderEpochs::NOT_READING;
+			std::atomic_bool isInUse = false;
+			ReaderRecord* next = nullptr;
+			uint32_t sectionDepth = 0;		// only touched by the thread owning the record.
+		};
+
+		/// <summary>
+		/// Hands the record back when the thread owning it exits.
+		/// </summary>
+		struct ThreadReaderRecord
+		{
+			ReaderRecord* record = nullptr;
+
+			~ThreadReaderRecord()
+			{
+				if(nullptr != record)
+				{
+					record->isInUse.store(false, std::memory_order_release);
+				}
+			}
+		};
+
+		std::atomic<uint64_t> g_currentEpoch = 1;
+		std::atomic<ReaderRecord*> g_readerRecords = nullptr;
+		thread_local ThreadReaderRecord t_readerRecord;
+
+
+		ReaderRecord* acquireReaderRecord()
+		{
+			for(ReaderRecord* record = g_readerRecords.load(std::memory_order_acquire); nullptr != record; record = record->next)
+			{
+				bool isInUse = false;
+				if(!record->isInUse.load(std::memory_order_relaxed) && record->isInUse.compare_exchange_strong(isInUse, true, std::memory_order_acquire))
+				{
+					return record;
+				}
+			}
+			auto record = new ReaderRecord();
+			record->isInUse.store(true, std::memory_order_relaxed);
+			ReaderRecord* head = g_readerRecords.load(std::memory_order_relaxed);
+			do
+			{
+				record->next = head;
+			}
+			while(!g_readerRecords.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+			return record;
+		}
+
+
+		// a reader stores its epoch and then loads a published pointer; the present thread replaces the pointer and then reads the epochs. Each
+		// side needs its store ordered before its load, or both could miss the other's store. On Windows the present thread forces that
+		// ordering onto all readers at once, so a draw call only pays for a compiler barrier.
+		void orderReaderStoreBeforeLoad()
+		{
+#ifdef _WIN32
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+#else
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+		}
+
+
+		void orderRetireBeforeReaderScan()
+		{
+#ifdef _WIN32
+			FlushProcessWriteBuffers();
+#else
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+		}
+	}
+
+
+	ReaderEpochs::ReadSection::ReadSection()
+	{
+		if(nullptr == t_readerRecord.record)
+		{
+			t_readerRecord.record = acquireReaderRecord();
+		}
+		ReaderRecord& record = *t_readerRecord.record;
+		if(record.sectionDepth++ == 0)
+		{
+			record.epoch.store(g_currentEpoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+			orderReaderStoreBeforeLoad();
+		}
+	}
+
+
+	ReaderEpochs::ReadSection::~ReadSection()
+	{
+		ReaderRecord& record = *t_readerRecord.record;
+		if(--record.sectionDepth == 0)
+		{
+			// release: the reads of the published objects are done before the present thread can see the thread isn't reading.
+			record.epoch.store(NOT_READING, std::memory_order_release);
+		}
+	}
+
+
+	uint64_t ReaderEpochs::retireObject()
+	{
+		return g_currentEpoch.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+
+	uint64_t ReaderEpochs::getOldestReadEpoch()
+	{
+		orderRetireBeforeReaderScan();
+		uint64_t oldestEpoch = NOT_READING;
+		for(ReaderRecord* record = g_readerRecords.load(std::memory_order_acquire); nullptr != record; record = record->next)
+		{
+			const uint64_t epoch = record->epoch.load(std::memory_order_acquire);
+			oldestEpoch = epoch < oldestEpoch ? epoch : oldestEpoch;
+		}
+		return oldestEpoch;
+	}
+}
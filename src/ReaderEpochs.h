@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Epoch based tracking of the threads which read objects published through atomic pointers, so a replaced object is freed only once no
+	/// thread can still be reading it. A reader wraps every access to a published object in a ReadSection; the present thread stamps each
+	/// object it replaces with retireObject and frees it once getOldestReadEpoch has moved past that stamp. A thread which isn't inside a
+	/// ReadSection holds no published objects, however long it's preempted or records a command list, so it never delays freeing.
+	/// Process wide, as the draw call hooks read all published objects in the same section.
+	/// </summary>
+	class ReaderEpochs
+	{
+	public:
+		static constexpr uint64_t NOT_READING = UINT64_MAX;
+
+		/// <summary>
+		/// Marks the calling thread as reading published objects for the lifetime of the instance. Objects loaded from a published pointer
+		/// inside the section stay valid until the section ends. Sections can be nested.
+		/// </summary>
+		class ReadSection
+		{
+		public:
+			ReadSection();
+			~ReadSection();
+			ReadSection(const ReadSection&) = delete;
+			ReadSection& operator=(const ReadSection&) = delete;
+		};
+
+		/// <summary>
+		/// Returns the epoch to stamp an object with which was just replaced in its published pointer, and starts a new epoch. Readers which
+		/// start a section after this call can't load the replaced object anymore.
+		/// </summary>
+		static uint64_t retireObject();
+		/// <summary>
+		/// Returns the oldest epoch a thread currently inside a ReadSection started its section in, NOT_READING if no thread is. Objects stamped
+		/// with an epoch older than this aren't read by anyone anymore.
+		/// </summary>
+		static uint64_t getOldestReadEpoch();
+	};
+}
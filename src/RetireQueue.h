@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ReaderEpochs.h"
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Keeps objects which were replaced in an atomic pointer alive until no thread can be reading them anymore. Readers only use a published
+	/// object inside a ReaderEpochs::ReadSection, so a retired object is freed once every thread which was inside a section when it was retired
+	/// has left that section. Only used from the present thread.
+	/// </summary>
+	template<typename T>
+	class RetireQueue
+	{
+	public:
+		/// <summary>
+		/// Takes ownership of the object passed in, which was just replaced in its published pointer. A nullptr is ignored.
+		/// </summary>
+		void retire(const T* toRetire)
+		{
+			if(nullptr != toRetire)
+			{
+				_retired.emplace_back(ReaderEpochs::retireObject(), std::unique_ptr<const T>(toRetire));
+			}
+		}
+
+		/// <summary>
+		/// Frees the retired objects no reader can hold anymore. Called once per presented frame.
+		/// </summary>
+		void collect()
+		{
+			if(_retired.empty())
+			{
+				return;
+			}
+			const uint64_t oldestReadEpoch = ReaderEpochs::getOldestReadEpoch();
+			std::erase_if(_retired, [oldestReadEpoch](const auto& retired) { return retired.first < oldestReadEpoch; });
+		}
+
+		size_t size() const { return _retired.size(); }
+
+	private:
+		std::vector<std::pair<uint64_t, std::unique_ptr<const T>>> _retired;	// retired objects, with the epoch they were retired in, oldest first.
+	};
+}
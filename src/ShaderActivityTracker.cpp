@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "ShaderActivityTracker.h"
+
+namespace ShaderToggler
+{
+	ShaderActivityTracker::ShaderActivityTracker()
+	{
+		for(auto& chunk : _chunks)
+		{
+			chunk.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+
+	ShaderActivityTracker::~ShaderActivityTracker()
+	{
+		for(auto& chunk : _chunks)
+		{
+			delete[] chunk.load(std::memory_order_relaxed);
+		}
+	}
+
+
+	void ShaderActivityTracker::ensureCapacity(uint32_t shaderId)
+	{
+		if(shaderId >= MAX_SHADER_IDS)
+		{
+			return;
+		}
+		std::atomic<std::atomic<uint32_t>*>& chunk = _chunks[shaderId >> CHUNK_SHIFT];
+		if(nullptr == chunk.load(std::memory_order_relaxed))
+		{
+			auto newChunk = new std::atomic<uint32_t>[CHUNK_SIZE];
+			for(uint32_t i = 0; i < CHUNK_SIZE; i++)
+			{
+				newChunk[i].store(0, std::memory_order_relaxed);
+			}
+			chunk.store(newChunk, std::memory_order_release);
+		}
+	}
+}
@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Keeps, per shader id, the number of the last frame the shader was bound in. Written from the pipeline bind hooks with a single relaxed
+	/// store, so it can run all the time, and read when hunting starts to get the shaders used recently without a collection phase.
+	/// The storage is allocated in fixed size chunks which are never moved or freed, so writers never have to lock.
+	/// </summary>
+	class ShaderActivityTracker
+	{
+	public:
+		ShaderActivityTracker();
+		~ShaderActivityTracker();
+
+		/// <summary>
+		/// Makes sure the shader id specified can be tracked. Called when a shader id is assigned; not thread safe with itself.
+		/// </summary>
+		/// <param name="shaderId"></param>
+		void ensureCapacity(uint32_t shaderId);
+
+		/// <summary>
+		/// Records that the shader with the id specified has been bound in the frame specified. Frame numbers start at 1, 0 means 'never'.
+		/// </summary>
+		void markSeen(uint32_t shaderId, uint32_t frame)
+		{
+			if(shaderId >= MAX_SHADER_IDS)
+			{
+				return;
+			}
+			std::atomic<uint32_t>* chunk = _chunks[shaderId >> CHUNK_SHIFT].load(std::memory_order_acquire);
+			if(nullptr != chunk)
+			{
+				std::atomic<uint32_t>& lastSeenFrame = chunk[shaderId & CHUNK_MASK];
+				// skip the store if it's already up to date, so a shader bound many times per frame keeps its cache line shared.
+				if(lastSeenFrame.load(std::memory_order_relaxed) != frame)
+				{
+					lastSeenFrame.store(frame, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Returns the last frame the shader with the id specified was bound in, 0 if it hasn't been bound since it got its id.
+		/// </summary>
+		uint32_t getLastSeenFrame(uint32_t shaderId) const
+		{
+			if(shaderId >= MAX_SHADER_IDS)
+			{
+				return 0;
+			}
+			const std::atomic<uint32_t>* chunk = _chunks[shaderId >> CHUNK_SHIFT].load(std::memory_order_acquire);
+			return nullptr == chunk ? 0 : chunk[shaderId & CHUNK_MASK].load(std::memory_order_relaxed);
+		}
+
+	private:
+		static constexpr uint32_t CHUNK_SHIFT = 12;
+		static constexpr uint32_t CHUNK_SIZE = 1 << CHUNK_SHIFT;
+		static constexpr uint32_t CHUNK_MASK = CHUNK_SIZE - 1;
+		static constexpr uint32_t MAX_CHUNKS = 1024;
+		static constexpr uint32_t MAX_SHADER_IDS = CHUNK_SIZE * MAX_CHUNKS;
+
+		std::array<std::atomic<std::atomic<uint32_t>*>, MAX_CHUNKS> _chunks;
+	};
+}
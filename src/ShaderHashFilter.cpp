@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "ShaderHashFilter.h"
+
+namespace ShaderToggler
+{
+	void ShaderHashFilter::reserve(size_t amountHashes)
+	{
+		const size_t bitsPerBlock = WORDS_PER_BLOCK * 32;
+		const size_t amountBlocks = (amountHashes * BITS_PER_HASH + bitsPerBlock - 1) / bitsPerBlock;
+		_blocks.assign(amountBlocks > 0 ? amountBlocks : 1, Block{});
+	}
+
+
+	void ShaderHashFilter::add(const ShaderHashSet& hashes)
+	{
+		for(const uint32_t hash : hashes)
+		{
+			add(hash);
+		}
+	}
+
+
+	void ShaderHashFilter::add(uint32_t hash)
+	{
+		if(_blocks.empty())
+		{
+			reserve(1);
+		}
+		Block& block = _blocks[blockIndex(hash)];
+		for(uint32_t i = 0; i < WORDS_PER_BLOCK; i++)
+		{
+			block.words[i] |= bitInWord(hash, i);
+		}
+		_isEmpty = false;
+	}
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ShaderHashSet.h"
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Split block bloom filter over shader hashes. Each hash maps to one 32 byte block, in which it sets one bit in each of the 8 words, so a
+	/// lookup touches a single cache line. Meant as a fast reject in front of membership checks by hash: when most hashes looked up aren't in
+	/// any of the sets, mightContain returns false for those without looking at the sets. The draw call checks don't need it, as they look up
+	/// the active groups by shader id. A true result can be a false positive, a false result is always correct. Immutable after construction.
+	/// </summary>
+	class ShaderHashFilter
+	{
+	public:
+		static constexpr uint32_t BITS_PER_HASH = 16;		// ~0.1% false positive rate at this load
+
+		ShaderHashFilter() = default;
+
+		/// <summary>
+		/// Adds the hashes in the set specified. Call reserve first with the total number of hashes to add, as the size of the filter can't
+		/// change after the first add.
+		/// </summary>
+		void reserve(size_t amountHashes);
+		void add(const ShaderHashSet& hashes);
+		void add(uint32_t hash);
+
+		bool mightContain(uint32_t hash) const
+		{
+			if(_isEmpty)
+			{
+				return false;
+			}
+			const Block& block = _blocks[blockIndex(hash)];
+			uint32_t missingBits = 0;
+			for(uint32_t i = 0; i < WORDS_PER_BLOCK; i++)
+			{
+				missingBits |= ~block.words[i] & bitInWord(hash, i);
+			}
+			return missingBits == 0;
+		}
+
+		bool isEmpty() const { return _isEmpty; }
+
+	private:
+		static constexpr uint32_t WORDS_PER_BLOCK = 8;
+		struct alignas(32) Block
+		{
+			uint32_t words[WORDS_PER_BLOCK];
+		};
+
+		size_t blockIndex(uint32_t hash) const
+		{
+			// the hashes are crc32 values, so a multiplicative rehash is enough to spread them. Multiply-shift maps it onto any block count.
+			const uint32_t mixedHash = hash * 0x9E3779B1u;
+			return static_cast<size_t>((static_cast<uint64_t>(mixedHash) * _blocks.size()) >> 32);
+		}
+
+		static uint32_t bitInWord(uint32_t hash, uint32_t wordIndex)
+		{
+			// odd salts, one per word, pick an independent bit per word from the top 5 bits of the product.
+			static constexpr uint32_t salts[WORDS_PER_BLOCK] = { 0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U };
+			return 1u << ((hash * salts[wordIndex]) >> 27);
+		}
+
+		std::vector<Block> _blocks;
+		bool _isEmpty = true;
+	};
+}
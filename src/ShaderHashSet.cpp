@@ -0,0 +1,325 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "ShaderHashSet.h"
+
+#include <algorithm>
+#include <bit>
+
+#include <numeric>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SHADERHASHSET_AVX2
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SHADERHASHSET_SSE2
+#elif defined(_M_ARM64) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SHADERHASHSET_NEON
+#endif
+
+namespace ShaderToggler
+{
+#ifdef SHADERHASHSET_AVX2
+	static constexpr size_t SIMD_LANES = 8;
+#else
+	static constexpr size_t SIMD_LANES = 4;
+#endif
+	static_assert(ShaderHashSet::SMALL_SET_PADDING % SIMD_LANES == 0, "a small set has to be a whole number of SIMD compares");
+	static constexpr uint32_t PILOT_MULTIPLIER = 0x9E3779B1;
+	static constexpr uint32_t MAX_PILOT_ATTEMPTS = 1 << 16;
+
+
+	void ShaderHashSet::assign(std::vector<uint32_t>&& hashes)
+	{
+		std::sort(hashes.begin(), hashes.end());
+		hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+		assignSorted(hashes);
+	}
+
+
+	void ShaderHashSet::assign(const std::unordered_set<uint32_t>& hashes)
+	{
+		assign(std::vector<uint32_t>(hashes.begin(), hashes.end()));
+	}
+
+
+	void ShaderHashSet::assignSorted(std::span<const uint32_t> sortedHashes)
+	{
+		_layoutOwner.reset();
+		_viewedValues = nullptr;
+		_count = sortedHashes.size();
+		if(_count <= SMALL_SET_LIMIT)
+		{
+			setTableShape(0);
+			_values.assign(sortedHashes.begin(), sortedHashes.end());
+			if(_count > 0)
+			{
+				// a duplicate of a member never causes a false positive.
+				_values.resize((_count + SMALL_SET_PADDING - 1) / SMALL_SET_PADDING * SMALL_SET_PADDING, sortedHashes.back());
+			}
+			return;
+		}
+		// If a bucket can't be placed, which is very unlikely, the table is grown and the whole build is redone.
+		uint32_t slotBits = getMinimalSlotBits(_count);
+		while(!buildPerfectHash(sortedHashes, slotBits))
+		{
+			slotBits++;
+		}
+	}
+
+
+	bool ShaderHashSet::assignLayout(std::span<const uint32_t> layout, size_t count, uint32_t slotBits, std::shared_ptr<const void> owner)
+	{
+		size_t layoutSize = 0;
+		if(!getLayoutSize(count, slotBits, layoutSize) || layout.size() != layoutSize)
+		{
+			clear();
+			return false;
+		}
+		_values = std::vector<uint32_t>();
+		_layoutOwner = std::move(owner);
+		_viewedValues = layout.data();
+		_count = count;
+		setTableShape(slotBits);
+		return true;
+	}
+
+
+	void ShaderHashSet::clear()
+	{
+		_values.clear();
+		_layoutOwner.reset();
+		_viewedValues = nullptr;
+		_count = 0;
+		setTableShape(0);
+	}
+
+
+	bool ShaderHashSet::contains(uint32_t hash) const
+	{
+		return _count <= SMALL_SET_LIMIT ? containsSmall(hash) : containsLarge(hash);
+	}
+
+
+	void ShaderHashSet::copySortedHashes(std::vector<uint32_t>& destination) const
+	{
+		destination.assign(begin(), end());
+	}
+
+
+	std::span<const uint32_t> ShaderHashSet::getLayout() const
+	{
+		size_t layoutSize = 0;
+		getLayoutSize(_count, getSlotBits(), layoutSize);
+		return std::span<const uint32_t>(getValues(), layoutSize);
+	}
+
+
+	bool ShaderHashSet::getLayoutSize(size_t count, uint32_t slotBits, size_t& layoutSize)
+	{
+		layoutSize = 0;
+		if(count <= SMALL_SET_LIMIT)
+		{
+			layoutSize = (count + SMALL_SET_PADDING - 1) / SMALL_SET_PADDING * SMALL_SET_PADDING;
+			return slotBits == 0;
+		}
+		if(slotBits < getMinimalSlotBits(count) || slotBits > MAX_SLOT_BITS)
+		{
+			return false;
+		}
+		layoutSize = count + (size_t(1) << getBucketBits(count)) + (size_t(1) << slotBits);
+		return true;
+	}
+
+
+	bool ShaderHashSet::operator==(const ShaderHashSet& rhs) const
+	{
+		return _count == rhs._count && std::equal(begin(), end(), rhs.begin());
+	}
+
+
+	bool ShaderHashSet::containsSmall(uint32_t hash) const
+	{
+		// the matches of all chunks are combined rather than returning at the first one: whether a hash is in the set is as good as random
+		// per draw call, so an early exit is a mispredicted branch half of the time, which costs more than the few extra compares.
+		const size_t paddedCount = (_count + SMALL_SET_PADDING - 1) / SMALL_SET_PADDING * SMALL_SET_PADDING;
+		const uint32_t* values = getValues();
+#if defined(SHADERHASHSET_AVX2)
+		const __m256i toFind = _mm256_set1_epi32(static_cast<int>(hash));
+		__m256i matches = _mm256_setzero_si256();
+		for(size_t i = 0; i < paddedCount; i += SIMD_LANES)
+		{
+			const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+			matches = _mm256_or_si256(matches, _mm256_cmpeq_epi32(chunk, toFind));
+		}
+		return _mm256_movemask_epi8(matches) != 0;
+#elif defined(SHADERHASHSET_SSE2)
+		const __m128i toFind = _mm_set1_epi32(static_cast<int>(hash));
+		__m128i matches = _mm_setzero_si128();
+		for(size_t i = 0; i < paddedCount; i += SIMD_LANES)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			matches = _mm_or_si128(matches, _mm_cmpeq_epi32(chunk, toFind));
+		}
+		return _mm_movemask_epi8(matches) != 0;
+#elif defined(SHADERHASHSET_NEON)
+		const uint32x4_t toFind = vdupq_n_u32(hash);
+		uint32x4_t matches = vdupq_n_u32(0);
+		for(size_t i = 0; i < paddedCount; i += SIMD_LANES)
+		{
+			matches = vorrq_u32(matches, vceqq_u32(vld1q_u32(values + i), toFind));
+		}
+		const uint64x2_t matchBits = vreinterpretq_u64_u32(matches);
+		return (vgetq_lane_u64(matchBits, 0) | vgetq_lane_u64(matchBits, 1)) != 0;
+#else
+		bool isFound = false;
+		for(size_t i = 0; i < paddedCount; i++)
+		{
+			isFound |= values[i] == hash;
+		}
+		return isFound;
+#endif
+	}
+
+
+	bool ShaderHashSet::containsLarge(uint32_t hash) const
+	{
+		const uint32_t* values = getValues();
+		const uint32_t pilot = values[_count + getBucketIndex(hash)];
+		return values[_slotsIndex + getSlotIndex(hash, pilot)] == hash;
+	}
+
+
+	bool ShaderHashSet::buildPerfectHash(std::span<const uint32_t> sortedHashes, uint32_t slotBits)
+	{
+		setTableShape(slotBits);
+		const size_t bucketCount = _slotsIndex - _count;
+		const size_t slotCount = size_t(1) << slotBits;
+		// an unused slot holds a member, which is never looked up there as its own slot is a different one.
+		_values.assign(_slotsIndex + slotCount, sortedHashes.front());
+		std::copy(sortedHashes.begin(), sortedHashes.end(), _values.begin());
+		std::fill(_values.begin() + _count, _values.begin() + _slotsIndex, 0);
+
+		// group the hashes per bucket.
+		std::vector<uint32_t> bucketStarts(bucketCount + 1, 0);
+		for(const uint32_t hash : sortedHashes)
+		{
+			bucketStarts[getBucketIndex(hash) + 1]++;
+		}
+		std::partial_sum(bucketStarts.begin(), bucketStarts.end(), bucketStarts.begin());
+		std::vector<uint32_t> bucketHashes(_count);
+		std::vector<uint32_t> bucketFill(bucketStarts.begin(), bucketStarts.end() - 1);
+		for(const uint32_t hash : sortedHashes)
+		{
+			bucketHashes[bucketFill[getBucketIndex(hash)]++] = hash;
+		}
+
+		// place the largest buckets first, while most slots are still free.
+		std::vector<uint32_t> bucketOrder(bucketCount);
+		std::iota(bucketOrder.begin(), bucketOrder.end(), 0);
+		std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&](uint32_t lhs, uint32_t rhs)
+			{ return bucketStarts[lhs + 1] - bucketStarts[lhs] > bucketStarts[rhs + 1] - bucketStarts[rhs]; });
+		std::vector<bool> isSlotTaken(slotCount, false);
+		std::vector<size_t> bucketSlots;
+		for(const uint32_t bucket : bucketOrder)
+		{
+			const std::span<const uint32_t> hashes(bucketHashes.data() + bucketStarts[bucket], bucketStarts[bucket + 1] - bucketStarts[bucket]);
+			if(hashes.empty())
+			{
+				break;
+			}
+			bool isPlaced = false;
+			for(uint32_t attempt = 0; attempt < MAX_PILOT_ATTEMPTS && !isPlaced; attempt++)
+			{
+				const uint32_t pilot = attempt * PILOT_MULTIPLIER;
+				bucketSlots.clear();
+				isPlaced = true;
+				for(const uint32_t hash : hashes)
+				{
+					const size_t slot = getSlotIndex(hash, pilot);
+					if(isSlotTaken[slot] || std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+					{
+						isPlaced = false;
+						break;
+					}
+					bucketSlots.push_back(slot);
+				}
+				if(isPlaced)
+				{
+					_values[_count + bucket] = pilot;
+					for(size_t i = 0; i < hashes.size(); i++)
+					{
+						isSlotTaken[bucketSlots[i]] = true;
+						_values[_slotsIndex + bucketSlots[i]] = hashes[i];
+					}
+				}
+			}
+			if(!isPlaced)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	void ShaderHashSet::setTableShape(uint32_t slotBits)
+	{
+		if(0 == slotBits)
+		{
+			_slotsIndex = 0;
+			_bucketShift = 0;
+			_slotShift = 0;
+			return;
+		}
+		const uint32_t bucketBits = getBucketBits(_count);
+		_bucketShift = 64 - bucketBits;
+		_slotShift = 64 - slotBits;
+		_slotsIndex = _count + (size_t(1) << bucketBits);
+	}
+
+
+	uint32_t ShaderHashSet::getBucketBits(size_t count)
+	{
+		// 2 to 4 hashes per bucket keep the pilot search short.
+		return static_cast<uint32_t>(std::bit_width(count - 1)) - 2;
+	}
+
+
+	uint32_t ShaderHashSet::getMinimalSlotBits(size_t count)
+	{
+		// a table which is 40% to 80% full.
+		return static_cast<uint32_t>(std::bit_width(count + count / 4 - 1));
+	}
+}
@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Immutable set of shader hashes, optimized for membership tests: it's rebuilt when a group's shaders change, which is rare, but it's
+	/// queried for every draw call. The hashes are stored in one contiguous array. Small sets are scanned with SIMD compares, larger ones get
+	/// a perfect hash table built when they're assigned: a hash's bucket selects a pilot value which, mixed into the hash, gives the one slot
+	/// the hash can be in, so a lookup is two loads and a single compare, without probing, nodes or a bucket array of pointers. The array is
+	/// the set's layout, which can be stored as is and used in place later on, e.g. from a memory mapped compiled profile.
+	/// </summary>
+	class ShaderHashSet
+	{
+	public:
+		static constexpr size_t SMALL_SET_LIMIT = 32;	// sets up to this size are scanned linearly
+		static constexpr size_t SMALL_SET_PADDING = 8;	// small sets are padded to a multiple of this, the widest SIMD compare
+
+		ShaderHashSet() = default;
+
+		/// <summary>
+		/// Replaces the contents with the hashes specified. The hashes don't have to be sorted and can contain duplicates.
+		/// </summary>
+		void assign(std::vector<uint32_t>&& hashes);
+		void assign(const std::unordered_set<uint32_t>& hashes);
+		/// <summary>
+		/// Replaces the contents with the hashes specified, which have to be sorted and without duplicates, e.g. a list from a compiled profile.
+		/// The hashes are copied into the set's own array, so the source can be released afterwards.
+		/// </summary>
+		void assignSorted(std::span<const uint32_t> sortedHashes);
+		/// <summary>
+		/// Makes the set use the layout specified, as returned by getLayout() of a set, in place: nothing is copied or built. The owner keeps the
+		/// memory of the layout alive, e.g. a mapped file, and is shared by copies of the set. Assigning other hashes releases it.
+		/// </summary>
+		/// <param name="layout"></param>
+		/// <param name="count">size() of the set the layout is from</param>
+		/// <param name="slotBits">getSlotBits() of the set the layout is from</param>
+		/// <param name="owner"></param>
+		/// <returns>true if the layout has the size which belongs to count and slotBits, false otherwise, in which case the set is cleared</returns>
+		bool assignLayout(std::span<const uint32_t> layout, size_t count, uint32_t slotBits, std::shared_ptr<const void> owner);
+		void clear();
+
+		bool contains(uint32_t hash) const;
+		size_t size() const { return _count; }
+		bool empty() const { return _count == 0; }
+
+		/// <summary>
+		/// Iterates the hashes, sorted ascending.
+		/// </summary>
+		const uint32_t* begin() const { return getValues(); }
+		const uint32_t* end() const { return begin() + _count; }
+		std::span<const uint32_t> getHashes() const { return std::span<const uint32_t>(begin(), _count); }
+		/// <summary>
+		/// Copies the hashes, sorted ascending, to the vector specified.
+		/// </summary>
+		void copySortedHashes(std::vector<uint32_t>& destination) const;
+		/// <summary>
+		/// The array the set is stored in. Small sets: the sorted hashes, padded with copies of the last hash to a multiple of SMALL_SET_PADDING
+		/// so the SIMD scan doesn't need a scalar tail. Large sets: the sorted hashes, followed by the pilot per bucket and the slots of the
+		/// perfect hash table.
+		/// </summary>
+		std::span<const uint32_t> getLayout() const;
+		/// <summary>
+		/// The number of bits of a slot index of the perfect hash table, 0 for small sets.
+		/// </summary>
+		uint32_t getSlotBits() const { return _count <= SMALL_SET_LIMIT ? 0 : 64 - _slotShift; }
+		/// <summary>
+		/// Determines the size of the layout of a set with count hashes and the slotBits specified.
+		/// </summary>
+		/// <returns>false if there's no such set, e.g. as the table would be too small to hold count hashes</returns>
+		static bool getLayoutSize(size_t count, uint32_t slotBits, size_t& layoutSize);
+
+		bool operator==(const ShaderHashSet& rhs) const;
+
+	private:
+		bool containsSmall(uint32_t hash) const;
+		bool containsLarge(uint32_t hash) const;
+		bool buildPerfectHash(std::span<const uint32_t> sortedHashes, uint32_t slotBits);
+		void setTableShape(uint32_t slotBits);
+		const uint32_t* getValues() const { return nullptr != _viewedValues ? _viewedValues : _values.data(); }
+		size_t getBucketIndex(uint32_t hash) const { return static_cast<size_t>((hash * BUCKET_MULTIPLIER) >> _bucketShift); }
+		size_t getSlotIndex(uint32_t hash, uint32_t pilot) const { return static_cast<size_t>(((hash ^ pilot) * SLOT_MULTIPLIER) >> _slotShift); }
+		static uint32_t getBucketBits(size_t count);
+		static uint32_t getMinimalSlotBits(size_t count);
+
+		static constexpr uint64_t BUCKET_MULTIPLIER = 0x9E3779B97F4A7C15;
+		static constexpr uint64_t SLOT_MULTIPLIER = 0xD6E8FEB86659FD93;
+		static constexpr uint32_t MAX_SLOT_BITS = 31;
+
+		std::vector<uint32_t> _values;				// the layout, if the set owns it.
+		std::shared_ptr<const void> _layoutOwner;	// keeps _viewedValues alive.
+		const uint32_t* _viewedValues = nullptr;	// the layout, if it's used in place.
+		size_t _count = 0;
+		size_t _slotsIndex = 0;
+		uint32_t _bucketShift = 0;
+		uint32_t _slotShift = 0;
+	};
+}
@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "ShaderIdBitset.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace ShaderToggler
+{
+	void ShaderIdBitset::reserveIds(uint32_t amountIds)
+	{
+		const size_t amountWords = (static_cast<size_t>(amountIds) + 63) / 64;
+		if(amountWords > _words.size())
+		{
+			_words.resize(amountWords, 0);
+		}
+	}
+
+
+	void ShaderIdBitset::set(uint32_t id)
+	{
+		reserveIds(id + 1);
+		_words[id >> 6] |= 1ULL << (id & 63);
+	}
+
+
+	void ShaderIdBitset::reset(uint32_t id)
+	{
+		const size_t wordIndex = id >> 6;
+		if(wordIndex < _words.size())
+		{
+			_words[wordIndex] &= ~(1ULL << (id & 63));
+		}
+	}
+
+
+	void ShaderIdBitset::clear()
+	{
+		std::fill(_words.begin(), _words.end(), 0);
+	}
+
+
+	void ShaderIdBitset::subtract(const ShaderIdBitset& other)
+	{
+		const size_t amountWords = std::min(_words.size(), other._words.size());
+		for(size_t i = 0; i < amountWords; i++)
+		{
+			_words[i] &= ~other._words[i];
+		}
+	}
+
+
+	void ShaderIdBitset::clearFrom(uint32_t firstIdToClear)
+	{
+		const size_t wordIndex = firstIdToClear >> 6;
+		if(wordIndex >= _words.size())
+		{
+			return;
+		}
+		_words[wordIndex] &= (1ULL << (firstIdToClear & 63)) - 1;
+		std::fill(_words.begin() + wordIndex + 1, _words.end(), 0);
+	}
+
+
+	uint32_t ShaderIdBitset::count() const
+	{
+		uint32_t toReturn = 0;
+		for(const uint64_t word : _words)
+		{
+			toReturn += std::popcount(word);
+		}
+		return toReturn;
+	}
+
+
+	uint32_t ShaderIdBitset::rank(uint32_t id) const
+	{
+		const size_t lastWordIndex = id >> 6;
+		uint32_t toReturn = 0;
+		for(size_t i = 0; i < lastWordIndex && i < _words.size(); i++)
+		{
+			toReturn += std::popcount(_words[i]);
+		}
+		if(lastWordIndex < _words.size() && (id & 63) != 0)
+		{
+			toReturn += std::popcount(_words[lastWordIndex] & ((1ULL << (id & 63)) - 1));
+		}
+		return toReturn;
+	}
+
+
+	uint32_t ShaderIdBitset::findNext(uint32_t startId, const ShaderIdBitset* mask) const
+	{
+		size_t wordIndex = startId >> 6;
+		if(wordIndex >= _words.size())
+		{
+			return NO_ID;
+		}
+		// drop the bits below startId in the first word.
+		uint64_t word = maskedWord(wordIndex, mask) & (~0ULL << (startId & 63));
+		while(true)
+		{
+			if(word != 0)
+			{
+				return static_cast<uint32_t>(wordIndex * 64 + std::countr_zero(word));
+			}
+			wordIndex++;
+			if(wordIndex >= _words.size())
+			{
+				return NO_ID;
+			}
+			word = maskedWord(wordIndex, mask);
+		}
+	}
+
+
+	uint32_t ShaderIdBitset::findPrevious(uint32_t startId, const ShaderIdBitset* mask) const
+	{
+		if(_words.empty())
+		{
+			return NO_ID;
+		}
+		size_t wordIndex = startId >> 6;
+		uint64_t word;
+		if(wordIndex >= _words.size())
+		{
+			wordIndex = _words.size() - 1;
+			word = maskedWord(wordIndex, mask);
+		}
+		else
+		{
+			// drop the bits above startId in the first word.
+			word = maskedWord(wordIndex, mask) & (~0ULL >> (63 - (startId & 63)));
+		}
+		while(true)
+		{
+			if(word != 0)
+			{
+				return static_cast<uint32_t>(wordIndex * 64 + 63 - std::countl_zero(word));
+			}
+			if(wordIndex == 0)
+			{
+				return NO_ID;
+			}
+			wordIndex--;
+			word = maskedWord(wordIndex, mask);
+		}
+	}
+
+
+	uint32_t ShaderIdBitset::select(uint32_t index) const
+	{
+		for(size_t wordIndex = 0; wordIndex < _words.size(); wordIndex++)
+		{
+			uint64_t word = _words[wordIndex];
+			const uint32_t bitsInWord = std::popcount(word);
+			if(index >= bitsInWord)
+			{
+				index -= bitsInWord;
+				continue;
+			}
+			for(; index > 0; index--)
+			{
+				word &= word - 1;		// clear lowest set bit
+			}
+			return static_cast<uint32_t>(wordIndex * 64 + std::countr_zero(word));
+		}
+		return NO_ID;
+	}
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Growable bitset indexed by dense shader id. Used for per shader flags (collected, marked), so membership tests are bit tests and walking
+	/// the members is a scan over 64 bit words.
+	/// </summary>
+	class ShaderIdBitset
+	{
+	public:
+		static constexpr uint32_t NO_ID = UINT32_MAX;
+
+		/// <summary>
+		/// Makes sure ids up to (but not including) amountIds can be stored. Never shrinks.
+		/// </summary>
+		void reserveIds(uint32_t amountIds);
+		void set(uint32_t id);
+		void reset(uint32_t id);
+		void clear();
+
+		bool test(uint32_t id) const
+		{
+			const size_t wordIndex = id >> 6;
+			return wordIndex < _words.size() && (_words[wordIndex] >> (id & 63)) & 1;
+		}
+
+		/// <summary>
+		/// Clears all ids which are set in other.
+		/// </summary>
+		void subtract(const ShaderIdBitset& other);
+		/// <summary>
+		/// Clears all ids which are >= firstIdToClear.
+		/// </summary>
+		void clearFrom(uint32_t firstIdToClear);
+
+		uint32_t count() const;
+		/// <summary>
+		/// Returns the number of ids set which are lower than the id specified.
+		/// </summary>
+		uint32_t rank(uint32_t id) const;
+		/// <summary>
+		/// Returns the lowest id set which is >= startId, or NO_ID. If mask is specified, only ids which are set in mask as well are considered.
+		/// </summary>
+		uint32_t findNext(uint32_t startId, const ShaderIdBitset* mask = nullptr) const;
+		/// <summary>
+		/// Returns the highest id set which is <= startId, or NO_ID. If mask is specified, only ids which are set in mask as well are considered.
+		/// </summary>
+		uint32_t findPrevious(uint32_t startId, const ShaderIdBitset* mask = nullptr) const;
+		/// <summary>
+		/// Returns the id at position index among the ids set, or NO_ID.
+		/// </summary>
+		uint32_t select(uint32_t index) const;
+
+	private:
+		uint64_t maskedWord(size_t wordIndex, const ShaderIdBitset* mask) const
+		{
+			const uint64_t word = _words[wordIndex];
+			if(nullptr == mask)
+			{
+				return word;
+			}
+			return wordIndex < mask->_words.size() ? word & mask->_words[wordIndex] : 0;
+		}
+
+		std::vector<uint64_t> _words;
+	};
+}
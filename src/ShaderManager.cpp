@@ -36,18 +36,63 @@ using namespace reshade::api;
 
 namespace ShaderToggler
 {
-	ShaderManager::ShaderManager(): _activeHuntedShaderHash(0)
+	ShaderManager::ShaderManager(): _publishedHuntingState(new HuntingState())
 	{
 	}
 
 
+	ShaderManager::~ShaderManager()
+	{
+		delete _publishedHuntingState.load();
+	}
+
+
+	uint32_t ShaderManager::internShaderHash(uint32_t shaderHash)
+	{
+		const auto [it, isNew] = _shaderHashToId.try_emplace(shaderHash, static_cast<uint32_t>(_shaderIdToHash.size()));
+		if(isNew)
+		{
+			_activityTracker.ensureCapacity(it->second);
+			_shaderIdToHash.push_back(shaderHash);
+			_pipelineCountPerShaderId.push_back(0);
+		}
+		return it->second;
+	}
+
+
+	void ShaderManager::internShaderHashes(std::span<const uint32_t> shaderHashes, std::vector<uint32_t>& shaderIds)
+	{
+		std::unique_lock lock(_hashHandlesMutex);
+		shaderIds.resize(shaderHashes.size());
+		for(size_t i = 0; i < shaderHashes.size(); i++)
+		{
+			shaderIds[i] = internShaderHash(shaderHashes[i]);
+		}
+	}
+
+
 	void ShaderManager::addHashHandlePair(uint32_t shaderHash, uint64_t pipelineHandle)
 	{
 		if(pipelineHandle>0 && shaderHash > 0)
 		{
 			std::unique_lock lock(_hashHandlesMutex);
-			_handleToShaderHash[pipelineHandle] = shaderHash;
-			_shaderHashes.emplace(shaderHash);
+			const uint32_t shaderId = internShaderHash(shaderHash);
+			PipelineShader& pipelineShader = _handleToPipelineShader[pipelineHandle];
+			if(pipelineShader.shaderId == shaderId)
+			{
+				return;
+			}
+			if(pipelineShader.shaderId != ShaderIdBitset::NO_ID && --_pipelineCountPerShaderId[pipelineShader.shaderId] == 0)
+			{
+				// handle was reused for another shader
+				_amountShadersWithPipelines--;
+			}
+			pipelineShader.shaderId = shaderId;
+			pipelineShader.shaderHash = shaderHash;
+			if(_pipelineCountPerShaderId[shaderId]++ == 0)
+			{
+				_amountShadersWithPipelines++;
+			}
 		}
 	}
 
@@ -55,64 +100,115 @@ namespace ShaderToggler
 	void ShaderManager::removeHandle(uint64_t handle)
 	{
 		std::unique_lock ulock(_hashHandlesMutex);
-		if(_handleToShaderHash.count(handle)==1)
+		const auto it = _handleToPipelineShader.find(handle);
+		if(it == _handleToPipelineShader.end())
 		{
-			const auto it = _handleToShaderHash.find(handle);
-			const auto shaderHash = it->second;
-			_handleToShaderHash.erase(handle);
-			_collectedActiveShaderHashes.erase(shaderHash);
-			_shaderHashes.erase(shaderHash);
+			return;
+		}
+		const uint32_t shaderId = it->second.shaderId;
+		_handleToPipelineShader.erase(it);
+		if(--_pipelineCountPerShaderId[shaderId] == 0)
+		{
+			// last pipeline using this shader is gone. The id stays reserved for the hash, so marks on it survive the shader being recreated.
+			_amountShadersWithPipelines--;
+			std::unique_lock lock(_collectedActiveHandlesMutex);
+			if(_collectedActiveShaderIds.test(shaderId))
+			{
+				_collectedActiveShaderIds.reset(shaderId);
+				_amountShadersCollected.fetch_sub(1, std::memory_order_relaxed);
+			}
 		}
 	}
 
 
-	void ShaderManager::startHuntingMode(const std::unordered_set<uint32_t> currentMarkedHashes)
+	void ShaderManager::startHuntingMode(std::span<const uint32_t> currentMarkedHashes)
 	{
-		// copy the currently marked hashes (from the active group) to the set of marked hashes.
+		// copy the currently marked hashes (from the active group) to the set of marked shaders. Hashes of shaders which haven't been created
+		// (yet) get an id as well, so they stay marked.
 		{
-			std::unique_lock lock(_markedShaderHashMutex);
-			_markedShaderHashes.clear();
-			for(const auto hash : currentMarkedHashes)
+			std::unique_lock hashLock(_hashHandlesMutex);
+			std::unique_lock lock(_markedShaderIdsMutex);
+			_markedShaderIds.clear();
+			for(const uint32_t shaderHash : currentMarkedHashes)
 			{
-				_markedShaderHashes.emplace(hash);
+				_markedShaderIds.set(internShaderHash(shaderHash));
 			}
 		}
 
 		// switch on hunting mode
 		_isInHuntingMode = true;
+		_isBisecting = false;
 		_activeHuntedShaderIndex = -1;
-		_activeHuntedShaderHash = 0;
+		_activeHuntedShaderId = ShaderIdBitset::NO_ID;
 		{
 			std::unique_lock lock(_collectedActiveHandlesMutex);
-			_collectedActiveShaderHashes.clear();			// clear it so we start with a clean slate
+			_collectedActiveShaderIds.clear();			// clear it so we start with a clean slate
+			_amountShadersCollected.store(0, std::memory_order_relaxed);
 		}
+		publishHuntingState(true);
 	}
 
 
 	void ShaderManager::stopHuntingMode()
 	{
 		_isInHuntingMode = false;
+		_isBisecting = false;
 		_activeHuntedShaderIndex = -1;
-		_activeHuntedShaderHash = 0;
+		_activeHuntedShaderId = ShaderIdBitset::NO_ID;
 		{
-			std::unique_lock lock(_markedShaderHashMutex);
-			_markedShaderHashes.clear();
+			std::unique_lock lock(_markedShaderIdsMutex);
+			_markedShaderIds.clear();
 		}
+		publishHuntingState(true);
+	}
+
+
+	void ShaderManager::toggleHideMarkedShaders()
+	{
+		_hideMarkedShaders = !_hideMarkedShaders;
+		publishHuntingState(false);
 	}
 
 
-	void ShaderManager::setActiveHuntedShaderHandle()
+	void ShaderManager::publishHuntingState(bool markedShadersChanged)
 	{
-		if(_activeHuntedShaderIndex<0 || _collectedActiveShaderHashes.size()<=0 || _activeHuntedShaderIndex >= _collectedActiveShaderHashes.size())
+		// only called from the present thread, so there's just one writer. Readers only ever see fully constructed states.
+		const HuntingState* previousState = _publishedHuntingState.load(std::memory_order_relaxed);
+		auto newState = new HuntingState();
+		newState->isInHuntingMode = _isInHuntingMode;
+		newState->hideMarkedShaders = _hideMarkedShaders;
+		newState->activeHuntedShaderId = _activeHuntedShaderId;
+		newState->ablatedShaderId = _ablatedShaderId;
+		if(_isBisecting)
 		{
-			_activeHuntedShaderHash = 0;
-			return;
+			newState->bisectionHiddenShaderIds = std::make_shared<const ShaderIdBitset>(_bisectionHiddenShaderIds);
+		}
+		if(markedShadersChanged || nullptr == previousState->markedShaderIds)
+		{
+			std::shared_lock lock(_markedShaderIdsMutex);
+			newState->markedShaderIds = std::make_shared<const ShaderIdBitset>(_markedShaderIds);
 		}
+		else
+		{
+			newState->markedShaderIds = previousState->markedShaderIds;
+		}
+		_publishedHuntingState.store(newState, std::memory_order_release);
+		_retiredHuntingStates.retire(previousState);
+	}
+
+
+	void ShaderManager::onFramePresented()
+	{
+		_retiredHuntingStates.collect();
+	}
 
-		// no lock needed, collecting phase is over
-		auto it = _collectedActiveShaderHashes.begin();
-		std::advance(it, _activeHuntedShaderIndex);
-		_activeHuntedShaderHash = *it;
+
+	void ShaderManager::setActiveHuntedShader(uint32_t shaderId)
+	{
+		_activeHuntedShaderId = shaderId;
+		// the index shown is the position of the shader among the collected shaders.
+		_activeHuntedShaderIndex = shaderId == ShaderIdBitset::NO_ID ? -1 : static_cast<int>(_collectedActiveShaderIds.rank(shaderId));
+		publishHuntingState(false);
 	}
 
 
@@ -122,60 +218,42 @@ namespace ShaderToggler
 		{
 			return;
 		}
-		if(_collectedActiveShaderHashes.size()<=0)
-		{
-			return;
-		}
+		std::shared_lock lock(_collectedActiveHandlesMutex);
+		const uint32_t startId = _activeHuntedShaderId == ShaderIdBitset::NO_ID ? 0 : _activeHuntedShaderId + 1;
 		if(ctrlPressed)
 		{
-			if(_markedShaderHashes.size()==0 || (_markedShaderHashes.size() == 1 && _markedShaderHashes.count(_activeHuntedShaderHash)==1))
+			std::shared_lock markedLock(_markedShaderIdsMutex);
+			const uint32_t amountMarked = _markedShaderIds.count();
+			if(amountMarked==0 || (amountMarked == 1 && _markedShaderIds.test(_activeHuntedShaderId)))
 			{
-				// optimization: if the current active shader is part of marked shader hashes and there is
+				// optimization: if the current active shader is part of marked shaders and there is
 				// just 1 marked, then we can also stop. We then don't need to do anything so we can return
 				// also if there are no marked shaders, we won't find a next, so return now too.
 				return;
 			}
 
-			// we have marked shaders, find the next one in collected active shader hashes that's part of this set.
-			auto it = _collectedActiveShaderHashes.begin();
-			int index = _activeHuntedShaderIndex + 1;
-			std::advance(it, index);
-			bool foundHash = false;
-			uint32_t hash = 0;
-			while(index!=_activeHuntedShaderIndex)
+			// we have marked shaders, find the next collected shader that's marked, wrapping around at the end.
+			uint32_t shaderId = _collectedActiveShaderIds.findNext(startId, &_markedShaderIds);
+			if(shaderId == ShaderIdBitset::NO_ID)
 			{
-				if(it == _collectedActiveShaderHashes.end())
-				{
-					it = _collectedActiveShaderHashes.begin();
-					index = 0;
-				}
-				hash = *it;
-				if(_markedShaderHashes.count(hash) == 1)
-				{
-					// found one
-					foundHash = true;
-					break;
-				}
-				++it;
-				index++;
+				shaderId = _collectedActiveShaderIds.findNext(0, &_markedShaderIds);
 			}
-			if(foundHash)
+			if(shaderId != ShaderIdBitset::NO_ID)
 			{
-				_activeHuntedShaderIndex = index;
-				_activeHuntedShaderHash = hash;
+				setActiveHuntedShader(shaderId);
 			}
 			// always done
 			return;
 		}
-		if(_activeHuntedShaderIndex < _collectedActiveShaderHashes.size() - 1)
+		uint32_t shaderId = _collectedActiveShaderIds.findNext(startId);
+		if(shaderId == ShaderIdBitset::NO_ID)
 		{
-			_activeHuntedShaderIndex++;
+			shaderId = _collectedActiveShaderIds.findNext(0);
 		}
-		else
+		if(shaderId != ShaderIdBitset::NO_ID)
 		{
-			_activeHuntedShaderIndex = 0;
+			setActiveHuntedShader(shaderId);
 		}
-		setActiveHuntedShaderHandle();
 	}
 
 
@@ -185,120 +263,254 @@ namespace ShaderToggler
 		{
 			return;
 		}
-		if(_collectedActiveShaderHashes.size()<=0)
-		{
-			return;
-		}
+		std::shared_lock lock(_collectedActiveHandlesMutex);
+		// with no shader hunted yet, or the first one, we wrap around to the last collected shader.
+		const bool wrapToLast = _activeHuntedShaderId == ShaderIdBitset::NO_ID || _activeHuntedShaderId == 0;
+		const uint32_t startId = wrapToLast ? ShaderIdBitset::NO_ID : _activeHuntedShaderId - 1;
 		if(ctrlPressed)
 		{
-			if(_markedShaderHashes.size() == 0 || (_markedShaderHashes.size() == 1 && _markedShaderHashes.count(_activeHuntedShaderHash) == 1))
+			std::shared_lock markedLock(_markedShaderIdsMutex);
+			const uint32_t amountMarked = _markedShaderIds.count();
+			if(amountMarked == 0 || (amountMarked == 1 && _markedShaderIds.test(_activeHuntedShaderId)))
 			{
-				// optimization: if the current active shader is part of marked shader hashes and there is
+				// optimization: if the current active shader is part of marked shaders and there is
 				// just 1 marked, then we can also stop. We then don't need to do anything so we can return
 				// also if there are no marked shaders, we won't find a next, so return now too.
 				return;
 			}
-			// we have marked shaders, find the next one in collected active shader hashes that's part of this set.
-			auto it = _collectedActiveShaderHashes.begin();
-			int index = _activeHuntedShaderIndex - 1;
-			std::advance(it, index);
-			bool foundHash = false;
-			uint32_t hash = 0;
-			while(index != _activeHuntedShaderIndex)
+			// we have marked shaders, find the previous collected shader that's marked, wrapping around at the start.
+			uint32_t shaderId = _collectedActiveShaderIds.findPrevious(startId, &_markedShaderIds);
+			if(shaderId == ShaderIdBitset::NO_ID)
 			{
-				if(it == _collectedActiveShaderHashes.begin())
-				{
-					it = _collectedActiveShaderHashes.end();
-					--it;
-					index = _collectedActiveShaderHashes.size() - 1;
-				}
-				hash = *it;
-				if(_markedShaderHashes.count(hash) == 1)
-				{
-					// found one
-					foundHash = true;
-					break;
-				}
-				--it;
-				index--;
+				shaderId = _collectedActiveShaderIds.findPrevious(ShaderIdBitset::NO_ID, &_markedShaderIds);
 			}
-			if(foundHash)
+			if(shaderId != ShaderIdBitset::NO_ID)
 			{
-				_activeHuntedShaderIndex = index;
-				_activeHuntedShaderHash = hash;
+				setActiveHuntedShader(shaderId);
 			}
 			// always done
 			return;
-
 		}
-		if(_activeHuntedShaderIndex <= 0)
+		uint32_t shaderId = _collectedActiveShaderIds.findPrevious(startId);
+		if(shaderId == ShaderIdBitset::NO_ID)
 		{
-			_activeHuntedShaderIndex = _collectedActiveShaderHashes.size() - 1;
+			shaderId = _collectedActiveShaderIds.findPrevious(ShaderIdBitset::NO_ID);
 		}
-		else
+		if(shaderId != ShaderIdBitset::NO_ID)
 		{
-			--_activeHuntedShaderIndex;
+			setActiveHuntedShader(shaderId);
 		}
-		setActiveHuntedShaderHandle();
 	}
 
 
-	bool ShaderManager::isBlockedShader(uint32_t shaderHash)
+	bool ShaderManager::isBlockedShader(uint32_t shaderId)
 	{
+		// plain acquire load: the state is immutable once published, so no lock is needed to get a consistent view.
+		const HuntingState* state = _publishedHuntingState.load(std::memory_order_acquire);
 		bool toReturn = false;
-		if(_isInHuntingMode)
+		if(state->isInHuntingMode)
 		{
-			// get the shader hash bound to this pipeline handle
-			toReturn |= shaderHash<=0 ? false : _activeHuntedShaderHash == shaderHash;
+			toReturn |= shaderId != ShaderIdBitset::NO_ID && state->activeHuntedShaderId == shaderId;
 		}
-		if(_hideMarkedShaders)
+		if(state->hideMarkedShaders)
 		{
-			// check if the shader hash is part of the toggle group
-			toReturn |= _markedShaderHashes.count(shaderHash)==1;
+			// check if the shader is part of the toggle group
+			toReturn |= state->markedShaderIds->test(shaderId);
+		}
+		toReturn |= shaderId != ShaderIdBitset::NO_ID && state->ablatedShaderId == shaderId;
+		if(nullptr != state->bisectionHiddenShaderIds)
+		{
+			toReturn |= state->bisectionHiddenShaderIds->test(shaderId);
 		}
 
 		return toReturn;
 	}
 
 
-	void ShaderManager::addActivePipelineHandle(uint64_t handle)
+	void ShaderManager::addActiveShader(uint32_t shaderId)
 	{
-		// get the shader hash bound to this pipeline handle
-		const auto shaderHash = getShaderHash(handle);
-		if(shaderHash>0)
+		if(shaderId == ShaderIdBitset::NO_ID)
 		{
-			std::unique_lock lock(_collectedActiveHandlesMutex);
-			_collectedActiveShaderHashes.emplace(shaderHash);
+			return;
+		}
+		{
+			// most binds are of shaders already collected, which only need the shared lock.
+			std::shared_lock lock(_collectedActiveHandlesMutex);
+			if(_collectedActiveShaderIds.test(shaderId))
+			{
+				return;
+			}
+		}
+		std::unique_lock lock(_collectedActiveHandlesMutex);
+		if(!_collectedActiveShaderIds.test(shaderId))
+		{
+			_collectedActiveShaderIds.set(shaderId);
+			_amountShadersCollected.fetch_add(1, std::memory_order_relaxed);
 		}
 	}
 
 
-	void ShaderManager::toggleMarkOnHuntedShader()
+	void ShaderManager::collectShadersSeenSince(uint32_t firstFrame)
+	{
+		const std::vector<PipelineShader> shadersSeen = getShadersSeenSince(firstFrame);
+		std::unique_lock lock(_collectedActiveHandlesMutex);
+		_collectedActiveShaderIds.clear();
+		for(const PipelineShader& shader : shadersSeen)
+		{
+			_collectedActiveShaderIds.set(shader.shaderId);
+		}
+		_amountShadersCollected.store(static_cast<uint32_t>(shadersSeen.size()), std::memory_order_relaxed);
+	}
+
+
+	std::vector<PipelineShader> ShaderManager::getShadersSeenSince(uint32_t firstFrame)
+	{
+		std::shared_lock lock(_hashHandlesMutex);
+		std::vector<PipelineShader> toReturn;
+		for(uint32_t shaderId = 0; shaderId < _pipelineCountPerShaderId.size(); shaderId++)
+		{
+			const uint32_t lastSeenFrame = _activityTracker.getLastSeenFrame(shaderId);
+			if(lastSeenFrame != 0 && lastSeenFrame >= firstFrame && _pipelineCountPerShaderId[shaderId] > 0)
+			{
+				toReturn.push_back({ shaderId, _shaderIdToHash[shaderId] });
+			}
+		}
+		return toReturn;
+	}
+
+
+	void ShaderManager::setAblatedShader(uint32_t shaderId)
+	{
+		if(_ablatedShaderId == shaderId)
+		{
+			return;
+		}
+		_ablatedShaderId = shaderId;
+		publishHuntingState(false);
+	}
+
+
+	void ShaderManager::toggleBisection()
+	{
+		if(!_isInHuntingMode)
+		{
+			return;
+		}
+		if(_isBisecting)
+		{
+			_isBisecting = false;
+			publishHuntingState(false);
+			return;
+		}
+		{
+			std::shared_lock lock(_collectedActiveHandlesMutex);
+			_bisectionCandidateIds = _collectedActiveShaderIds;
+		}
+		_bisectionCandidateCount = _bisectionCandidateIds.count();
+		if(_bisectionCandidateCount == 0)
+		{
+			return;
+		}
+		_isBisecting = true;
+		// the hunted shader is hidden as well, which would interfere with the answers.
+		_activeHuntedShaderId = ShaderIdBitset::NO_ID;
+		_activeHuntedShaderIndex = -1;
+		hideHalfOfBisectionCandidates();
+	}
+
+
+	void ShaderManager::answerBisection(bool targetGone)
 	{
-		if(_activeHuntedShaderHash<=0)
+		if(!_isBisecting)
 		{
 			return;
 		}
-		std::unique_lock lock(_markedShaderHashMutex);
-		if(_markedShaderHashes.count(_activeHuntedShaderHash)==1)
+		if(targetGone)
 		{
-			// remove it
-			_markedShaderHashes.erase(_activeHuntedShaderHash);
+			_bisectionCandidateIds = _bisectionHiddenShaderIds;
 		}
 		else
 		{
-			// add it
-			_markedShaderHashes.emplace(_activeHuntedShaderHash);
+			_bisectionCandidateIds.subtract(_bisectionHiddenShaderIds);
 		}
+		_bisectionCandidateCount = _bisectionCandidateIds.count();
+		if(_bisectionCandidateCount <= 1)
+		{
+			// found it (or the answers contradicted each other and nothing is left): make it the hunted shader so it can be marked.
+			_isBisecting = false;
+			const uint32_t foundShaderId = _bisectionCandidateIds.findNext(0);
+			std::shared_lock lock(_collectedActiveHandlesMutex);
+			setActiveHuntedShader(foundShaderId);
+			return;
+		}
+		hideHalfOfBisectionCandidates();
 	}
 
 
-	uint32_t ShaderManager::getShaderHash(uint64_t handle)
+	void ShaderManager::hideHalfOfBisectionCandidates()
+	{
+		// the candidates below the median id are hidden; there's always at least one candidate in each half.
+		_bisectionHiddenShaderIds = _bisectionCandidateIds;
+		_bisectionHiddenShaderIds.clearFrom(_bisectionCandidateIds.select(_bisectionCandidateCount / 2));
+		publishHuntingState(false);
+	}
+
+
+	void ShaderManager::toggleMarkOnHuntedShader()
 	{
-		if(_handleToShaderHash.count(handle)!=1)
+		if(_activeHuntedShaderId == ShaderIdBitset::NO_ID)
+		{
+			return;
+		}
+		{
+			std::unique_lock lock(_markedShaderIdsMutex);
+			if(_markedShaderIds.test(_activeHuntedShaderId))
+			{
+				// remove it
+				_markedShaderIds.reset(_activeHuntedShaderId);
+			}
+			else
+			{
+				// add it
+				_markedShaderIds.set(_activeHuntedShaderId);
+			}
+		}
+		publishHuntingState(true);
+	}
+
+
+	uint32_t ShaderManager::getActiveHuntedShaderHash()
+	{
+		if(_activeHuntedShaderId == ShaderIdBitset::NO_ID)
 		{
 			return 0;
 		}
-		return _handleToShaderHash.at(handle);
+		std::shared_lock lock(_hashHandlesMutex);
+		return _shaderIdToHash[_activeHuntedShaderId];
+	}
+
+
+	std::unordered_set<uint32_t> ShaderManager::getMarkedShaderHashes()
+	{
+		std::shared_lock hashLock(_hashHandlesMutex);
+		std::shared_lock lock(_markedShaderIdsMutex);
+		std::unordered_set<uint32_t> toReturn;
+		for(uint32_t shaderId = _markedShaderIds.findNext(0); shaderId != ShaderIdBitset::NO_ID; shaderId = _markedShaderIds.findNext(shaderId + 1))
+		{
+			toReturn.emplace(_shaderIdToHash[shaderId]);
+		}
+		return toReturn;
+	}
+
+
+	PipelineShader ShaderManager::getPipelineShader(uint64_t handle)
+	{
+		std::shared_lock lock(_hashHandlesMutex);
+		const auto it = _handleToPipelineShader.find(handle);
+		if(it == _handleToPipelineShader.end())
+		{
+			return PipelineShader();
+		}
+		return it->second;
 	}
 }
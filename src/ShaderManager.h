@@ -32,25 +32,62 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <reshade_api_device.hpp>
 #include <reshade_api_pipeline.hpp>
 #include <shared_mutex>
+#include <span>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "CDataFile.h"
+#include "ShaderActivityTracker.h"
+#include "RetireQueue.h"
+#include "ShaderIdBitset.h"
 #include "ToggleGroup.h"
 
 
 namespace ShaderToggler
 {
 	/// <summary>
-	/// Class which manages a set of shaders for a given type (pixel, vertex...)
+	/// Immutable snapshot of the hunting state of a shader manager, as read by the draw call hooks. A new snapshot is published every time the
+	/// hunting state changes, so the draw path always sees a consistent view without having to lock.
+	/// </summary>
+	struct HuntingState
+	{
+		bool isInHuntingMode = false;
+		bool hideMarkedShaders = false;
+		uint32_t activeHuntedShaderId = ShaderIdBitset::NO_ID;
+		uint32_t ablatedShaderId = ShaderIdBitset::NO_ID;		// shader blocked by the ablation profiler, regardless of hunting mode.
+		std::shared_ptr<const ShaderIdBitset> markedShaderIds;
+		std::shared_ptr<const ShaderIdBitset> bisectionHiddenShaderIds;	// set while bisecting: the half of the candidates which is hidden.
+	};
+
+
+	/// <summary>
+	/// The shader bound to a pipeline handle: its dense id within the shader manager and its hash.
+	/// </summary>
+	struct PipelineShader
+	{
+		uint32_t shaderId = ShaderIdBitset::NO_ID;
+		uint32_t shaderHash = 0;
+	};
+
+
+	/// <summary>
+	/// Class which manages a set of shaders for a given type (pixel, vertex...). Shader hashes are interned to dense ids when they're first seen,
+	/// and per shader state (collected, marked, pipeline count) is kept in arrays and bitsets indexed by that id. Ids are never reused, so
+	/// an id stays valid for the lifetime of the shader manager.
 	/// </summary>
 	class ShaderManager
 	{
 	public:
 		ShaderManager();
+		~ShaderManager();
 
 		void addHashHandlePair(uint32_t shaderHash, uint64_t pipelineHandle);
 		void removeHandle(uint64_t handle);
@@ -59,9 +96,13 @@ namespace ShaderToggler
 		///	where the user can step through collected active shaders to mark them for assignment to the current edited group.
 		/// </summary>
 		/// <param name="currentMarkedHashes"></param>
-		void startHuntingMode(const std::unordered_set<uint32_t> currentMarkedHashes);
+		void startHuntingMode(std::span<const uint32_t> currentMarkedHashes);
 		void stopHuntingMode();
 		/// <summary>
+		/// Frees the replaced hunting states which no draw call can still be reading. Called on the present thread, once per frame.
+		/// </summary>
+		void onFramePresented();
+		/// <summary>
 		/// Moves to the next shader. If control is pressed as well, it'll step to the next marked shader (if any). If there aren't any shaders in that
 		///	situation, it'll stay on the current shader.
 		/// </summary>
@@ -76,67 +117,153 @@ namespace ShaderToggler
 		///	situation, it'll stay on the current shader.</param>
 		void huntPreviousShader(bool ctrlPressed);
 		/// <summary>
-		/// Returns true if the shader hash passed in is the currently hunted shader or it's part of the marked shader hashes
+		/// Returns true if the shader id passed in is the currently hunted shader or it's part of the marked shaders. Called from the draw
+		/// call hooks, so it only reads the last published hunting state and never locks. Has to be called inside a ReaderEpochs::ReadSection.
 		/// </summary>
-		/// <param name="shaderHash"></param>
+		/// <param name="shaderId"></param>
+		/// <returns></returns>
+		bool isBlockedShader(uint32_t shaderId);
+		/// <summary>
+		/// Returns the shader id and hash for the passed in pipeline handle, if found. An id of ShaderIdBitset::NO_ID and a hash of 0 otherwise.
+		/// Called when a pipeline is bound; the draw call hooks use the result cached with the command list.
+		/// </summary>
+		/// <param name="handle"></param>
 		/// <returns></returns>
-		bool isBlockedShader(uint32_t shaderHash);
+		PipelineShader getPipelineShader(uint64_t handle);
+		/// <summary>
+		/// Returns the ids of the shader hashes passed in, in the same order. Hashes which haven't been seen yet get their id now, so a group's
+		/// shaders have an id before the game creates pipelines with them, and a shader which gets its id later on isn't in any group known now.
+		/// </summary>
+		/// <param name="shaderHashes"></param>
+		/// <param name="shaderIds"></param>
+		void internShaderHashes(std::span<const uint32_t> shaderHashes, std::vector<uint32_t>& shaderIds);
 		/// <summary>
 		/// Returns the shader hash for the passed in pipeline handle, if found. 0 otherwise.
 		/// </summary>
 		/// <param name="handle"></param>
 		/// <returns></returns>
-		uint32_t getShaderHash(uint64_t handle);
-		void addActivePipelineHandle(uint64_t handle);
+		uint32_t getShaderHash(uint64_t handle) { return getPipelineShader(handle).shaderHash; }
+		/// <summary>
+		/// Adds the shader with the id passed in to the shaders collected during the collection phase.
+		/// </summary>
+		/// <param name="shaderId"></param>
+		void addActiveShader(uint32_t shaderId);
+		/// <summary>
+		/// Records that the shader with the id specified has been bound in the frame specified, for collectShadersSeenSince. Lock free, meant
+		/// to be called on every pipeline bind.
+		/// </summary>
+		void markShaderSeen(uint32_t shaderId, uint32_t frame) { _activityTracker.markSeen(shaderId, frame); }
+		/// <summary>
+		/// Replaces the collected active shaders with the shaders which still have a pipeline and have been marked as seen in firstFrame or
+		/// later. Used instead of a collection phase when hunting starts.
+		/// </summary>
+		/// <param name="firstFrame"></param>
+		void collectShadersSeenSince(uint32_t firstFrame);
+		/// <summary>
+		/// Returns the shaders which still have a pipeline and have been marked as seen in firstFrame or later, in id order.
+		/// </summary>
+		/// <param name="firstFrame"></param>
+		std::vector<PipelineShader> getShadersSeenSince(uint32_t firstFrame);
+		/// <summary>
+		/// Blocks the shader with the id specified in all draw calls, for the ablation profiler. ShaderIdBitset::NO_ID unblocks it again.
+		/// </summary>
+		/// <param name="shaderId"></param>
+		void setAblatedShader(uint32_t shaderId);
 		void toggleMarkOnHuntedShader();
+		/// <summary>
+		/// Starts bisecting the collected active shaders: half of the candidates is hidden, and the user tells with answerBisection whether the
+		/// element looked for disappeared, after which the search continues in the half which has to contain it. Finds one shader out of n in
+		/// about log2(n) answers. If bisection is already running, it's stopped instead.
+		/// </summary>
+		void toggleBisection();
+		/// <summary>
+		/// Narrows the candidates down to the hidden half if targetGone is true, or to the visible half otherwise. When one candidate remains,
+		/// bisection ends and that shader becomes the hunted shader, so it can be marked.
+		/// </summary>
+		/// <param name="targetGone"></param>
+		void answerBisection(bool targetGone);
+		bool isBisecting() { return _isBisecting; }
+		uint32_t getBisectionCandidateCount() { return _bisectionCandidateCount; }
 
-		uint32_t getPipelineCount() {return _handleToShaderHash.size();}
-		uint32_t getShaderCount() { return _shaderHashes.size();}
-		uint32_t getAmountShaderHashesCollected() { return _collectedActiveShaderHashes.size(); }
+		uint32_t getPipelineCount() {return _handleToPipelineShader.size();}
+		uint32_t getShaderCount() { return _amountShadersWithPipelines;}
+		uint32_t getAmountShaderHashesCollected() { return _amountShadersCollected.load(std::memory_order_relaxed); }
+		size_t getAmountRetiredHuntingStates() const { return _retiredHuntingStates.size(); }
 		bool isInHuntingMode() { return _isInHuntingMode;}
-		uint32_t getActiveHuntedShaderHash() { return _activeHuntedShaderHash;}
+		uint32_t getActiveHuntedShaderHash();
 		int getActiveHuntedShaderIndex() { return _activeHuntedShaderIndex; }
-		void toggleHideMarkedShaders() { _hideMarkedShaders=!_hideMarkedShaders;}
+		void toggleHideMarkedShaders();
 
 		bool isHuntedShaderMarked()
 		{
-			std::shared_lock lock(_markedShaderHashMutex);
-			return _markedShaderHashes.count(_activeHuntedShaderHash)==1;
+			std::shared_lock lock(_markedShaderIdsMutex);
+			return _markedShaderIds.test(_activeHuntedShaderId);
 		}
 
-		std::unordered_set<uint32_t> getMarkedShaderHashes()
-		{
-			std::shared_lock lock(_markedShaderHashMutex);
-			return _markedShaderHashes;
-		}
+		std::unordered_set<uint32_t> getMarkedShaderHashes();
 
 		uint32_t getMarkedShaderCount()
 		{
-			std::shared_lock lock(_markedShaderHashMutex);
-			return _markedShaderHashes.size();
+			std::shared_lock lock(_markedShaderIdsMutex);
+			return _markedShaderIds.count();
 		}
 
 		bool isKnownHandle(uint64_t pipelineHandle)
 		{
 			std::shared_lock lock(_hashHandlesMutex);
-			return _handleToShaderHash.count(pipelineHandle)==1;
+			return _handleToPipelineShader.count(pipelineHandle)==1;
 		}
 		
 	private:
-		void setActiveHuntedShaderHandle();
+		/// <summary>
+		/// Returns the id for the shader hash passed in, assigning the next free id if the hash hasn't been seen before. The caller has to hold
+		/// _hashHandlesMutex exclusively.
+		/// </summary>
+		/// <param name="shaderHash"></param>
+		/// <returns></returns>
+		uint32_t internShaderHash(uint32_t shaderHash);
+		/// <summary>
+		/// Makes the shader with the id passed in the hunted shader, or clears the hunted shader if the id is ShaderIdBitset::NO_ID.
+		/// </summary>
+		/// <param name="shaderId"></param>
+		void setActiveHuntedShader(uint32_t shaderId);
+		/// <summary>
+		/// Hides the lower half of the current bisection candidates and publishes that.
+		/// </summary>
+		void hideHalfOfBisectionCandidates();
+		/// <summary>
+		/// Publishes the current hunting state to the draw path. Has to be called after every change to the hunting mode, the hunted shader, the
+		/// marked shaders or the hide marked shaders flag. If markedShadersChanged is true, a new snapshot of the marked shader hashes is made,
+		/// otherwise the previous one is shared.
+		/// </summary>
+		/// <param name="markedShadersChanged"></param>
+		void publishHuntingState(bool markedShadersChanged);
 
-		std::unordered_set<uint32_t> _shaderHashes;				// all shader hashes added through init pipeline
-		std::map<uint64_t, uint32_t> _handleToShaderHash;		// pipeline handle per shader hash. Handle is removed when a pipeline is destroyed.
-		std::unordered_set<uint32_t> _collectedActiveShaderHashes;	// shader hashes bound to pipeline handles which were collected during the collection phase after hunting was enabled, which are the pipeline handles active during the last X frames
-		std::unordered_set<uint32_t> _markedShaderHashes;		// the hashes for shaders which are currently marked.
+		std::unordered_map<uint32_t, uint32_t> _shaderHashToId;	// all shader hashes ever seen, with their id.
+		std::vector<uint32_t> _shaderIdToHash;					// shader hash per shader id.
+		std::vector<uint32_t> _pipelineCountPerShaderId;		// number of live pipeline handles per shader id.
+		uint32_t _amountShadersWithPipelines = 0;				// number of shader ids with a pipeline count > 0.
+		std::map<uint64_t, PipelineShader> _handleToPipelineShader;	// shader per pipeline handle. Handle is removed when a pipeline is destroyed.
+		ShaderIdBitset _collectedActiveShaderIds;				// shaders bound to pipeline handles which were collected during the collection phase after hunting was enabled, which are the pipeline handles active during the last X frames
+		std::atomic<uint32_t> _amountShadersCollected = 0;		// number of ids set in _collectedActiveShaderIds.
+		ShaderActivityTracker _activityTracker;					// last frame each shader was bound in, if tracking is enabled.
+		ShaderIdBitset _markedShaderIds;						// the shaders which are currently marked.
 
 		bool _isInHuntingMode = false;
 		int _activeHuntedShaderIndex = -1;
-		uint32_t _activeHuntedShaderHash;
+		uint32_t _activeHuntedShaderId = ShaderIdBitset::NO_ID;
 		std::shared_mutex _collectedActiveHandlesMutex;
 		std::shared_mutex _hashHandlesMutex;
-		std::shared_mutex _markedShaderHashMutex;
+		std::shared_mutex _markedShaderIdsMutex;
 		bool _hideMarkedShaders = false;
+		uint32_t _ablatedShaderId = ShaderIdBitset::NO_ID;
+		bool _isBisecting = false;
+		uint32_t _bisectionCandidateCount = 0;
+		ShaderIdBitset _bisectionCandidateIds;					// the shaders which can still be the one looked for. Only used on the present thread.
+		ShaderIdBitset _bisectionHiddenShaderIds;				// the half of the candidates which is currently hidden.
+
+		std::atomic<const HuntingState*> _publishedHuntingState;				// the hunting state as read by the draw call hooks. Only replaced, never mutated.
+		RetireQueue<HuntingState> _retiredHuntingStates;						// previously published states, kept alive as draw calls might still read them.
 	};
 }
 
@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "Statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace ShaderToggler
+{
+	double studentTQuantile95(uint32_t degreesOfFreedom)
+	{
+		static const double quantiles[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+											2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086 };
+		if(degreesOfFreedom == 0)
+		{
+			return 0.0;
+		}
+		if(degreesOfFreedom <= std::size(quantiles))
+		{
+			return quantiles[degreesOfFreedom - 1];
+		}
+		// Cornish-Fisher expansion around the normal quantile, so the quantile keeps decreasing smoothly towards 1.96 instead of dropping to
+		// it after the table. The first two terms are within 0.001 of the exact value from 21 degrees of freedom on.
+		const double z = 1.959964;
+		const double df = static_cast<double>(degreesOfFreedom);
+		const double z3 = z * z * z;
+		const double z5 = z3 * z * z;
+		return z + (z3 + z) / (4.0 * df) + (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * df * df);
+	}
+
+
+	double median(std::vector<double>& values)
+	{
+		if(values.empty())
+		{
+			return 0.0;
+		}
+		const auto middle = values.begin() + values.size() / 2;
+		std::nth_element(values.begin(), middle, values.end());
+		return *middle;
+	}
+
+
+	MeanWithInterval meanWithInterval(const std::vector<double>& values)
+	{
+		MeanWithInterval toReturn;
+		if(values.empty())
+		{
+			return toReturn;
+		}
+		double sum = 0.0;
+		for(const double value : values)
+		{
+			sum += value;
+		}
+		toReturn.mean = sum / values.size();
+		if(values.size() > 1)
+		{
+			double sumOfSquares = 0.0;
+			for(const double value : values)
+			{
+				sumOfSquares += (value - toReturn.mean) * (value - toReturn.mean);
+			}
+			const double standardDeviation = std::sqrt(sumOfSquares / (values.size() - 1));
+			toReturn.confidenceInterval95 = studentTQuantile95(static_cast<uint32_t>(values.size() - 1)) * standardDeviation / std::sqrt(static_cast<double>(values.size()));
+		}
+		return toReturn;
+	}
+}
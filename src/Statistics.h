@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Mean of a set of measurements with the half width of its 95% confidence interval.
+	/// </summary>
+	struct MeanWithInterval
+	{
+		double mean = 0.0;
+		double confidenceInterval95 = 0.0;		// 0 with fewer than 2 values.
+
+		/// <summary>
+		/// Returns true if the interval doesn't contain 0, i.e. the mean differs from 0 with 95% confidence.
+		/// </summary>
+		bool isSignificant() const { return confidenceInterval95 > 0.0 && (mean > confidenceInterval95 || mean < -confidenceInterval95); }
+	};
+
+	/// <summary>
+	/// Returns the two sided 95% quantile of Student's t-distribution for the degrees of freedom specified. Exact (to 3 decimals) up to 20
+	/// degrees of freedom, within 0.001 of the exact value above that.
+	/// </summary>
+	double studentTQuantile95(uint32_t degreesOfFreedom);
+	/// <summary>
+	/// Returns the median of the values specified, 0 if there are none. Reorders the values.
+	/// </summary>
+	double median(std::vector<double>& values);
+	/// <summary>
+	/// Returns the mean of the values specified, with a confidence interval using Student's t-distribution.
+	/// </summary>
+	MeanWithInterval meanWithInterval(const std::vector<double>& values);
+}
@@ -0,0 +1,223 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+
+#include "SubmissionCostProfiler.h"
+
+#include <algorithm>
+
+namespace ShaderToggler
+{
+	// the calling thread's shard, and the profiler it belongs to.
+	static thread_local void* t_shard = nullptr;
+	static thread_local const SubmissionCostProfiler* t_shardOwner = nullptr;
+
+
+	void SubmissionCostProfiler::start()
+	{
+		{
+			std::lock_guard lock(_shardsMutex);
+			for(auto& shard : _shards)
+			{
+				std::lock_guard shardLock(shard->mutex);
+				for(auto& counters : shard->countersPerStage)
+				{
+					counters.clear();
+				}
+				shard->lastEventFrame = 0;
+			}
+		}
+		for(auto& counters : _totals)
+		{
+			counters.clear();
+		}
+		_framesProfiled = 0;
+		_isRunning = true;
+	}
+
+
+	void SubmissionCostProfiler::stop()
+	{
+		_isRunning = false;
+	}
+
+
+	void SubmissionCostProfiler::onBind(const BoundShaders& previouslyBound, const BoundShaders& newlyBound, uint32_t frame)
+	{
+		Shard& shard = getShard();
+		std::lock_guard lock(shard.mutex);
+		attributeTime(shard, previouslyBound, takeElapsedNs(shard, frame));
+		bool isRedundantBind = true;
+		for(uint32_t stage = 0; stage < ShaderStageCount; stage++)
+		{
+			isRedundantBind &= previouslyBound[stage].shaderId == newlyBound[stage].shaderId;
+		}
+		for(uint32_t stage = 0; stage < ShaderStageCount; stage++)
+		{
+			if(isRedundantBind || previouslyBound[stage].shaderId != newlyBound[stage].shaderId)
+			{
+				ShaderCounters* counters = getCounters(shard.countersPerStage, stage, newlyBound[stage]);
+				if(nullptr != counters)
+				{
+					counters->counters.binds++;
+				}
+			}
+		}
+	}
+
+
+	void SubmissionCostProfiler::onDraw(const BoundShaders& bound, uint32_t frame)
+	{
+		Shard& shard = getShard();
+		std::lock_guard lock(shard.mutex);
+		const uint64_t elapsedNs = takeElapsedNs(shard, frame);
+		for(uint32_t stage = 0; stage < ShaderStageCount; stage++)
+		{
+			ShaderCounters* counters = getCounters(shard.countersPerStage, stage, bound[stage]);
+			if(nullptr != counters)
+			{
+				counters->counters.draws++;
+				counters->counters.timeNs += elapsedNs;
+			}
+		}
+	}
+
+
+	void SubmissionCostProfiler::onFramePresented()
+	{
+		if(!isRunning())
+		{
+			return;
+		}
+		std::lock_guard lock(_shardsMutex);
+		for(auto& shard : _shards)
+		{
+			std::lock_guard shardLock(shard->mutex);
+			for(uint32_t stage = 0; stage < ShaderStageCount; stage++)
+			{
+				std::vector<ShaderCounters>& shardCounters = shard->countersPerStage[stage];
+				std::vector<ShaderCounters>& totals = _totals[stage];
+				if(totals.size() < shardCounters.size())
+				{
+					totals.resize(shardCounters.size());
+				}
+				for(size_t shaderId = 0; shaderId < shardCounters.size(); shaderId++)
+				{
+					ShaderCounters& counters = shardCounters[shaderId];
+					if(counters.counters.draws == 0 && counters.counters.binds == 0 && counters.counters.timeNs == 0)
+					{
+						continue;
+					}
+					totals[shaderId].shaderHash = counters.shaderHash;
+					totals[shaderId].counters.draws += counters.counters.draws;
+					totals[shaderId].counters.binds += counters.counters.binds;
+					totals[shaderId].counters.timeNs += counters.counters.timeNs;
+					counters.counters = Counters();
+				}
+			}
+		}
+		_framesProfiled++;
+	}
+
+
+	std::vector<SubmissionCostProfiler::Result> SubmissionCostProfiler::getTopShaders(size_t amount) const
+	{
+		std::vector<Result> results;
+		for(uint32_t stage = 0; stage < ShaderStageCount; stage++)
+		{
+			for(const ShaderCounters& counters : _totals[stage])
+			{
+				if(counters.counters.draws > 0 || counters.counters.binds > 0)
+				{
+					results.push_back({ static_cast<ShaderStage>(stage), counters.shaderHash, counters.counters });
+				}
+			}
+		}
+		const size_t amountToReturn = std::min(amount, results.size());
+		std::partial_sort(results.begin(), results.begin() + amountToReturn, results.end(), [](const Result& a, const Result& b) { return a.totals.timeNs > b.totals.timeNs; });
+		results.resize(amountToReturn);
+		return results;
+	}
+
+
+	SubmissionCostProfiler::Shard& SubmissionCostProfiler::getShard()
+	{
+		if(t_shardOwner != this)
+		{
+			// shards are never removed while the profiler lives, so the pointer stays valid for the thread.
+			std::lock_guard lock(_shardsMutex);
+			_shards.push_back(std::make_unique<Shard>());
+			t_shard = _shards.back().get();
+			t_shardOwner = this;
+		}
+		return *static_cast<Shard*>(t_shard);
+	}
+
+
+	SubmissionCostProfiler::ShaderCounters* SubmissionCostProfiler::getCounters(CountersPerStage& countersPerStage, uint32_t stage, const PipelineShader& shader)
+	{
+		if(shader.shaderId == ShaderIdBitset::NO_ID)
+		{
+			return nullptr;
+		}
+		std::vector<ShaderCounters>& counters = countersPerStage[stage];
+		if(counters.size() <= shader.shaderId)
+		{
+			counters.resize(static_cast<size_t>(shader.shaderId) + 1);
+		}
+		ShaderCounters& shaderCounters = counters[shader.shaderId];
+		shaderCounters.shaderHash = shader.shaderHash;
+		return &shaderCounters;
+	}
+
+
+	uint64_t SubmissionCostProfiler::takeElapsedNs(Shard& shard, uint32_t frame)
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const uint64_t elapsedNs = shard.lastEventFrame == frame ? std::chrono::duration_cast<std::chrono::nanoseconds>(now - shard.lastEventTime).count() : 0;
+		shard.lastEventTime = now;
+		shard.lastEventFrame = frame;
+		return elapsedNs;
+	}
+
+
+	void SubmissionCostProfiler::attributeTime(Shard& shard, const BoundShaders& bound, uint64_t elapsedNs)
+	{
+		for(uint32_t stage = 0; stage < ShaderStageCount; stage++)
+		{
+			ShaderCounters* counters = getCounters(shard.countersPerStage, stage, bound[stage]);
+			if(nullptr != counters)
+			{
+				counters->counters.timeNs += elapsedNs;
+			}
+		}
+	}
+}
@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ShaderManager.h"
+
+namespace ShaderToggler
+{
+	/// <summary>
+	/// Measures, per shader, the CPU side work it drives: the draws done and pipeline binds made with it, and the time between consecutive
+	/// bind and draw events on a thread while it was bound. Each recording thread counts into its own shard, guarded by a mutex that's only
+	/// contended while the shards are aggregated at present, so the hooks don't share counters between threads.
+	/// </summary>
+	class SubmissionCostProfiler
+	{
+	public:
+		enum ShaderStage : uint32_t
+		{
+			PixelShaderStage = 0,
+			VertexShaderStage,
+			ComputeShaderStage,
+			ShaderStageCount
+		};
+
+		typedef std::array<PipelineShader, ShaderStageCount> BoundShaders;
+
+		struct Counters
+		{
+			uint64_t draws = 0;
+			uint64_t binds = 0;
+			uint64_t timeNs = 0;		// time between the events while the shader was bound
+		};
+
+		struct Result
+		{
+			ShaderStage stage = PixelShaderStage;
+			uint32_t shaderHash = 0;
+			Counters totals;
+		};
+
+		/// <summary>
+		/// Starts profiling. Counts of a previous run are discarded.
+		/// </summary>
+		void start();
+		void stop();
+		bool isRunning() const { return _isRunning.load(std::memory_order_relaxed); }
+		/// <summary>
+		/// Called from the pipeline bind hook with the shaders bound before and after the bind. The time since the thread's last event is
+		/// attributed to the shaders bound before. The bind is counted for the shaders that changed, or for all of them if none changed.
+		/// </summary>
+		/// <param name="previouslyBound"></param>
+		/// <param name="newlyBound"></param>
+		/// <param name="frame">the current frame number; time between events in different frames isn't attributed</param>
+		void onBind(const BoundShaders& previouslyBound, const BoundShaders& newlyBound, uint32_t frame);
+		/// <summary>
+		/// Called from the draw hooks with the shaders bound. The time since the thread's last event is attributed to these shaders as well.
+		/// </summary>
+		void onDraw(const BoundShaders& bound, uint32_t frame);
+		/// <summary>
+		/// Called at every present: adds the counts in the shards to the totals.
+		/// </summary>
+		void onFramePresented();
+
+		uint32_t getFramesProfiled() const { return _framesProfiled; }
+		/// <summary>
+		/// Returns the shaders with the most time attributed to them, most first. Only valid on the present thread.
+		/// </summary>
+		/// <param name="amount">the maximum number of shaders to return</param>
+		std::vector<Result> getTopShaders(size_t amount) const;
+
+	private:
+		struct ShaderCounters
+		{
+			uint32_t shaderHash = 0;
+			Counters counters;
+		};
+
+		typedef std::array<std::vector<ShaderCounters>, ShaderStageCount> CountersPerStage;
+
+		struct Shard
+		{
+			std::mutex mutex;
+			CountersPerStage countersPerStage;		// per stage, indexed by shader id
+			std::chrono::steady_clock::time_point lastEventTime;
+			uint32_t lastEventFrame = 0;
+		};
+
+		/// <summary>
+		/// Returns the shard of the calling thread, creating it the first time the thread calls it.
+		/// </summary>
+		Shard& getShard();
+		static ShaderCounters* getCounters(CountersPerStage& countersPerStage, uint32_t stage, const PipelineShader& shader);
+		/// <summary>
+		/// Returns the nanoseconds since the shard's last event in the same frame, 0 if the last event was in another frame, and makes the
+		/// current event the last one.
+		/// </summary>
+		static uint64_t takeElapsedNs(Shard& shard, uint32_t frame);
+		static void attributeTime(Shard& shard, const BoundShaders& bound, uint64_t elapsedNs);
+
+		std::atomic_bool _isRunning = false;
+		std::mutex _shardsMutex;
+		std::vector<std::unique_ptr<Shard>> _shards;
+		CountersPerStage _totals;
+		uint32_t _framesProfiled = 0;
+	};
+}
@@ -32,19 +32,27 @@
 
 #include "stdafx.h"
 #include "ToggleGroup.h"
+#include "CompiledProfile.h"
+#include "HashListCodec.h"
 #include "KeyData.h"
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <vector>
+
 namespace ShaderToggler
 {
-	ToggleGroup::ToggleGroup(std::string name, int id): _id(id), _isActive(false), _isEditing(false), _isActiveAtStartup(false)
+	ToggleGroup::ToggleGroup(std::string name, int id): _id(id), _isActive(false), _isEditing(false), _isActiveAtStartup(false), _isPerformanceGroup(false), _performancePriority(0),
+		_throttleMode(DrawThrottleMode::HideAll), _throttleValue(2), _throttleSlot(DrawThrottleCounters::NO_SLOT)
 	{
-		_name = name.size() > 0 ? name : "Default";
+		_name = name.size() > 0 ? std::move(name) : "Default";
 	}
 
 
 	int ToggleGroup::getNewGroupId()
 	{
-		static atomic_int s_groupId = 0;
+		static std::atomic_int s_groupId = 0;
 
 		++s_groupId;
 		return s_groupId;
@@ -66,48 +74,45 @@ namespace ShaderToggler
 	}
 
 
-	void ToggleGroup::storeCollectedHashes(const std::unordered_set<uint32_t> pixelShaderHashes, const std::unordered_set<uint32_t> vertexShaderHashes, const std::unordered_set<uint32_t> computeShaderHashes)
-	{
-		clearHashes();
-
-		for(const auto hash : vertexShaderHashes)
-		{
-			_vertexShaderHashes.emplace(hash);
-		}
-		for(const auto hash : pixelShaderHashes)
-		{
-			_pixelShaderHashes.emplace(hash);
-		}
-		for(const auto hash : computeShaderHashes)
-		{
-			_computeShaderHashes.emplace(hash);
-		}
-	}
-
-
-	bool ToggleGroup::isBlockedPixelShader(uint32_t shaderHash)
+	void ToggleGroup::storeCollectedHashes(const std::unordered_set<uint32_t>& pixelShaderHashes, const std::unordered_set<uint32_t>& vertexShaderHashes, const std::unordered_set<uint32_t>& computeShaderHashes)
 	{
-		return _isActive && (_pixelShaderHashes.count(shaderHash)==1);
+		_vertexShaderHashes.assign(vertexShaderHashes);
+		_pixelShaderHashes.assign(pixelShaderHashes);
+		_computeShaderHashes.assign(computeShaderHashes);
+		_loadError.clear();
 	}
 
 
-	bool ToggleGroup::isBlockedVertexShader(uint32_t shaderHash)
+	void ToggleGroup::clearHashes()
 	{
-		return _isActive && (_vertexShaderHashes.count(shaderHash) == 1);
+		_pixelShaderHashes.clear();
+		_vertexShaderHashes.clear();
+		_computeShaderHashes.clear();
 	}
 
 
-	bool ToggleGroup::isBlockedComputeShader(uint32_t shaderHash)
+	bool ToggleGroup::hasSameDefinition(const ToggleGroup& other) const
 	{
-		return _isActive && (_computeShaderHashes.count(shaderHash) == 1);
+		return _name == other._name && _keyData.getKeyForIniFile() == other._keyData.getKeyForIniFile() && _isActiveAtStartup == other._isActiveAtStartup &&
+			   _isPerformanceGroup == other._isPerformanceGroup && _performancePriority == other._performancePriority &&
+			   _throttleMode == other._throttleMode && _throttleValue == other._throttleValue && _loadError == other._loadError &&
+			   _pixelShaderHashes == other._pixelShaderHashes && _vertexShaderHashes == other._vertexShaderHashes && _computeShaderHashes == other._computeShaderHashes;
 	}
 
 
-	void ToggleGroup::clearHashes()
+	void ToggleGroup::applyDefinition(ToggleGroup&& other)
 	{
-		_pixelShaderHashes.clear();
-		_vertexShaderHashes.clear();
-		_computeShaderHashes.clear();
+		_name = std::move(other._name);
+		_keyData = other._keyData;
+		_isActiveAtStartup = other._isActiveAtStartup;
+		_isPerformanceGroup = other._isPerformanceGroup;
+		_performancePriority = other._performancePriority;
+		_throttleMode = other._throttleMode;
+		_throttleValue = other._throttleValue;
+		_pixelShaderHashes = std::move(other._pixelShaderHashes);
+		_vertexShaderHashes = std::move(other._vertexShaderHashes);
+		_computeShaderHashes = std::move(other._computeShaderHashes);
+		_loadError = std::move(other._loadError);
 	}
 
 
@@ -117,118 +122,123 @@ namespace ShaderToggler
 		{
 			return;
 		}
-		_name = newName;
+		_name = std::move(newName);
 	}
 
 
-	void ToggleGroup::saveState(CDataFile& iniFile, int groupCounter) const
+	void ToggleGroup::saveState(IniFileWriter& iniFile, int groupCounter, bool deltaEncodeHashes) const
 	{
+		// v2 layout: per shader stage a section with all hashes as one sorted list, then the group's own section.
 		const std::string sectionRoot = "Group" + std::to_string(groupCounter);
 		const std::string vertexHashesCategory = sectionRoot + "_VertexShaders";
 		const std::string pixelHashesCategory = sectionRoot + "_PixelShaders";
 		const std::string computeHashesCategory = sectionRoot + "_ComputeShaders";
 
-		int counter = 0;
-		for(const auto hash: _vertexShaderHashes)
-		{
-			iniFile.SetUInt("ShaderHash" + std::to_string(counter), hash, "", vertexHashesCategory);
-			counter++;
-		}
-		iniFile.SetUInt("AmountHashes", counter, "", vertexHashesCategory);
+		writeHashes(iniFile, vertexHashesCategory, _vertexShaderHashes, deltaEncodeHashes);
+		writeHashes(iniFile, pixelHashesCategory, _pixelShaderHashes, deltaEncodeHashes);
+		writeHashes(iniFile, computeHashesCategory, _computeShaderHashes, deltaEncodeHashes);
+
+		iniFile.writeSection(sectionRoot);
+		iniFile.writeValue("Name", _name);
+		iniFile.writeUInt("ToggleKey", _keyData.getKeyForIniFile());
+		iniFile.writeBool("IsActiveAtStartup", _isActiveAtStartup);
+		iniFile.writeBool("IsPerformanceGroup", _isPerformanceGroup);
+		iniFile.writeInt("PerformancePriority", _performancePriority);
+		iniFile.writeUInt("ThrottleMode", static_cast<uint32_t>(_throttleMode));
+		iniFile.writeUInt("ThrottleValue", _throttleValue);
+	}
 
-		counter=0;
-		for(const auto hash: _pixelShaderHashes)
+
+	void ToggleGroup::writeHashes(IniFileWriter& iniFile, const std::string& section, const ShaderHashSet& hashes, bool deltaEncode)
+	{
+		iniFile.writeSection(section);
+		std::vector<uint32_t> sortedHashes;
+		hashes.copySortedHashes(sortedHashes);
+		std::string encodedHashes;
+		if(deltaEncode)
 		{
-			iniFile.SetUInt("ShaderHash" + std::to_string(counter), hash, "", pixelHashesCategory);
-			counter++;
+			encodeHashListDelta(sortedHashes, encodedHashes);
+			iniFile.writeValue("HashesDelta", encodedHashes);
 		}
-		iniFile.SetUInt("AmountHashes", counter, "", pixelHashesCategory);
-
-		counter = 0;
-		for(const auto hash : _computeShaderHashes)
+		else
 		{
-			iniFile.SetUInt("ShaderHash" + std::to_string(counter), hash, "", computeHashesCategory);
-			counter++;
+			encodeHashList(sortedHashes, encodedHashes);
+			iniFile.writeValue("Hashes", encodedHashes);
 		}
-		iniFile.SetUInt("AmountHashes", counter, "", computeHashesCategory);
-
-		iniFile.SetValue("Name", _name, "", sectionRoot);
-		iniFile.SetUInt("ToggleKey", _keyData.getKeyForIniFile(), "", sectionRoot);
-		iniFile.SetBool("IsActiveAtStartup", _isActiveAtStartup, "", sectionRoot);
 	}
 
 
-	void ToggleGroup::loadState(CDataFile& iniFile, int groupCounter)
+	bool ToggleGroup::readHashes(CDataFile& iniFile, const std::string& section, ShaderHashSet& hashes)
 	{
-		if(groupCounter<0)
+		// v2 layout: a single sorted list, either with fixed width values or delta encoded.
+		std::vector<uint32_t> sortedHashes;
+		const std::string_view encodedHashes = iniFile.GetValueView("Hashes", section);
+		const std::string_view encodedDeltas = encodedHashes.size() > 0 ? std::string_view() : iniFile.GetValueView("HashesDelta", section);
+		if(encodedHashes.size() > 0 || encodedDeltas.size() > 0)
 		{
-			int amount = iniFile.GetInt("AmountHashes", "PixelShaders");
-			for(int i = 0;i< amount;i++)
+			const bool isValid = encodedHashes.size() > 0 ? decodeHashList(encodedHashes, sortedHashes) : decodeHashListDelta(encodedDeltas, sortedHashes);
+			if(isValid)
 			{
-				uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), "PixelShaders");
-				if(hash!=UINT_MAX)
-				{
-					_pixelShaderHashes.emplace(hash);
-				}
+				hashes.assignSorted(sortedHashes);
 			}
-			amount = iniFile.GetInt("AmountHashes", "VertexShaders");
-			for(int i = 0;i< amount;i++)
-			{
-				uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), "VertexShaders");
-				if(hash!=UINT_MAX)
-				{
-					_vertexShaderHashes.emplace(hash);
-				}
-			}
-			amount = iniFile.GetInt("AmountHashes", "ComputeShaders");
-			for(int i = 0; i < amount; i++)
-			{
-				uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), "ComputeShaders");
-				if(hash != UINT_MAX)
-				{
-					_computeShaderHashes.emplace(hash);
-				}
-			}
-
-			// done
-			return;
+			return isValid;
 		}
 
-		const std::string sectionRoot = "Group" + std::to_string(groupCounter);
-		const std::string vertexHashesCategory = sectionRoot + "_VertexShaders";
-		const std::string pixelHashesCategory = sectionRoot + "_PixelShaders";
-		const std::string computeHashesCategory = sectionRoot + "_ComputeShaders";
-
-		int amountShaders = iniFile.GetInt("AmountHashes", vertexHashesCategory);
-		for(int i = 0;i< amountShaders;i++)
+		// pre-v2 layout: a ShaderHashN key per hash, and the number of hashes in AmountHashes.
+		const int amountShaders = iniFile.GetInt("AmountHashes", section);
+		std::vector<uint32_t> collectedHashes;
+		if(amountShaders > 0)
+		{
+			collectedHashes.reserve(amountShaders);
+		}
+		char keyName[32];
+		for(int i = 0; i < amountShaders; i++)
 		{
-			uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), vertexHashesCategory);
-			if(hash!=UINT_MAX)
+			const int keyNameLength = snprintf(keyName, sizeof(keyName), "ShaderHash%d", i);
+			uint32_t hash = iniFile.GetUInt(std::string_view(keyName, keyNameLength), section);
+			if(hash != UINT_MAX)
 			{
-				_vertexShaderHashes.emplace(hash);
+				collectedHashes.push_back(hash);
 			}
 		}
+		hashes.assign(std::move(collectedHashes));
+		return true;
+	}
 
-		amountShaders = iniFile.GetInt("AmountHashes", pixelHashesCategory);
-		for(int i = 0;i< amountShaders;i++)
+
+	void ToggleGroup::readAllHashes(CDataFile& iniFile, const std::string& pixelHashesSection, const std::string& vertexHashesSection, const std::string& computeHashesSection)
+	{
+		std::string unreadableSections;
+		const std::string* sections[3] = { &vertexHashesSection, &pixelHashesSection, &computeHashesSection };
+		ShaderHashSet* hashSets[3] = { &_vertexShaderHashes, &_pixelShaderHashes, &_computeShaderHashes };
+		for(int i = 0; i < 3; i++)
 		{
-			uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), pixelHashesCategory);
-			if(hash!=UINT_MAX)
+			if(!readHashes(iniFile, *sections[i], *hashSets[i]))
 			{
-				_pixelShaderHashes.emplace(hash);
+				unreadableSections += (unreadableSections.empty() ? "[" : ", [") + *sections[i] + "]";
 			}
 		}
+		_loadError = unreadableSections.empty() ? "" : "The hash list in " + unreadableSections + " couldn't be read, these shaders are missing from the group.";
+	}
 
-		amountShaders = iniFile.GetInt("AmountHashes", computeHashesCategory);
-		for(int i = 0; i < amountShaders; i++)
+
+	void ToggleGroup::loadState(CDataFile& iniFile, int groupCounter)
+	{
+		if(groupCounter<0)
 		{
-			uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), computeHashesCategory);
-			if(hash != UINT_MAX)
-			{
-				_computeShaderHashes.emplace(hash);
-			}
+			readAllHashes(iniFile, "PixelShaders", "VertexShaders", "ComputeShaders");
+
+			// done
+			return;
 		}
 
+		const std::string sectionRoot = "Group" + std::to_string(groupCounter);
+		const std::string vertexHashesCategory = sectionRoot + "_VertexShaders";
+		const std::string pixelHashesCategory = sectionRoot + "_PixelShaders";
+		const std::string computeHashesCategory = sectionRoot + "_ComputeShaders";
+
+		readAllHashes(iniFile, pixelHashesCategory, vertexHashesCategory, computeHashesCategory);
+
 		_name = iniFile.GetValue("Name", sectionRoot);
 		if(_name.size()<=0)
 		{
@@ -245,5 +255,36 @@ namespace ShaderToggler
 		}
 		_isActiveAtStartup = iniFile.GetBool("IsActiveAtStartup", sectionRoot);
 		_isActive = _isActiveAtStartup;
+		_isPerformanceGroup = iniFile.GetBool("IsPerformanceGroup", sectionRoot);
+		const int performancePriority = iniFile.GetInt("PerformancePriority", sectionRoot);
+		_performancePriority = performancePriority == INT_MIN ? 0 : performancePriority;
+		const uint32_t throttleMode = iniFile.GetUInt("ThrottleMode", sectionRoot);
+		_throttleMode = throttleMode < static_cast<uint32_t>(DrawThrottleMode::Count) ? static_cast<DrawThrottleMode>(throttleMode) : DrawThrottleMode::HideAll;
+		const uint32_t throttleValue = iniFile.GetUInt("ThrottleValue", sectionRoot);
+		// the file can be edited by hand, so the value is brought into the range of the mode.
+		_throttleValue = clampThrottleValue(_throttleMode, throttleValue == UINT_MAX ? 2 : throttleValue);
+	}
+
+
+	void ToggleGroup::loadState(const CompiledProfile& profile, uint32_t groupIndex)
+	{
+		// the sets are stored with their lookup tables, and are used in place in the mapping.
+		profile.assignHashes(groupIndex, CompiledProfile::VertexShaderStage, _vertexShaderHashes);
+		profile.assignHashes(groupIndex, CompiledProfile::PixelShaderStage, _pixelShaderHashes);
+		profile.assignHashes(groupIndex, CompiledProfile::ComputeShaderStage, _computeShaderHashes);
+
+		_name = profile.getGroupName(groupIndex);
+		if(_name.size()<=0)
+		{
+			_name = "Default";
+		}
+		// same as the ini file: the key is stored as written, a group without a key stays without one.
+		_keyData.setKeyFromIniFile(profile.getToggleKey(groupIndex));
+		_isActiveAtStartup = profile.isActiveAtStartup(groupIndex);
+		_isActive = _isActiveAtStartup;
+		_isPerformanceGroup = profile.isPerformanceGroup(groupIndex);
+		_performancePriority = profile.getPerformancePriority(groupIndex);
+		_throttleMode = profile.getThrottleMode(groupIndex);
+		_throttleValue = clampThrottleValue(_throttleMode, profile.getThrottleValue(groupIndex));
 	}
 }
@@ -31,14 +31,20 @@
 /////////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include <span>
 #include <string>
 #include <unordered_set>
 
 #include "CDataFile.h"
+#include "DrawThrottle.h"
+#include "IniFileWriter.h"
 #include "KeyData.h"
+#include "ShaderHashSet.h"
 
 namespace ShaderToggler
 {
+	class CompiledProfile;
+
 	class ToggleGroup
 	{
 	public:
@@ -50,38 +56,82 @@ namespace ShaderToggler
 		void setToggleKey(KeyData newData);
 		void setName(std::string newName);
 		/// <summary>
-		/// Writes the shader hashes, name and toggle key to the ini file specified, using a Group + groupCounter section.
+		/// Writes the shader hashes, name and toggle key to the ini file writer specified, using a Group + groupCounter section. The hashes are written
+		/// in the v2 layout: per shader stage one sorted list of hashes.
 		/// </summary>
 		/// <param name="iniFile"></param>
 		/// <param name="groupCounter"></param>
-		void saveState(CDataFile& iniFile, int groupCounter) const;
+		/// <param name="deltaEncodeHashes">if true, the hash lists are delta encoded, which is smaller but slower to read back</param>
+		void saveState(IniFileWriter& iniFile, int groupCounter, bool deltaEncodeHashes) const;
 		/// <summary>
-		/// Loads the shader hashes, name and toggle key from the ini file specified, using a Group + groupCounter section.
+		/// Loads the shader hashes, name and toggle key from the ini file specified, using a Group + groupCounter section. Reads the v2 layout as
+		/// well as the older layout with a ShaderHashN key per hash.
 		/// </summary>
 		/// <param name="iniFile"></param>
 		/// <param name="groupCounter">if -1, the ini file is in the pre-1.0 format</param>
 		void loadState(CDataFile& iniFile, int groupCounter);
-		void storeCollectedHashes(const std::unordered_set<uint32_t> pixelShaderHashes, const std::unordered_set<uint32_t> vertexShaderHashes, const std::unordered_set<uint32_t> computeShaderHashes);
-		bool isBlockedPixelShader(uint32_t shaderHash);
-		bool isBlockedVertexShader(uint32_t shaderHash);
-		bool isBlockedComputeShader(uint32_t shaderHash);
+		/// <summary>
+		/// Loads the shader hashes, name and toggle key of the group at position groupIndex in the compiled profile specified. The hash sets
+		/// share the profile's mapping, so the compiled profile can be closed afterwards.
+		/// </summary>
+		/// <param name="profile"></param>
+		/// <param name="groupIndex"></param>
+		void loadState(const CompiledProfile& profile, uint32_t groupIndex);
+		/// <summary>
+		/// Replaces the group's shader hashes with the ones specified. Clears the load error, if any.
+		/// </summary>
+		void storeCollectedHashes(const std::unordered_set<uint32_t>& pixelShaderHashes, const std::unordered_set<uint32_t>& vertexShaderHashes, const std::unordered_set<uint32_t>& computeShaderHashes);
 		void clearHashes();
+		/// <summary>
+		/// Returns true if the group specified has the same name, toggle key, startup state, performance settings, throttle and shader hashes as this group.
+		/// </summary>
+		bool hasSameDefinition(const ToggleGroup& other) const;
+		/// <summary>
+		/// Takes over the name, toggle key, startup state, performance settings, throttle and shader hashes of the group specified. The id and whether the group is currently
+		/// toggled on are kept.
+		/// </summary>
+		void applyDefinition(ToggleGroup&& other);
 
 		void toggleActive() { _isActive = !_isActive;}
 		void setIsActiveAtStartup(bool newValue) { _isActiveAtStartup = newValue; }
+		void setIsPerformanceGroup(bool newValue) { _isPerformanceGroup = newValue; }
+		void setPerformancePriority(int newValue) { _performancePriority = newValue; }
+		void setThrottle(DrawThrottleMode mode, uint32_t value) { _throttleMode = mode; _throttleValue = clampThrottleValue(mode, value); }
+		/// <summary>
+		/// Sets the slot in the per command list throttle counters the group uses while it's active. Set when the active groups filter is built.
+		/// </summary>
+		void setThrottleSlot(uint32_t slot) { _throttleSlot = slot; }
 		void setEditing(bool isEditing) { _isEditing = isEditing;}
 
 		std::string getToggleKeyAsString() { return _keyData.getKeyAsString();}
 		uint8_t getToggleKey() { return _keyData.getKeyCode();}
-		std::string getName() { return _name;}
-		bool isActiveAtStartup() { return _isActiveAtStartup; }
+		uint32_t getToggleKeyForIniFile() const { return _keyData.getKeyForIniFile(); }
+		const std::string& getName() const { return _name;}
+		bool isActiveAtStartup() const { return _isActiveAtStartup; }
+		bool isPerformanceGroup() const { return _isPerformanceGroup; }
+		int getPerformancePriority() const { return _performancePriority; }
+		DrawThrottleMode getThrottleMode() const { return _throttleMode; }
+		uint32_t getThrottleValue() const { return _throttleValue; }
+		uint32_t getThrottleSlot() const { return _throttleSlot; }
+		/// <summary>
+		/// Returns true if the group is active and counts its draws, but got no throttle counter slot as more throttled groups are active than
+		/// there are slots. Such a group draws everything until a slot frees up.
+		/// </summary>
+		bool isThrottleOverflowing() const
+		{
+			return _isActive && _throttleSlot == DrawThrottleCounters::NO_SLOT && _throttleMode != DrawThrottleMode::HideAll && _throttleMode != DrawThrottleMode::ReduceInstances;
+		}
 		bool isActive() { return _isActive;}
 		bool isEditing() { return _isEditing;}
+		/// <summary>
+		/// Describes the hash lists which couldn't be read when the group was loaded from the ini file, empty if all were read.
+		/// </summary>
+		const std::string& getLoadError() const { return _loadError; }
 		bool isEmpty() const { return _vertexShaderHashes.size() <= 0 && _pixelShaderHashes.size() <= 0 && _computeShaderHashes.size() <= 0; }
 		int getId() const { return _id; }
-		std::unordered_set<uint32_t> getPixelShaderHashes() const { return _pixelShaderHashes;}
-		std::unordered_set<uint32_t> getVertexShaderHashes() const { return _vertexShaderHashes;}
-		std::unordered_set<uint32_t> getComputeShaderHashes() const { return _computeShaderHashes; }
+		const ShaderHashSet& getPixelShaderHashes() const { return _pixelShaderHashes;}
+		const ShaderHashSet& getVertexShaderHashes() const { return _vertexShaderHashes;}
+		const ShaderHashSet& getComputeShaderHashes() const { return _computeShaderHashes; }
 		bool isToggleKeyPressed(const reshade::api::effect_runtime* runtime) { return _keyData.isKeyPressed(runtime);}
 		
 		bool operator==(const ToggleGroup& rhs)
@@ -90,14 +140,34 @@ namespace ShaderToggler
 		}
 
 	private:
+		/// <summary>
+		/// Writes the section for the shader hashes of one shader stage, as a single sorted list in either the Hashes or the HashesDelta key.
+		/// </summary>
+		static void writeHashes(IniFileWriter& iniFile, const std::string& section, const ShaderHashSet& hashes, bool deltaEncode);
+		/// <summary>
+		/// Reads the shader hashes of one shader stage from the section specified, in either the v2 or the older ShaderHashN layout.
+		/// </summary>
+		/// <returns>false if the section has a v2 hash list which couldn't be decoded, true otherwise</returns>
+		static bool readHashes(CDataFile& iniFile, const std::string& section, ShaderHashSet& hashes);
+		/// <summary>
+		/// Reads the shader hashes of all stages from the sections specified and sets _loadError to the sections which couldn't be read.
+		/// </summary>
+		void readAllHashes(CDataFile& iniFile, const std::string& pixelHashesSection, const std::string& vertexHashesSection, const std::string& computeHashesSection);
+
 		int _id;
 		std::string	_name;
 		KeyData _keyData;
-		std::unordered_set<uint32_t> _vertexShaderHashes;
-		std::unordered_set<uint32_t> _pixelShaderHashes;
-		std::unordered_set<uint32_t> _computeShaderHashes;
+		ShaderHashSet _vertexShaderHashes;
+		ShaderHashSet _pixelShaderHashes;
+		ShaderHashSet _computeShaderHashes;
 		bool _isActive;				// true means the group is actively toggled (so the hashes have to be hidden).
 		bool _isEditing;			// true means the group is actively edited (name, key)
 		bool _isActiveAtStartup;	// true means the group is active when the host game is started and the toggler has loaded the groups.
+		bool _isPerformanceGroup;	// true means the frame time governor is allowed to toggle the group on when the frame time is over budget.
+		int _performancePriority;	// the order in which the governor toggles performance groups on: higher first.
+		DrawThrottleMode _throttleMode;	// what happens to the draws with the group's shaders when the group is active.
+		uint32_t _throttleValue;	// the n of the throttle mode.
+		uint32_t _throttleSlot;		// slot in the throttle counters, DrawThrottleCounters::NO_SLOT if the group hides all, reduces instances or overflows the slots.
+		std::string _loadError;		// the hash lists which couldn't be read from the ini file, empty if there were none.
 	};
 }
@@ -32,14 +32,27 @@
 
 #pragma once
 
+#ifdef _WIN32
 #include <SDKDDKVer.h>
 
 // Windows Header Files:
 #include <windows.h>
-#include <iostream>
-#include <string>
 #include <tchar.h>
 #include <Psapi.h>
+#else
+// the parts of the Windows API used by the profile and group code, so that code can be built and tested with other compilers.
+#include <cstdio>
+#include <strings.h>
+#define VK_SHIFT	0x10
+#define VK_CONTROL	0x11
+#define VK_MENU		0x12
+#define VK_CAPITAL	0x14
+#define _stricmp strcasecmp
+#define _snprintf_s(buffer, size, ...) snprintf(buffer, size, __VA_ARGS__)
+#define _vsnprintf_s(buffer, size, format, args) vsnprintf(buffer, size, format, args)
+#endif
+#include <iostream>
+#include <string>
 #include <utility>
 #include <vector>
 
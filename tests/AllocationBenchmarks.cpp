@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <unordered_set>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "ProfileLoader.h"
+#include "ProfileSaver.h"
+#include "ShaderManager.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	constexpr uint32_t AMOUNT_GROUPS = 8;
+
+	ProfileSnapshot createProfile(uint32_t amountGroups, uint32_t amountHashesPerGroup)
+	{
+		ProfileSnapshot toReturn;
+		uint32_t hashCounter = 1;
+		for(uint32_t groupIndex = 0; groupIndex < amountGroups; groupIndex++)
+		{
+			std::unordered_set<uint32_t> hashes[3];
+			for(uint32_t i = 0; i < amountHashesPerGroup; i++)
+			{
+				hashes[i % 3].insert(hashCounter++ * 2654435761u);
+			}
+			ToggleGroup group("Group" + std::to_string(groupIndex), ToggleGroup::getNewGroupId());
+			group.storeCollectedHashes(hashes[0], hashes[1], hashes[2]);
+			toReturn.groups.push_back(group);
+		}
+		return toReturn;
+	}
+
+
+	struct AllocationCounts
+	{
+		uint64_t save = 0;
+		uint64_t loadIniFile = 0;
+		uint64_t loadCompiledProfile = 0;
+		uint64_t huntingStartStop = 0;
+	};
+
+
+	AllocationCounts countProfileAllocations(uint32_t amountHashesPerGroup)
+	{
+		const std::string iniFileName = Tests::getTemporaryFileName("Allocations.ini");
+		const std::string compiledProfileFileName = Tests::getTemporaryFileName("Allocations.bin");
+		const ProfileSnapshot profile = createProfile(AMOUNT_GROUPS, amountHashesPerGroup);
+		AllocationCounts toReturn;
+		std::string errorMessage;
+		toReturn.save = Tests::countAllocations([&]()
+			{
+				ProfileSaver::writeIniFile(profile, iniFileName, errorMessage);
+			});
+		ProfileSaver::writeCompiledProfile(profile, FileStamp::read(iniFileName), compiledProfileFileName, errorMessage);
+		toReturn.loadIniFile = Tests::countAllocations([&]()
+			{
+				ProfileSnapshot loaded;
+				ProfileLoader::loadIniFile(iniFileName, loaded);
+			});
+		toReturn.loadCompiledProfile = Tests::countAllocations([&]()
+			{
+				ProfileSnapshot loaded;
+				ProfileLoader::loadProfile(iniFileName, compiledProfileFileName, loaded);
+			});
+
+		// hunting with a group's shaders marked. The first round interns the hashes, which is done once per hash for the whole session.
+		ShaderManager shaderManager;
+		const std::span<const uint32_t> markedHashes = profile.groups.front().getPixelShaderHashes().getHashes();
+		shaderManager.startHuntingMode(markedHashes);
+		shaderManager.stopHuntingMode();
+		toReturn.huntingStartStop = Tests::countAllocations([&]()
+			{
+				shaderManager.startHuntingMode(markedHashes);
+				shaderManager.stopHuntingMode();
+			});
+		std::filesystem::remove(iniFileName);
+		std::filesystem::remove(compiledProfileFileName);
+		return toReturn;
+	}
+}
+
+
+TEST_CASE(benchmarkAllocationsDontScaleWithHashes)
+{
+	// 100x the hashes may only add the few extra reallocations of growing buffers, not allocations per hash.
+	const AllocationCounts fewHashes = countProfileAllocations(1000);
+	const AllocationCounts manyHashes = countProfileAllocations(100000);
+	printf("  allocations for %u groups, 1k / 100k hashes per group: save %llu / %llu, load ini %llu / %llu, load compiled %llu / %llu, hunting start+stop %llu / %llu\n",
+		   AMOUNT_GROUPS, (unsigned long long)fewHashes.save, (unsigned long long)manyHashes.save, (unsigned long long)fewHashes.loadIniFile,
+		   (unsigned long long)manyHashes.loadIniFile, (unsigned long long)fewHashes.loadCompiledProfile, (unsigned long long)manyHashes.loadCompiledProfile,
+		   (unsigned long long)fewHashes.huntingStartStop, (unsigned long long)manyHashes.huntingStartStop);
+	// at most one reallocation per hash list, i.e. per stage of each group.
+	constexpr uint64_t allowedGrowth = AMOUNT_GROUPS * 3;
+	CHECK(manyHashes.save <= fewHashes.save + allowedGrowth);
+	CHECK(manyHashes.loadIniFile <= fewHashes.loadIniFile + allowedGrowth);
+	CHECK(manyHashes.loadCompiledProfile <= fewHashes.loadCompiledProfile + allowedGrowth);
+	CHECK(manyHashes.huntingStartStop <= fewHashes.huntingStartStop);
+}
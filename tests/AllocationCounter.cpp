@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<uint64_t> s_amountAllocations = 0;
+	std::atomic<uint64_t> s_amountAllocatedBytes = 0;
+
+	void* allocate(size_t size)
+	{
+		s_amountAllocations.fetch_add(1, std::memory_order_relaxed);
+		s_amountAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+		if(void* toReturn = std::malloc(size == 0 ? 1 : size))
+		{
+			return toReturn;
+		}
+		throw std::bad_alloc();
+	}
+
+	void* allocateAligned(size_t size, std::align_val_t alignment)
+	{
+		s_amountAllocations.fetch_add(1, std::memory_order_relaxed);
+		s_amountAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+		const size_t alignmentInBytes = static_cast<size_t>(alignment);
+#ifdef _MSC_VER
+		void* toReturn = _aligned_malloc(size == 0 ? 1 : size, alignmentInBytes);
+#else
+		// aligned_alloc needs the size to be a multiple of the alignment.
+		const size_t alignedSize = ((size == 0 ? 1 : size) + alignmentInBytes - 1) / alignmentInBytes * alignmentInBytes;
+		void* toReturn = std::aligned_alloc(alignmentInBytes, alignedSize);
+#endif
+		if(nullptr == toReturn)
+		{
+			throw std::bad_alloc();
+		}
+		return toReturn;
+	}
+
+	void freeAligned(void* memory)
+	{
+#ifdef _MSC_VER
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+}
+
+
+namespace ShaderToggler::Tests
+{
+	uint64_t getAmountAllocations()
+	{
+		return s_amountAllocations.load(std::memory_order_relaxed);
+	}
+
+
+	uint64_t getAmountAllocatedBytes()
+	{
+		return s_amountAllocatedBytes.load(std::memory_order_relaxed);
+	}
+}
+
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { freeAligned(memory); }
@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+
+namespace ShaderToggler::Tests
+{
+	/// <summary>
+	/// The number of heap allocations made through the global operator new since the start of the process. Only counted in executables
+	/// which link AllocationCounter.cpp, which replaces the global operator new and delete.
+	/// </summary>
+	uint64_t getAmountAllocations();
+	/// <summary>
+	/// The number of bytes requested from the global operator new since the start of the process, freed or not.
+	/// </summary>
+	uint64_t getAmountAllocatedBytes();
+
+	/// <summary>
+	/// Runs the function specified and returns the number of heap allocations it made.
+	/// </summary>
+	template<typename Function>
+	uint64_t countAllocations(Function function)
+	{
+		const uint64_t amountBefore = getAmountAllocations();
+		function();
+		return getAmountAllocations() - amountBefore;
+	}
+
+	/// <summary>
+	/// Runs the function specified and returns the number of bytes it requested from the heap.
+	/// </summary>
+	template<typename Function>
+	uint64_t countAllocatedBytes(Function function)
+	{
+		const uint64_t amountBefore = getAmountAllocatedBytes();
+		function();
+		return getAmountAllocatedBytes() - amountBefore;
+	}
+}
@@ -0,0 +1,206 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <chrono>
+#include <vector>
+
+#include "ShaderManager.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	constexpr uint32_t AMOUNT_PIPELINES = 2000;
+	constexpr uint32_t AMOUNT_BINDS_PER_FRAME = 5000;
+	constexpr uint32_t AMOUNT_DRAWS_PER_BIND = 3;
+	constexpr uint32_t BINDS_PER_COMMAND_LIST = 500;		// the command list is reset after this many binds
+	constexpr uint32_t DRAWS_AFTER_RESET = 2;				// draws issued after a reset, before the first bind
+	constexpr int AMOUNT_RUNS = 20;
+	constexpr uint64_t RESET_PIPELINE = UINT64_MAX;			// what the active pipeline was set to on a reset, before the cache
+
+	enum class ReplayEvent : uint8_t
+	{
+		Bind,
+		Draw,
+		Reset
+	};
+
+	struct ReplayStep
+	{
+		ReplayEvent event;
+		uint64_t pipelineHandle;
+	};
+
+	struct Stages
+	{
+		ShaderManager pixel;
+		ShaderManager vertex;
+		ShaderManager compute;
+	};
+
+
+	/// <summary>
+	/// A frame as the addon sees it: binds, half of which re-bind the pipeline bound last, each followed by a few draws, and a command list
+	/// reset now and then, with a couple of draws before the next bind.
+	/// </summary>
+	std::vector<ReplayStep> createFrame()
+	{
+		std::vector<ReplayStep> toReturn;
+		uint32_t random = 12345;
+		uint64_t lastPipeline = 1;
+		for(uint32_t bind = 0; bind < AMOUNT_BINDS_PER_FRAME; bind++)
+		{
+			if(bind % BINDS_PER_COMMAND_LIST == 0)
+			{
+				toReturn.push_back({ ReplayEvent::Reset, 0 });
+				for(uint32_t draw = 0; draw < DRAWS_AFTER_RESET; draw++)
+				{
+					toReturn.push_back({ ReplayEvent::Draw, 0 });
+				}
+			}
+			random = random * 1664525u + 1013904223u;
+			const uint64_t pipeline = (random >> 16) % 2 == 0 ? lastPipeline : 1 + (random >> 8) % AMOUNT_PIPELINES;
+			toReturn.push_back({ ReplayEvent::Bind, pipeline });
+			lastPipeline = pipeline;
+			for(uint32_t draw = 0; draw < AMOUNT_DRAWS_PER_BIND; draw++)
+			{
+				toReturn.push_back({ ReplayEvent::Draw, 0 });
+			}
+		}
+		return toReturn;
+	}
+
+
+	/// <summary>
+	/// Replays the frame the way the draw hooks worked before the cache: the bind only stores the handle, each draw looks up the shaders of
+	/// all three stages, including for the reset handle.
+	/// </summary>
+	uint32_t replayWithLookupsPerDraw(Stages& stages, const std::vector<ReplayStep>& frame)
+	{
+		uint32_t hashSum = 0;
+		uint64_t activePipeline = RESET_PIPELINE;
+		for(const auto& step : frame)
+		{
+			switch(step.event)
+			{
+			case ReplayEvent::Bind:
+				activePipeline = step.pipelineHandle;
+				break;
+			case ReplayEvent::Reset:
+				activePipeline = RESET_PIPELINE;
+				break;
+			case ReplayEvent::Draw:
+				hashSum += stages.pixel.getShaderHash(activePipeline) + stages.vertex.getShaderHash(activePipeline) + stages.compute.getShaderHash(activePipeline);
+				break;
+			}
+		}
+		return hashSum;
+	}
+
+
+	/// <summary>
+	/// Replays the frame the way bindPipeline works now: a bind resolves the shaders once, unless it re-binds the pipeline resolved last, and
+	/// draws only read them.
+	/// </summary>
+	uint32_t replayWithBindTimeResolution(Stages& stages, const std::vector<ReplayStep>& frame)
+	{
+		uint32_t hashSum = 0;
+		PipelineShader activeShaders[3];
+		uint64_t lastBoundPipeline = 0;
+		for(const auto& step : frame)
+		{
+			switch(step.event)
+			{
+			case ReplayEvent::Bind:
+				if(step.pipelineHandle != lastBoundPipeline)
+				{
+					activeShaders[0] = stages.pixel.getPipelineShader(step.pipelineHandle);
+					activeShaders[1] = stages.vertex.getPipelineShader(step.pipelineHandle);
+					activeShaders[2] = stages.compute.getPipelineShader(step.pipelineHandle);
+					lastBoundPipeline = step.pipelineHandle;
+				}
+				break;
+			case ReplayEvent::Reset:
+				activeShaders[0] = activeShaders[1] = activeShaders[2] = PipelineShader();
+				lastBoundPipeline = 0;
+				break;
+			case ReplayEvent::Draw:
+				// a stage with nothing bound since the reset is recognized by its shader id, a compare, as in the draw hook.
+				for(const auto& activeShader : activeShaders)
+				{
+					hashSum += activeShader.shaderId != ShaderIdBitset::NO_ID ? activeShader.shaderHash : 0;
+				}
+				break;
+			}
+		}
+		return hashSum;
+	}
+
+
+	template<typename Replay>
+	double measureFastestFrame(Replay replay, uint32_t& hashSum)
+	{
+		double fastestFrameMs = 1e9;
+		for(int run = 0; run < AMOUNT_RUNS; run++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			hashSum = replay();
+			fastestFrameMs = std::min(fastestFrameMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return fastestFrameMs;
+	}
+}
+
+
+TEST_CASE(benchmarkBindTimeShaderResolution)
+{
+	Stages stages;
+	for(uint64_t pipeline = 1; pipeline <= AMOUNT_PIPELINES; pipeline++)
+	{
+		// graphics pipelines: a pixel and a vertex shader, several pipelines share a shader.
+		stages.pixel.addHashHandlePair(static_cast<uint32_t>(pipeline % 700 + 1) * 2654435761u, pipeline);
+		stages.vertex.addHashHandlePair(static_cast<uint32_t>(pipeline % 300 + 1) * 40503u, pipeline);
+	}
+	const std::vector<ReplayStep> frame = createFrame();
+	uint32_t perDrawHashSum = 0;
+	uint32_t bindTimeHashSum = 0;
+	const double perDrawMs = measureFastestFrame([&]() { return replayWithLookupsPerDraw(stages, frame); }, perDrawHashSum);
+	const double bindTimeMs = measureFastestFrame([&]() { return replayWithBindTimeResolution(stages, frame); }, bindTimeHashSum);
+	CHECK(perDrawHashSum == bindTimeHashSum);
+	printf("  frame of %u binds, %u draws: lookups per draw %.3f ms, resolved at bind time %.3f ms (%.1fx)\n", AMOUNT_BINDS_PER_FRAME,
+		   AMOUNT_BINDS_PER_FRAME * AMOUNT_DRAWS_PER_BIND + AMOUNT_BINDS_PER_FRAME / BINDS_PER_COMMAND_LIST * DRAWS_AFTER_RESET, perDrawMs, bindTimeMs,
+		   perDrawMs / bindTimeMs);
+#ifdef NDEBUG
+	CHECK(bindTimeMs < perDrawMs);
+#endif
+}
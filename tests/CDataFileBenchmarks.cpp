@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#include "CDataFile.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	constexpr int AMOUNT_RUNS = 50;
+	constexpr uint32_t AMOUNT_KEYS = 10000;
+	constexpr double PARSE_BUDGET_MS = 1.0;
+}
+
+
+TEST_CASE(benchmarkParseIniWith10kHashKeys)
+{
+	// the layout with a ShaderHashN key per hash, which is the worst case for the parser: every line is a key of its own.
+	const std::string fileName = Tests::getTemporaryFileName("Benchmark10kKeys.ini");
+	{
+		std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+		file << "[General]\nAmountGroups=1\n[Group0_PixelShaders]\n";
+		for(uint32_t i = 0; i < AMOUNT_KEYS; i++)
+		{
+			file << "ShaderHash" << i << "=" << i * 2654435761u << "\n";
+		}
+		file << "AmountHashes=" << AMOUNT_KEYS << "\n";
+	}
+
+	// only the Load call is timed, not the destruction of the loaded keys. The first run warms up the file cache.
+	double parseMs = 1e9;
+	size_t amountKeysLoaded = 0;
+	for(int i = 0; i < AMOUNT_RUNS; i++)
+	{
+		CDataFile iniFile;
+		const auto start = std::chrono::steady_clock::now();
+		iniFile.Load(fileName);
+		parseMs = std::min(parseMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		amountKeysLoaded = static_cast<size_t>(iniFile.KeyCount());
+	}
+	printf("  %u ShaderHashN keys: %.3f ms\n", AMOUNT_KEYS, parseMs);
+	CHECK(amountKeysLoaded == AMOUNT_KEYS + 2);
+#ifdef NDEBUG
+	CHECK(parseMs < PARSE_BUDGET_MS);
+#endif
+	std::filesystem::remove(fileName);
+}
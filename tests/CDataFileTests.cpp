@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <fstream>
+
+#include "CDataFile.h"
+
+TEST_CASE(cDataFileLoadsSectionsKeysAndComments)
+{
+	const std::string fileName = ShaderToggler::Tests::getTemporaryFileName("CDataFileLoad.ini");
+	const std::string longName(2000, 'n');
+	{
+		std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+		file << "; top comment\r\n[General]\r\nAmountGroups=2\r\n\r\n# comment\r\n[Group0]\r\nName=" << longName << "\r\nToggleKey = 5\r\nnovalue\r\nempty=";
+	}
+	CDataFile iniFile;
+	CHECK(iniFile.Load(fileName));
+	CHECK(iniFile.GetInt("AmountGroups", "general") == 2);
+	CHECK(iniFile.GetValue("Name", "Group0") == longName);
+	CHECK(iniFile.GetValue("togglekey", "Group0") == " 5");
+	CHECK(iniFile.GetValue("novalue", "Group0").empty());
+	CHECK(iniFile.GetValue("empty", "Group0").empty());
+	iniFile.Clear();
+	std::filesystem::remove(fileName);
+}
+
+
+TEST_CASE(cDataFileSplitsKeysAtTheFirstEqualIndicator)
+{
+	// the keys are longer than the 16 characters the line scan looks at in one go, and the indicators at the start and end of a line are trimmed.
+	const std::string fileName = ShaderToggler::Tests::getTemporaryFileName("CDataFileEqualIndicators.ini");
+	{
+		std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+		file << "[Group0]\nAVeryLongKeyNameOfAGroup = first\n==LeadingIndicators=Value\nColonFirst:With=Both\nTrailingIndicator =\n";
+		file << "AVeryLongKeyNameOfAGroup=second\nLast=1";
+	}
+	CDataFile iniFile;
+	CHECK(iniFile.Load(fileName));
+	CHECK(iniFile.GetValue("AVeryLongKeyNameOfAGroup", "Group0") == "second");
+	CHECK(iniFile.GetValue("LeadingIndicators", "Group0") == "Value");
+	CHECK(iniFile.GetValue("ColonFirst", "Group0") == "With=Both");
+	CHECK(iniFile.GetValue("TrailingIndicator", "Group0").empty());
+	CHECK(iniFile.GetValue("Last", "Group0") == "1");
+	CHECK(iniFile.KeyCount() == 4);
+	iniFile.Clear();
+	std::filesystem::remove(fileName);
+}
+
+TEST_CASE(cDataFileDoesNotRewriteFilesItOnlyLoaded)
+{
+	// formatted differently than Save writes it, so a rewrite would show.
+	const std::string fileName = ShaderToggler::Tests::getTemporaryFileName("CDataFileLoadOnly.ini");
+	const std::string contents = "; comment\r\n[General]\r\nAmountGroups = 2\r\n";
+	{
+		std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+		file << contents;
+	}
+	{
+		CDataFile iniFile(fileName);
+		CHECK(iniFile.GetInt("AmountGroups", "General") == 2);
+	}
+	std::ifstream file(fileName, std::ios::binary);
+	const std::string contentsAfterwards((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+	CHECK(contentsAfterwards == contents);
+	std::filesystem::remove(fileName);
+}
+
+
+TEST_CASE(cDataFileLoadFailsForMissingFile)
+{
+	CDataFile iniFile;
+	CHECK(!iniFile.Load(ShaderToggler::Tests::getTemporaryFileName("DoesNotExist.ini")));
+}
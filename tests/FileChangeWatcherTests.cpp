@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <fstream>
+
+#include "FileChangeWatcher.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	void writeTextFile(const std::string& fileName, const std::string& contents)
+	{
+		std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+		file << contents;
+	}
+}
+
+
+TEST_CASE(pollingWatcherReportsChangeOnceStable)
+{
+	const std::string fileName = Tests::getTemporaryFileName("Watched.ini");
+	writeTextFile(fileName, "[General]\n");
+	PollingFileChangeWatcher watcher(fileName);
+	FileStamp newStamp;
+	CHECK(!watcher.checkForChange(newStamp));
+
+	// the sizes differ with every write, so the stamps differ regardless of the file system's time resolution.
+	writeTextFile(fileName, "[General]\nAmountGroups=1\n");
+	CHECK(!watcher.checkForChange(newStamp));
+	CHECK(watcher.checkForChange(newStamp));
+	CHECK(newStamp == FileStamp::read(fileName));
+	CHECK(!watcher.checkForChange(newStamp));
+	std::filesystem::remove(fileName);
+}
+
+
+TEST_CASE(pollingWatcherWaitsWhileFileIsBeingWritten)
+{
+	const std::string fileName = Tests::getTemporaryFileName("BeingWritten.ini");
+	writeTextFile(fileName, "[General]\n");
+	PollingFileChangeWatcher watcher(fileName);
+	FileStamp newStamp;
+	std::string contents = "[General]\n";
+	for(int i = 0; i < 3; i++)
+	{
+		// a writer still appending: every poll sees a different stamp.
+		contents += "[Group" + std::to_string(i) + "]\n";
+		writeTextFile(fileName, contents);
+		CHECK(!watcher.checkForChange(newStamp));
+	}
+	CHECK(watcher.checkForChange(newStamp));
+	CHECK(newStamp.size == contents.size());
+	std::filesystem::remove(fileName);
+}
+
+
+TEST_CASE(pollingWatcherIgnoresRevertedAndRemovedFiles)
+{
+	const std::string fileName = Tests::getTemporaryFileName("Reverted.ini");
+	writeTextFile(fileName, "[General]\n");
+	PollingFileChangeWatcher watcher(fileName);
+	const FileStamp originalStamp = FileStamp::read(fileName);
+	FileStamp newStamp;
+	writeTextFile(fileName, "[General]\nAmountGroups=1\n");
+	CHECK(!watcher.checkForChange(newStamp));
+	// back to what was seen last before it was stable, e.g. a save which was undone.
+	writeTextFile(fileName, "[General]\n");
+	std::filesystem::last_write_time(fileName, originalStamp.lastWriteTime);
+	CHECK(!watcher.checkForChange(newStamp));
+	CHECK(!watcher.checkForChange(newStamp));
+
+	std::filesystem::remove(fileName);
+	CHECK(!watcher.checkForChange(newStamp));
+	CHECK(!watcher.checkForChange(newStamp));
+}
@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <functional>
+#include <vector>
+
+#include "FrameTimeGovernor.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	/// <summary>
+	/// A scene driven by the governor: the frame time is the base frame time the trace specifies for the frame, minus what the performance
+	/// groups switched on save, plus a little deterministic noise. Groups are switched on in order and off in reverse order, as the addon does.
+	/// </summary>
+	struct SimulatedScene
+	{
+		std::function<double(uint32_t)> baseFrameTimeMs;
+		std::vector<double> groupSavingsMs;
+		double noiseMs = 0.3;
+		uint32_t amountActive = 0;
+		uint32_t amountActivations = 0;
+		uint32_t amountDeactivations = 0;
+		uint32_t noise = 12345;
+
+		double getFrameTimeMs(uint32_t frame)
+		{
+			double frameTimeMs = baseFrameTimeMs(frame);
+			for(uint32_t i = 0; i < amountActive; i++)
+			{
+				frameTimeMs -= groupSavingsMs[i];
+			}
+			noise = noise * 1664525u + 1013904223u;
+			return frameTimeMs + noiseMs * ((noise >> 8) / static_cast<double>(1 << 24) - 0.5);
+		}
+
+		void run(FrameTimeGovernor& governor, uint32_t firstFrame, uint32_t amountFrames)
+		{
+			for(uint32_t frame = firstFrame; frame < firstFrame + amountFrames; frame++)
+			{
+				switch(governor.onFramePresented(getFrameTimeMs(frame), amountActive < groupSavingsMs.size()))
+				{
+				case FrameTimeGovernor::Decision::ActivateNext:
+					amountActive++;
+					amountActivations++;
+					break;
+				case FrameTimeGovernor::Decision::DeactivateLast:
+					amountActive--;
+					amountDeactivations++;
+					break;
+				default:
+					break;
+				}
+			}
+		}
+	};
+
+	FrameTimeGovernor createGovernor()
+	{
+		FrameTimeGovernor toReturn;
+		FrameTimeGovernor::Settings settings;
+		settings.budgetMs = 16.7;
+		settings.windowFrames = 60;
+		toReturn.setSettings(settings);
+		return toReturn;
+	}
+}
+
+
+TEST_CASE(governorActivatesGroupsUntilWithinBudget)
+{
+	FrameTimeGovernor governor = createGovernor();
+	SimulatedScene scene;
+	scene.baseFrameTimeMs = [](uint32_t) { return 21.0; };
+	scene.groupSavingsMs = { 2.0, 2.0, 2.0, 2.0 };
+	// nothing happens before the first full window.
+	scene.run(governor, 0, 59);
+	CHECK(scene.amountActive == 0);
+	// 21 -> 19 -> 17 -> 15 ms: three groups, one per window.
+	scene.run(governor, 59, 60 * 10);
+	CHECK(scene.amountActive == 3);
+	CHECK(governor.getAmountActivated() == 3);
+	CHECK(scene.amountDeactivations == 0);
+	CHECK(governor.getFrameTimePercentileMs() < 16.7);
+}
+
+
+TEST_CASE(governorDoesntOscillateAroundBudget)
+{
+	FrameTimeGovernor governor = createGovernor();
+	SimulatedScene scene;
+	// just over budget: switching the group on brings it under, switching it off again would bring it over.
+	scene.baseFrameTimeMs = [](uint32_t) { return 17.2; };
+	scene.groupSavingsMs = { 1.5, 1.5 };
+	scene.noiseMs = 0.6;
+	scene.run(governor, 0, 60 * 200);
+	CHECK(scene.amountActivations == 1);
+	CHECK(scene.amountDeactivations == 0);
+
+	// the load goes away: the group is switched off once, and stays off.
+	scene.baseFrameTimeMs = [](uint32_t) { return 10.0; };
+	scene.run(governor, 60 * 200, 60 * 200);
+	CHECK(scene.amountActive == 0);
+	CHECK(scene.amountActivations == 1);
+	CHECK(scene.amountDeactivations == 1);
+}
+
+
+TEST_CASE(governorHandlesGroupsWithoutMeasuredSaving)
+{
+	FrameTimeGovernor governor = createGovernor();
+	SimulatedScene scene;
+	scene.baseFrameTimeMs = [](uint32_t frame) { return frame < 60 * 20 ? 20.0 : 16.0; };
+	// the first group saves nothing, e.g. its shaders aren't on screen; the second one does.
+	scene.groupSavingsMs = { 0.0, 4.0 };
+	scene.run(governor, 0, 60 * 20);
+	// still over budget after the first group, so the second one is switched on as well.
+	CHECK(scene.amountActive == 2);
+
+	// now 12 ms with both on: the second group can't go, as it'd bring the frame time to 16, within the headroom margin of the budget.
+	// The first one is never reached, as groups are switched off in reverse order.
+	scene.run(governor, 60 * 20, 60 * 50);
+	CHECK(scene.amountActive == 2);
+	CHECK(scene.amountDeactivations == 0);
+
+	// with enough headroom both go, the one without saving last and right after the other.
+	scene.baseFrameTimeMs = [](uint32_t) { return 8.0; };
+	scene.run(governor, 60 * 70, 60 * 3);
+	CHECK(scene.amountActive == 0);
+	CHECK(scene.amountActivations == 2);
+	CHECK(scene.amountDeactivations == 2);
+}
+
+
+TEST_CASE(governorStartsOverAfterReset)
+{
+	FrameTimeGovernor governor = createGovernor();
+	SimulatedScene scene;
+	scene.baseFrameTimeMs = [](uint32_t) { return 20.0; };
+	scene.groupSavingsMs = { 2.0, 2.0, 2.0 };
+	scene.run(governor, 0, 60 * 10);
+	CHECK(scene.amountActive == 2);
+
+	// the user switches off the last group the governor switched on. Like the addon, the scene keeps the remaining one on and resets the
+	// governor, which then doesn't own any group anymore.
+	scene.amountActive = 1;
+	governor.reset();
+	CHECK(governor.getAmountActivated() == 0);
+	CHECK(governor.getFrameTimePercentileMs() == 0.0);
+	// a full window with the new set of groups before it decides again: 18 ms, so one group is switched on.
+	const uint32_t activationsBeforeReset = scene.amountActivations;
+	scene.run(governor, 60 * 10, 59);
+	CHECK(scene.amountActivations == activationsBeforeReset);
+	scene.run(governor, 60 * 10 + 59, 60 * 5);
+	CHECK(scene.amountActive == 2);
+	CHECK(governor.getAmountActivated() == 1);
+
+	// with headroom, it only switches off the group it switched on itself; the one from before the reset stays on.
+	scene.baseFrameTimeMs = [](uint32_t) { return 8.0; };
+	scene.run(governor, 60 * 20, 60 * 10);
+	CHECK(scene.amountActive == 1);
+	CHECK(governor.getAmountActivated() == 0);
+}
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <chrono>
+#include <vector>
+
+#include "ShaderHashFilter.h"
+#include "ShaderHashSet.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	constexpr uint32_t AMOUNT_GROUPS = 8;
+	constexpr uint32_t AMOUNT_HASHES_PER_GROUP = 500;
+	constexpr uint32_t AMOUNT_LOOKUPS = 1 << 20;
+	constexpr uint32_t HIT_EVERY = 20;			// 1 in 20 draws uses a shader in a group, the rest uses shaders in none.
+	constexpr int AMOUNT_RUNS = 5;
+
+	/// <summary>
+	/// Returns the fastest of AMOUNT_RUNS runs of the check specified over all lookups, in nanoseconds per lookup.
+	/// </summary>
+	template<typename Check>
+	double measureChecks(const std::vector<uint32_t>& lookups, Check check, size_t& amountHits)
+	{
+		double fastestRunNs = 1e9;
+		for(int run = 0; run < AMOUNT_RUNS; run++)
+		{
+			size_t hits = 0;
+			const auto start = std::chrono::steady_clock::now();
+			for(const uint32_t hash : lookups)
+			{
+				hits += check(hash) ? 1 : 0;
+			}
+			fastestRunNs = std::min(fastestRunNs, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lookups.size());
+			amountHits = hits;
+		}
+		return fastestRunNs;
+	}
+}
+
+
+TEST_CASE(benchmarkHashFilterInFrontOfGroupSets)
+{
+	// the draw call check for one stage, with 8 active groups: every group's set is looked up, unless the filter rejects the hash first.
+	std::vector<ShaderHashSet> groupSets(AMOUNT_GROUPS);
+	std::vector<uint32_t> allHashes;
+	ShaderHashFilter filter;
+	filter.reserve(AMOUNT_GROUPS * AMOUNT_HASHES_PER_GROUP);
+	uint32_t random = 12345;
+	for(auto& groupSet : groupSets)
+	{
+		std::vector<uint32_t> hashes;
+		for(uint32_t i = 0; i < AMOUNT_HASHES_PER_GROUP; i++)
+		{
+			random = random * 1664525u + 1013904223u;
+			hashes.push_back(random);
+		}
+		allHashes.insert(allHashes.end(), hashes.begin(), hashes.end());
+		groupSet.assign(std::move(hashes));
+		filter.add(groupSet);
+	}
+	std::vector<uint32_t> lookups;
+	lookups.reserve(AMOUNT_LOOKUPS);
+	for(uint32_t i = 0; i < AMOUNT_LOOKUPS; i++)
+	{
+		random = random * 1664525u + 1013904223u;
+		lookups.push_back(i % HIT_EVERY == 0 ? allHashes[random % allHashes.size()] : random);
+	}
+
+	const auto isInAnyGroup = [&](uint32_t hash)
+		{
+			bool isInGroup = false;
+			for(const auto& groupSet : groupSets)
+			{
+				isInGroup |= groupSet.contains(hash);
+			}
+			return isInGroup;
+		};
+	size_t setsOnlyHits = 0;
+	size_t filteredHits = 0;
+	size_t filterPasses = 0;
+	const double setsOnlyNs = measureChecks(lookups, isInAnyGroup, setsOnlyHits);
+	const double filteredNs = measureChecks(lookups, [&](uint32_t hash) { return filter.mightContain(hash) && isInAnyGroup(hash); }, filteredHits);
+	const double filterOnlyNs = measureChecks(lookups, [&](uint32_t hash) { return filter.mightContain(hash); }, filterPasses);
+	CHECK(setsOnlyHits == filteredHits);
+
+	const size_t amountMisses = lookups.size() - setsOnlyHits;
+	const double falsePositiveRate = static_cast<double>(filterPasses - setsOnlyHits) / amountMisses;
+	printf("  %u groups of %u hashes, 1 in %u lookups a hit: sets only %.2f ns, filter + sets %.2f ns, filter only %.2f ns per lookup, %.3f%% false positives\n",
+		   AMOUNT_GROUPS, AMOUNT_HASHES_PER_GROUP, HIT_EVERY, setsOnlyNs, filteredNs, filterOnlyNs, falsePositiveRate * 100.0);
+	CHECK(falsePositiveRate < 0.01);
+#ifdef NDEBUG
+	CHECK(filteredNs < setsOnlyNs);
+#endif
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "HashListCodec.h"
+
+using namespace ShaderToggler;
+
+TEST_CASE(hashListRoundTrips)
+{
+	const std::vector<uint32_t> sortedHashes = { 0u, 0x0000000Au, 0x12345678u, 0xDEADBEEFu, 0xFFFFFFFFu };
+	std::string encodedHashes;
+	encodeHashList(sortedHashes, encodedHashes);
+	CHECK(encodedHashes == "00000000,0000000A,12345678,DEADBEEF,FFFFFFFF");
+	std::vector<uint32_t> decodedHashes;
+	CHECK(decodeHashList(encodedHashes, decodedHashes));
+	CHECK(decodedHashes == sortedHashes);
+
+	std::string encodedDeltas;
+	encodeHashListDelta(sortedHashes, encodedDeltas);
+	CHECK(decodeHashListDelta(encodedDeltas, decodedHashes));
+	CHECK(decodedHashes == sortedHashes);
+}
+
+
+TEST_CASE(hashListDecodeIgnoresWhitespaceAroundValues)
+{
+	std::vector<uint32_t> decodedHashes;
+	CHECK(decodeHashList(" 0000000A, 0000000b ,\t1,2 ", decodedHashes));
+	CHECK((decodedHashes == std::vector<uint32_t>{ 1u, 2u, 0xAu, 0xBu }));
+	CHECK(decodeHashListDelta("A, 1 ,\t2", decodedHashes));
+	CHECK((decodedHashes == std::vector<uint32_t>{ 0xAu, 0xBu, 0xDu }));
+}
+
+
+TEST_CASE(hashListDecodeRejectsMalformedValues)
+{
+	std::vector<uint32_t> decodedHashes;
+	CHECK(!decodeHashList("0000000A,0000000G", decodedHashes));
+	CHECK(decodedHashes.empty());
+	CHECK(!decodeHashList("0000000A,,0000000B", decodedHashes));
+	CHECK(!decodeHashList("123456789", decodedHashes));
+	CHECK(!decodeHashList("0000 000A", decodedHashes));
+	CHECK(!decodeHashListDelta("A,x", decodedHashes));
+}
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "ShaderHashSet.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	constexpr uint32_t AMOUNT_LOOKUPS = 1 << 20;
+	constexpr int AMOUNT_RUNS = 5;
+
+	/// <summary>
+	/// Returns the fastest of AMOUNT_RUNS runs of AMOUNT_LOOKUPS lookups, in nanoseconds per lookup. Half of the looked up hashes are in the
+	/// set. The number of hits is returned as well, so the lookups can't be optimized away.
+	/// </summary>
+	template<typename Set>
+	double measureLookups(const Set& set, const std::vector<uint32_t>& lookups, size_t& amountHits)
+	{
+		double fastestRunNs = 1e9;
+		for(int run = 0; run < AMOUNT_RUNS; run++)
+		{
+			size_t hits = 0;
+			const auto start = std::chrono::steady_clock::now();
+			for(const uint32_t hash : lookups)
+			{
+				hits += set.contains(hash) ? 1 : 0;
+			}
+			const double runNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lookups.size();
+			fastestRunNs = std::min(fastestRunNs, runNs);
+			amountHits = hits;
+		}
+		return fastestRunNs;
+	}
+
+
+	void compareHashSets(uint32_t amountHashes)
+	{
+		std::vector<uint32_t> hashes;
+		for(uint32_t i = 0; i < amountHashes; i++)
+		{
+			hashes.push_back((i + 1) * 2654435761u);
+		}
+		std::vector<uint32_t> lookups;
+		lookups.reserve(AMOUNT_LOOKUPS);
+		uint32_t random = 12345;
+		for(uint32_t i = 0; i < AMOUNT_LOOKUPS; i++)
+		{
+			random = random * 1664525u + 1013904223u;
+			// even lookups hit a hash in the set, odd ones most likely miss.
+			lookups.push_back((i & 1) == 0 ? hashes[random % amountHashes] : random);
+		}
+
+		const std::unordered_set<uint32_t> unorderedSet(hashes.begin(), hashes.end());
+		ShaderHashSet hashSet;
+		hashSet.assign(std::vector<uint32_t>(hashes));
+		// what a copy allocates is what the set keeps, without the temporary allocations of building it.
+		const uint64_t unorderedSetBytes = Tests::countAllocatedBytes([&]() { const std::unordered_set<uint32_t> copy(unorderedSet); });
+		const uint64_t hashSetBytes = Tests::countAllocatedBytes([&]() { const ShaderHashSet copy(hashSet); });
+
+		size_t unorderedSetHits = 0;
+		size_t hashSetHits = 0;
+		const double unorderedSetNs = measureLookups(unorderedSet, lookups, unorderedSetHits);
+		const double hashSetNs = measureLookups(hashSet, lookups, hashSetHits);
+		CHECK(unorderedSetHits == hashSetHits);
+		printf("  %6u hashes: std::unordered_set %9llu bytes, %5.2f ns/lookup; ShaderHashSet %9llu bytes, %5.2f ns/lookup\n", amountHashes,
+			   (unsigned long long)unorderedSetBytes, unorderedSetNs, (unsigned long long)hashSetBytes, hashSetNs);
+		CHECK(hashSetBytes < unorderedSetBytes);
+#ifdef NDEBUG
+		CHECK(hashSetNs <= unorderedSetNs);
+#endif
+	}
+}
+
+
+TEST_CASE(benchmarkHashSetWith10Hashes)
+{
+	compareHashSets(10);
+}
+
+
+TEST_CASE(benchmarkHashSetWith1kHashes)
+{
+	compareHashSets(1000);
+}
+
+
+TEST_CASE(benchmarkHashSetWith100kHashes)
+{
+	compareHashSets(100000);
+}
@@ -0,0 +1,191 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "CDataFile.h"
+#include "IniFileWriter.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	// the hashes per group and stage of the profile in IniFileWriterGolden.ini. That file was written by CDataFile::Save as it was before
+	// IniFileWriter was added, with the SetInt/SetUInt/SetValue/SetBool calls ToggleGroup::saveState did then, plus a negative and an empty value.
+	const std::vector<std::vector<uint32_t>> GOLDEN_HASHES = { { 0x0000000Au, 0xDEADBEEFu, 4000000000u }, { 1u, 2u }, {}, { 42u }, {}, { 0xFFFFFFFFu, 0u } };
+	const char* STAGE_SUFFIXES[3] = { "_VertexShaders", "_PixelShaders", "_ComputeShaders" };
+
+
+	std::string readTextFile(const std::string& fileName)
+	{
+		// text mode, so the comparison doesn't depend on the line endings of the platform or of the checkout.
+		std::ifstream file(fileName);
+		std::stringstream contents;
+		contents << file.rdbuf();
+		return contents.str();
+	}
+
+
+	void writeGoldenProfile(IniFileWriter& iniFile)
+	{
+		iniFile.writeSection("General");
+		iniFile.writeInt("AmountGroups", 2);
+		for(int group = 0; group < 2; group++)
+		{
+			const std::string sectionRoot = "Group" + std::to_string(group);
+			for(int stage = 0; stage < 3; stage++)
+			{
+				iniFile.writeSection(sectionRoot + STAGE_SUFFIXES[stage]);
+				uint32_t counter = 0;
+				for(const uint32_t hash : GOLDEN_HASHES[group * 3 + stage])
+				{
+					iniFile.writeUInt("ShaderHash" + std::to_string(counter), hash);
+					counter++;
+				}
+				iniFile.writeUInt("AmountHashes", counter);
+			}
+			iniFile.writeSection(sectionRoot);
+			iniFile.writeValue("Name", group == 0 ? "Grass and trees" : "UI");
+			iniFile.writeUInt("ToggleKey", group == 0 ? 0x14000000u : 0x70010100u);
+			iniFile.writeBool("IsActiveAtStartup", group == 1);
+			iniFile.writeInt("Priority", -3);
+			iniFile.writeValue("Empty", "");
+		}
+	}
+
+
+	std::string createLongHashList()
+	{
+		// 64 hashes of 8 hex digits, so the line holding them is longer than MAX_BUFFER_LEN.
+		std::string toReturn;
+		char hexDigits[9];
+		for(uint32_t i = 0; i < 64; i++)
+		{
+			snprintf(hexDigits, sizeof(hexDigits), "%08x", i * 2654435761u);
+			toReturn += hexDigits;
+		}
+		return toReturn;
+	}
+
+
+	void writeGoldenProfile(CDataFile& iniFile)
+	{
+		iniFile.SetInt("AmountGroups", 2, "", "General");
+		for(int group = 0; group < 2; group++)
+		{
+			const std::string sectionRoot = "Group" + std::to_string(group);
+			for(int stage = 0; stage < 3; stage++)
+			{
+				int counter = 0;
+				for(const uint32_t hash : GOLDEN_HASHES[group * 3 + stage])
+				{
+					iniFile.SetUInt("ShaderHash" + std::to_string(counter), hash, "", sectionRoot + STAGE_SUFFIXES[stage]);
+					counter++;
+				}
+				iniFile.SetUInt("AmountHashes", counter, "", sectionRoot + STAGE_SUFFIXES[stage]);
+			}
+			iniFile.SetValue("Name", group == 0 ? "Grass and trees" : "UI", "", sectionRoot);
+			iniFile.SetUInt("ToggleKey", group == 0 ? 0x14000000u : 0x70010100u, "", sectionRoot);
+			iniFile.SetBool("IsActiveAtStartup", group == 1, "", sectionRoot);
+			iniFile.SetInt("Priority", -3, "", sectionRoot);
+			iniFile.SetValue("Empty", "", "", sectionRoot);
+		}
+	}
+}
+
+
+TEST_CASE(iniFileWriterOutputMatchesGoldenFile)
+{
+	const std::string fileName = Tests::getTemporaryFileName("IniFileWriterGolden.ini");
+	IniFileWriter iniFile;
+	writeGoldenProfile(iniFile);
+	CHECK(iniFile.save(fileName));
+	const std::string goldenContents = readTextFile(SHADERTOGGLER_TEST_DATA_DIR "/IniFileWriterGolden.ini");
+	CHECK(!goldenContents.empty());
+	CHECK(readTextFile(fileName) == goldenContents);
+	std::filesystem::remove(fileName);
+}
+
+
+TEST_CASE(iniFileWriterOutputMatchesCDataFileSave)
+{
+	const std::string writerFileName = Tests::getTemporaryFileName("IniFileWriterOutput.ini");
+	const std::string cDataFileFileName = Tests::getTemporaryFileName("CDataFileOutput.ini");
+	IniFileWriter writer;
+	writeGoldenProfile(writer);
+	CHECK(writer.save(writerFileName));
+	{
+		CDataFile cDataFile;
+		writeGoldenProfile(cDataFile);
+		cDataFile.SetFileName(cDataFileFileName);
+		CHECK(cDataFile.Save());
+	}
+	CHECK(readTextFile(writerFileName) == readTextFile(cDataFileFileName));
+	std::filesystem::remove(writerFileName);
+	std::filesystem::remove(cDataFileFileName);
+}
+
+
+TEST_CASE(iniFileWriterWritesLinesCDataFileSaveCutsOff)
+{
+	// the one difference to CDataFile::Save: that formats each line into a MAX_BUFFER_LEN buffer and cuts longer lines off, while
+	// IniFileWriter writes them in full, as in IniFileWriterLongLine.ini.
+	const std::string writerFileName = Tests::getTemporaryFileName("IniFileWriterLongLine.ini");
+	const std::string cDataFileFileName = Tests::getTemporaryFileName("CDataFileLongLine.ini");
+	const std::string hashList = createLongHashList();
+	IniFileWriter writer;
+	writer.writeSection("Group0_PixelShaders");
+	writer.writeValue("Hashes", hashList);
+	writer.writeUInt("AmountHashes", 64);
+	CHECK(writer.save(writerFileName));
+	{
+		CDataFile cDataFile;
+		cDataFile.SetValue("Hashes", hashList, "", "Group0_PixelShaders");
+		cDataFile.SetUInt("AmountHashes", 64, "", "Group0_PixelShaders");
+		cDataFile.SetFileName(cDataFileFileName);
+		CHECK(cDataFile.Save());
+	}
+	const std::string goldenContents = readTextFile(SHADERTOGGLER_TEST_DATA_DIR "/IniFileWriterLongLine.ini");
+	const std::string longLine = "Hashes=" + hashList;
+	CHECK(longLine.size() > MAX_BUFFER_LEN);
+	CHECK(goldenContents.find(longLine + "\n") != std::string::npos);
+	CHECK(readTextFile(writerFileName) == goldenContents);
+
+	std::string cutOffContents = goldenContents;
+	cutOffContents.replace(cutOffContents.find(longLine), longLine.size(), longLine.substr(0, MAX_BUFFER_LEN - 1));
+	CHECK(readTextFile(cDataFileFileName) == cutOffContents);
+	std::filesystem::remove(writerFileName);
+	std::filesystem::remove(cDataFileFileName);
+}
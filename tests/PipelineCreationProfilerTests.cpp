@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "PipelineCreationProfiler.h"
+#include "Statistics.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	/// <summary>
+	/// Presents the frame times specified, in ms, with a pipeline created in the frames listed in framesWithPipelines.
+	/// </summary>
+	void replayFrames(PipelineCreationProfiler& profiler, const std::vector<double>& frameTimesMs, const std::vector<uint32_t>& framesWithPipelines)
+	{
+		auto presentTime = std::chrono::steady_clock::now();
+		profiler.onFramePresented(0, presentTime);
+		for(uint32_t frame = 1; frame <= frameTimesMs.size(); frame++)
+		{
+			if(std::find(framesWithPipelines.begin(), framesWithPipelines.end(), frame) != framesWithPipelines.end())
+			{
+				PipelineCreationProfiler::PipelineCreation creation;
+				creation.startTime = presentTime;
+				creation.endTime = presentTime + std::chrono::milliseconds(4);
+				creation.hashingTime = std::chrono::milliseconds(1);
+				creation.frame = frame;
+				profiler.onPipelineCreated(creation);
+			}
+			presentTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(frameTimesMs[frame - 1]));
+			profiler.onFramePresented(frame, presentTime);
+		}
+	}
+}
+
+
+TEST_CASE(pipelineCreationProfilerSummaryFollowsTheFrames)
+{
+	PipelineCreationProfiler profiler;
+	profiler.start();
+	std::vector<double> frameTimesMs(20, 10.0);
+	frameTimesMs[9] = 50.0;
+	frameTimesMs[14] = 40.0;
+	frameTimesMs[19] = 12.0;
+	// frame 10 is a spike with a pipeline created, frame 15 one without, frame 20 has a pipeline created but is no spike.
+	replayFrames(profiler, frameTimesMs, { 10, 20 });
+	const auto summary = profiler.getSummary();
+	CHECK(summary.amountFrames == 20);
+	CHECK(summary.amountPipelinesCreated == 2);
+	CHECK(summary.amountSpikes == 2);
+	CHECK(summary.amountSpikesWithPipelinesCreated == 1);
+	CHECK(std::abs(summary.addOnTimeMs - 8.0) < 0.01);
+	CHECK(std::abs(summary.addOnTimeInSpikesMs - 4.0) < 0.01);
+	CHECK(std::abs(summary.hashingTimeInSpikesMs - 1.0) < 0.01);
+	CHECK(std::abs(summary.medianFrameTimeMs - median(frameTimesMs)) < 0.01);
+
+	// the running median is the one over all frame times, for odd and even amounts.
+	for(size_t amountFrames = 1; amountFrames <= 9; amountFrames++)
+	{
+		std::vector<double> shuffledTimesMs;
+		for(size_t i = 0; i < amountFrames; i++)
+		{
+			shuffledTimesMs.push_back(static_cast<double>((i * 7) % 11 + 1));
+		}
+		profiler.start();
+		replayFrames(profiler, shuffledTimesMs, {});
+		CHECK(std::abs(profiler.getSummary().medianFrameTimeMs - median(shuffledTimesMs)) < 0.01);
+	}
+}
+
+
+TEST_CASE(pipelineCreationProfilerWritesChromeTrace)
+{
+	PipelineCreationProfiler profiler;
+	profiler.start();
+	std::vector<double> frameTimesMs(10, 10.0);
+	frameTimesMs[5] = 50.0;
+	replayFrames(profiler, frameTimesMs, { 6 });
+	const std::string traceFileName = Tests::getTemporaryFileName("PipelineTrace.json");
+	std::string errorMessage;
+	CHECK(profiler.writeChromeTrace(traceFileName, errorMessage));
+	std::ifstream file(traceFileName);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	file.close();
+	CHECK(contents.str().find("\"name\":\"Frame 6 (spike)\"") != std::string::npos);
+	CHECK(contents.str().find("\"pipelinesCreated\":1,\"isSpike\":true") != std::string::npos);
+	CHECK(contents.str().find("\"name\":\"init_pipeline\"") != std::string::npos);
+	std::filesystem::remove(traceFileName);
+}
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include "ProfileHotReloader.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	ToggleGroup makeGroup(const std::string& name, std::unordered_set<uint32_t> pixelShaderHashes)
+	{
+		ToggleGroup toReturn(name, ToggleGroup::getNewGroupId());
+		toReturn.storeCollectedHashes(pixelShaderHashes, {}, {});
+		return toReturn;
+	}
+}
+
+
+TEST_CASE(applyProfileChangesKeepsUnchangedGroups)
+{
+	std::vector<ToggleGroup> liveGroups = { makeGroup("Trees", { 1, 2 }), makeGroup("Fog", { 3 }) };
+	liveGroups[0].toggleActive();
+	const int treesId = liveGroups[0].getId();
+	std::vector<ToggleGroup> reloadedGroups = { makeGroup("Trees", { 1, 2 }), makeGroup("Fog", { 3 }) };
+	const ProfileHotReloader::ChangeSummary changes = ProfileHotReloader::applyProfileChanges(liveGroups, std::move(reloadedGroups));
+	CHECK(changes.groupsChanged == 0 && changes.groupsAdded == 0 && changes.groupsRemoved == 0);
+	CHECK(liveGroups.size() == 2);
+	CHECK(liveGroups[0].getId() == treesId && liveGroups[0].isActive());
+}
+
+
+TEST_CASE(applyProfileChangesUpdatesChangedGroups)
+{
+	std::vector<ToggleGroup> liveGroups = { makeGroup("Trees", { 1, 2 }), makeGroup("Fog", { 3 }) };
+	liveGroups[1].toggleActive();
+	const int fogId = liveGroups[1].getId();
+	std::vector<ToggleGroup> reloadedGroups = { makeGroup("Trees", { 1, 2 }), makeGroup("Fog", { 3, 4 }) };
+	reloadedGroups[0].setThrottle(DrawThrottleMode::KeepEveryNthDraw, 3);
+	const ProfileHotReloader::ChangeSummary changes = ProfileHotReloader::applyProfileChanges(liveGroups, std::move(reloadedGroups));
+	CHECK(changes.groupsChanged == 2 && changes.groupsAdded == 0 && changes.groupsRemoved == 0);
+	CHECK(liveGroups[0].getThrottleMode() == DrawThrottleMode::KeepEveryNthDraw && liveGroups[0].getThrottleValue() == 3);
+	// the new definition, but the same id and still toggled on.
+	CHECK(liveGroups[1].getPixelShaderHashes().size() == 2);
+	CHECK(liveGroups[1].getId() == fogId && liveGroups[1].isActive());
+}
+
+
+TEST_CASE(applyProfileChangesAddsAndRemovesGroups)
+{
+	std::vector<ToggleGroup> liveGroups = { makeGroup("Trees", { 1 }), makeGroup("Fog", { 2 }), makeGroup("Grass", { 3 }) };
+	liveGroups[2].toggleActive();
+	const int grassId = liveGroups[2].getId();
+	// Fog removed from the middle, so Grass moves up a position, and Water added.
+	std::vector<ToggleGroup> reloadedGroups = { makeGroup("Trees", { 1 }), makeGroup("Grass", { 3 }), makeGroup("Water", { 4 }) };
+	const ProfileHotReloader::ChangeSummary changes = ProfileHotReloader::applyProfileChanges(liveGroups, std::move(reloadedGroups));
+	CHECK(changes.groupsChanged == 0 && changes.groupsAdded == 1 && changes.groupsRemoved == 1);
+	CHECK(liveGroups.size() == 3);
+	CHECK(liveGroups[1].getName() == "Grass" && liveGroups[1].getId() == grassId && liveGroups[1].isActive());
+	CHECK(liveGroups[2].getName() == "Water" && !liveGroups[2].isActive());
+}
+
+
+TEST_CASE(applyProfileChangesMatchesGroupsByName)
+{
+	std::vector<ToggleGroup> liveGroups = { makeGroup("Trees", { 1 }), makeGroup("Fog", { 2 }) };
+	liveGroups[1].toggleActive();
+	const int fogId = liveGroups[1].getId();
+	std::vector<ToggleGroup> reloadedGroups = { makeGroup("Fog", { 2 }), makeGroup("Trees", { 1 }) };
+	const ProfileHotReloader::ChangeSummary changes = ProfileHotReloader::applyProfileChanges(liveGroups, std::move(reloadedGroups));
+	CHECK(changes.groupsChanged == 0 && changes.groupsAdded == 0 && changes.groupsRemoved == 0);
+	// in file order, with the state following the group.
+	CHECK(liveGroups[0].getName() == "Fog" && liveGroups[0].getId() == fogId && liveGroups[0].isActive());
+	CHECK(liveGroups[1].getName() == "Trees" && !liveGroups[1].isActive());
+}
+
+
+TEST_CASE(applyProfileChangesMatchesDuplicateNamesByPosition)
+{
+	std::vector<ToggleGroup> liveGroups = { makeGroup("Group", { 1 }), makeGroup("Other", { 2 }), makeGroup("Group", { 3 }) };
+	liveGroups[2].toggleActive();
+	const int secondId = liveGroups[2].getId();
+	// the first of the two is removed: the remaining one is matched with the first live group of that name.
+	std::vector<ToggleGroup> reloadedGroups = { makeGroup("Other", { 2 }), makeGroup("Group", { 3 }) };
+	const ProfileHotReloader::ChangeSummary changes = ProfileHotReloader::applyProfileChanges(liveGroups, std::move(reloadedGroups));
+	CHECK(changes.groupsChanged == 1 && changes.groupsAdded == 0 && changes.groupsRemoved == 1);
+	CHECK(liveGroups.size() == 2);
+	CHECK(liveGroups[1].getName() == "Group" && liveGroups[1].getId() != secondId && !liveGroups[1].isActive());
+	CHECK(liveGroups[1].getPixelShaderHashes().size() == 1 && *liveGroups[1].getPixelShaderHashes().begin() == 3);
+}
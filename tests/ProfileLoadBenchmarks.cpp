@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+
+#include "ProfileLoader.h"
+#include "ProfileSaver.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	constexpr int AMOUNT_RUNS = 20;
+	constexpr uint32_t AMOUNT_HASHES = 10000;
+	constexpr double LOAD_BUDGET_MS = 1.0;
+
+
+	ProfileSnapshot createProfileWithHashes(uint32_t amountHashes)
+	{
+		std::unordered_set<uint32_t> hashes[3];
+		for(uint32_t i = 0; i < amountHashes; i++)
+		{
+			hashes[i % 3].insert(i * 2654435761u);
+		}
+		ProfileSnapshot toReturn;
+		ToggleGroup group("Benchmark", ToggleGroup::getNewGroupId());
+		group.storeCollectedHashes(hashes[0], hashes[1], hashes[2]);
+		toReturn.groups.push_back(group);
+		return toReturn;
+	}
+
+
+	/// <summary>
+	/// Runs the function specified AMOUNT_RUNS times and returns the fastest run, in milliseconds. The first run warms up the file cache.
+	/// </summary>
+	template<typename Function>
+	double measureFastestRun(Function function)
+	{
+		double fastestRunMs = 1e9;
+		for(int i = 0; i < AMOUNT_RUNS; i++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			fastestRunMs = std::min(fastestRunMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return fastestRunMs;
+	}
+}
+
+
+TEST_CASE(benchmarkLoadIniProfileWith10kHashes)
+{
+	// the v2 layout, with one packed hash list per stage.
+	const std::string iniFileName = Tests::getTemporaryFileName("Benchmark10k.ini");
+	std::string errorMessage;
+	const ProfileSnapshot profile = createProfileWithHashes(AMOUNT_HASHES);
+	CHECK(ProfileSaver::writeIniFile(profile, iniFileName, errorMessage));
+
+	size_t amountHashesLoaded = 0;
+	const double iniLoadMs = measureFastestRun([&]()
+		{
+			ProfileSnapshot loaded;
+			ProfileLoader::loadIniFile(iniFileName, loaded);
+			const ToggleGroup& group = loaded.groups.front();
+			amountHashesLoaded = group.getPixelShaderHashes().size() + group.getVertexShaderHashes().size() + group.getComputeShaderHashes().size();
+		});
+	printf("  ini file: %.3f ms for %u hashes\n", iniLoadMs, AMOUNT_HASHES);
+	CHECK(amountHashesLoaded == AMOUNT_HASHES);
+#ifdef NDEBUG
+	CHECK(iniLoadMs < LOAD_BUDGET_MS);
+#endif
+	std::filesystem::remove(iniFileName);
+}
+
+
+TEST_CASE(benchmarkLoadCompiledProfileWith10kHashes)
+{
+	const std::string iniFileName = Tests::getTemporaryFileName("BenchmarkCompiled10k.ini");
+	const std::string compiledProfileFileName = Tests::getTemporaryFileName("BenchmarkCompiled10k.bin");
+	std::string errorMessage;
+	const ProfileSnapshot profile = createProfileWithHashes(AMOUNT_HASHES);
+	CHECK(ProfileSaver::writeIniFile(profile, iniFileName, errorMessage));
+	CHECK(ProfileSaver::writeCompiledProfile(profile, FileStamp::read(iniFileName), compiledProfileFileName, errorMessage));
+
+	// both through loadProfile, as at startup: the compiled profile when it matches the ini file, the ini file when there's none.
+	const double iniLoadMs = measureFastestRun([&]()
+		{
+			ProfileSnapshot loaded;
+			ProfileLoader::loadIniFile(iniFileName, loaded);
+		});
+	size_t amountHashesLoaded = 0;
+	const double compiledLoadMs = measureFastestRun([&]()
+		{
+			ProfileSnapshot loaded;
+			ProfileLoader::loadProfile(iniFileName, compiledProfileFileName, loaded);
+			const ToggleGroup& group = loaded.groups.front();
+			amountHashesLoaded = group.getPixelShaderHashes().size() + group.getVertexShaderHashes().size() + group.getComputeShaderHashes().size();
+		});
+	printf("  ini file: %.3f ms, compiled profile: %.3f ms for %u hashes\n", iniLoadMs, compiledLoadMs, AMOUNT_HASHES);
+	CHECK(amountHashesLoaded == AMOUNT_HASHES);
+#ifdef NDEBUG
+	CHECK(compiledLoadMs < LOAD_BUDGET_MS);
+	CHECK(compiledLoadMs < iniLoadMs);
+#endif
+	std::filesystem::remove(iniFileName);
+	std::filesystem::remove(compiledProfileFileName);
+}
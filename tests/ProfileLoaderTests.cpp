@@ -0,0 +1,325 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <fstream>
+#include <unordered_set>
+
+#include "CompiledProfile.h"
+#include "ProfileLoader.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	void writeTextFile(const std::string& fileName, const std::string& contents)
+	{
+		std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+		file << contents;
+	}
+}
+
+
+TEST_CASE(profileLoaderReportsUnreadableHashLists)
+{
+	const std::string iniFileName = Tests::getTemporaryFileName("UnreadableHashList.ini");
+	const std::string compiledProfileFileName = Tests::getTemporaryFileName("UnreadableHashList.bin");
+	std::filesystem::remove(compiledProfileFileName);
+	writeTextFile(iniFileName, "[General]\nFormatVersion=2\nAmountGroups=1\n[Group0_PixelShaders]\nHashes=0000000A,XYZ\n[Group0_VertexShaders]\nHashes= 0000000B, 0000000C\n"
+				  "[Group0]\nName=Trees\n");
+	ProfileSnapshot loaded;
+	CHECK(ProfileLoader::loadProfile(iniFileName, compiledProfileFileName, loaded));
+	CHECK(loaded.loadError.empty());
+	CHECK(loaded.groups.size() == 1);
+	const ToggleGroup& group = loaded.groups.front();
+	CHECK(group.getPixelShaderHashes().size() == 0);
+	CHECK(group.getVertexShaderHashes().size() == 2);
+	CHECK(group.getLoadError().find("[Group0_PixelShaders]") != std::string::npos);
+	CHECK(group.getLoadError().find("[Group0_VertexShaders]") == std::string::npos);
+	// the compiled profile would have the list missing as well, and would be used instead of the ini file once that's fixed.
+	CHECK(!std::filesystem::exists(compiledProfileFileName));
+	std::filesystem::remove(iniFileName);
+}
+
+
+TEST_CASE(profileLoaderRefusesNewerFormatVersion)
+{
+	const std::string iniFileName = Tests::getTemporaryFileName("NewerFormat.ini");
+	const std::string compiledProfileFileName = Tests::getTemporaryFileName("NewerFormat.bin");
+	std::filesystem::remove(compiledProfileFileName);
+	writeTextFile(iniFileName, "[General]\nFormatVersion=" + std::to_string(ProfileSaver::INI_FORMAT_VERSION + 1) + "\nAmountGroups=1\n[Group0]\nName=Trees\n");
+	ProfileSnapshot loaded;
+	CHECK(ProfileLoader::loadProfile(iniFileName, compiledProfileFileName, loaded));
+	CHECK(!loaded.loadError.empty());
+	CHECK(loaded.groups.empty());
+	CHECK(!std::filesystem::exists(compiledProfileFileName));
+	std::filesystem::remove(iniFileName);
+}
+
+
+TEST_CASE(profileSaverWritesFormatVersion)
+{
+	const std::string iniFileName = Tests::getTemporaryFileName("FormatVersion.ini");
+	ProfileSnapshot profile;
+	profile.groups.push_back(ToggleGroup("Trees", ToggleGroup::getNewGroupId()));
+	std::string errorMessage;
+	CHECK(ProfileSaver::writeIniFile(profile, iniFileName, errorMessage));
+	CDataFile iniFile;
+	CHECK(iniFile.Load(iniFileName));
+	CHECK(iniFile.GetInt("FormatVersion", "General") == ProfileSaver::INI_FORMAT_VERSION);
+	iniFile.Clear();
+	std::filesystem::remove(iniFileName);
+}
+
+
+TEST_CASE(compiledProfileIsOnlyUsedForTheIniFileItWasCompiledFrom)
+{
+	const std::string iniFileName = Tests::getTemporaryFileName("CompiledFrom.ini");
+	const std::string compiledProfileFileName = Tests::getTemporaryFileName("CompiledFrom.bin");
+	writeTextFile(iniFileName, "[General]\nFormatVersion=2\nAmountGroups=1\n[Group0]\nName=FromIni\n");
+	// a compiled profile with different contents than the ini file, so it's visible which of the two was read.
+	ProfileSnapshot compiled;
+	compiled.groups.push_back(ToggleGroup("FromCompiledProfile", ToggleGroup::getNewGroupId()));
+	std::string errorMessage;
+	CHECK(ProfileSaver::writeCompiledProfile(compiled, FileStamp::read(iniFileName), compiledProfileFileName, errorMessage));
+	{
+		ProfileSnapshot loaded;
+		CHECK(ProfileLoader::loadProfile(iniFileName, compiledProfileFileName, loaded));
+		CHECK(loaded.groups.size() == 1 && loaded.groups.front().getName() == "FromCompiledProfile");
+	}
+
+	// an ini file copied over it which is older than the compiled profile, as with a restored backup or a shared profile.
+	const auto compiledWriteTime = std::filesystem::last_write_time(compiledProfileFileName);
+	writeTextFile(iniFileName, "[General]\nFormatVersion=2\nAmountGroups=1\n[Group0]\nName=CopiedIni\n");
+	std::filesystem::last_write_time(iniFileName, compiledWriteTime - std::chrono::hours(24));
+	{
+		ProfileSnapshot loaded;
+		CHECK(ProfileLoader::loadProfile(iniFileName, compiledProfileFileName, loaded));
+		CHECK(loaded.groups.size() == 1 && loaded.groups.front().getName() == "CopiedIni");
+	}
+	{
+		// and the compiled profile was regenerated from it.
+		CompiledProfile regenerated;
+		CHECK(regenerated.open(compiledProfileFileName));
+		CHECK(regenerated.isCompiledFrom(FileStamp::read(iniFileName)));
+		CHECK(regenerated.getGroupCount() == 1 && regenerated.getGroupName(0) == "CopiedIni");
+	}
+	std::filesystem::remove(iniFileName);
+	std::filesystem::remove(compiledProfileFileName);
+}
+
+
+TEST_CASE(compiledProfileWriteReplacesTheFileAsAWhole)
+{
+	const std::string compiledProfileFileName = Tests::getTemporaryFileName("Replaced.bin");
+	const FileStamp sourceFileStamp;
+	CHECK(CompiledProfile::write(compiledProfileFileName, { ToggleGroup("Old", ToggleGroup::getNewGroupId()) }, 0, sourceFileStamp));
+	CompiledProfile opened;
+	CHECK(opened.open(compiledProfileFileName));
+
+	// the profile opened keeps reading the file it mapped, while the name now refers to the new one.
+	CHECK(CompiledProfile::write(compiledProfileFileName, { ToggleGroup("New", ToggleGroup::getNewGroupId()) }, 0, sourceFileStamp));
+	CHECK(opened.getGroupCount() == 1 && opened.getGroupName(0) == "Old");
+	CHECK(!std::filesystem::exists(compiledProfileFileName + ".tmp"));
+	CompiledProfile reopened;
+	CHECK(reopened.open(compiledProfileFileName));
+	CHECK(reopened.getGroupCount() == 1 && reopened.getGroupName(0) == "New");
+	std::filesystem::remove(compiledProfileFileName);
+}
+
+
+TEST_CASE(compiledProfileHashSetsOutliveTheProfile)
+{
+	const std::string compiledProfileFileName = Tests::getTemporaryFileName("InPlace.bin");
+	const FileStamp sourceFileStamp;
+	// a small and a large set, which have different layouts.
+	std::unordered_set<uint32_t> pixelShaderHashes;
+	std::unordered_set<uint32_t> vertexShaderHashes;
+	for(uint32_t i = 0; i < 1000; i++)
+	{
+		pixelShaderHashes.insert(i * 2654435761u);
+	}
+	for(uint32_t i = 0; i < 10; i++)
+	{
+		vertexShaderHashes.insert(i * 40503u);
+	}
+	ToggleGroup written("InPlace", ToggleGroup::getNewGroupId());
+	written.storeCollectedHashes(pixelShaderHashes, vertexShaderHashes, {});
+	CHECK(CompiledProfile::write(compiledProfileFileName, { written }, 0, sourceFileStamp));
+
+	ToggleGroup loaded("", ToggleGroup::getNewGroupId());
+	{
+		CompiledProfile profile;
+		CHECK(profile.open(compiledProfileFileName));
+		loaded.loadState(profile, 0);
+	}
+	// the sets keep the mapping alive, also when the file is replaced.
+	CHECK(CompiledProfile::write(compiledProfileFileName, { ToggleGroup("New", ToggleGroup::getNewGroupId()) }, 0, sourceFileStamp));
+	CHECK(loaded.getPixelShaderHashes() == written.getPixelShaderHashes());
+	CHECK(loaded.getVertexShaderHashes() == written.getVertexShaderHashes());
+	CHECK(loaded.getComputeShaderHashes().empty());
+	bool allFound = true;
+	for(const uint32_t hash : pixelShaderHashes)
+	{
+		allFound &= loaded.getPixelShaderHashes().contains(hash) && !loaded.getPixelShaderHashes().contains(hash + 1);
+	}
+	CHECK(allFound);
+	std::filesystem::remove(compiledProfileFileName);
+}
+
+
+TEST_CASE(profileSaverFlushesPendingSaveWhenStopped)
+{
+	const std::string iniFileName = Tests::getTemporaryFileName("Flush.ini");
+	const std::string compiledProfileFileName = Tests::getTemporaryFileName("Flush.bin");
+	std::filesystem::remove(iniFileName);
+	std::filesystem::remove(compiledProfileFileName);
+	{
+		ProfileSaver saver;
+		saver.setFileNames(iniFileName, compiledProfileFileName);
+		ProfileSnapshot profile;
+		profile.groups.push_back(ToggleGroup("Trees", ToggleGroup::getNewGroupId()));
+		// a debounced autosave which would otherwise only be written long after the saver is gone.
+		saver.requestSave(std::move(profile), std::chrono::hours(1));
+		saver.stop();
+		CHECK(saver.getStatus().state == ProfileSaver::SaveState::Succeeded);
+	}
+	ProfileSnapshot loaded;
+	CHECK(ProfileLoader::loadProfile(iniFileName, compiledProfileFileName, loaded));
+	CHECK(loaded.groups.size() == 1 && loaded.groups.front().getName() == "Trees");
+	std::filesystem::remove(iniFileName);
+	std::filesystem::remove(compiledProfileFileName);
+}
+
+
+TEST_CASE(profileLoaderLoadsOnceAndJoins)
+{
+	const std::string iniFileName = Tests::getTemporaryFileName("LoadOnce.ini");
+	const std::string compiledProfileFileName = Tests::getTemporaryFileName("LoadOnce.bin");
+	std::filesystem::remove(compiledProfileFileName);
+	writeTextFile(iniFileName, "[General]\nFormatVersion=2\nAmountGroups=1\n[Group0]\nName=Trees\n");
+	ProfileLoader loader;
+	loader.startLoading(iniFileName, compiledProfileFileName);
+	// a second runtime being created doesn't start another load.
+	loader.startLoading(iniFileName, compiledProfileFileName);
+	loader.stop();
+	CHECK(loader.isLoaded());
+	const std::unique_ptr<ProfileSnapshot> loaded = loader.takeLoadedProfile();
+	CHECK(nullptr != loaded && loaded->groups.size() == 1);
+	CHECK(nullptr == loader.takeLoadedProfile());
+	std::filesystem::remove(iniFileName);
+	std::filesystem::remove(compiledProfileFileName);
+}
+
+
+TEST_CASE(profileLoaderRefusesIncompleteIniFiles)
+{
+	const std::string iniFileName = Tests::getTemporaryFileName("Incomplete.ini");
+	const std::string compiledProfileFileName = Tests::getTemporaryFileName("Incomplete.bin");
+	const std::string incompleteContents[] =
+	{
+		"",
+		"[General]\nFormatVersion=2\n",
+		// cut short after the hash lists of the second group.
+		"[General]\nFormatVersion=2\nAmountGroups=2\n[Group0]\nName=Trees\n[Group1_PixelShaders]\nHashes=0000000A\n",
+		"[General]\nFormatVersion=2\nAmountGroups=-1\n",
+	};
+	for(const auto& contents : incompleteContents)
+	{
+		std::filesystem::remove(compiledProfileFileName);
+		writeTextFile(iniFileName, contents);
+		ProfileSnapshot loaded;
+		CHECK(ProfileLoader::loadIniFile(iniFileName, loaded));
+		CHECK(!loaded.loadError.empty());
+		CHECK(loaded.groups.empty());
+		CHECK(ProfileLoader::loadProfile(iniFileName, compiledProfileFileName, loaded));
+		CHECK(!std::filesystem::exists(compiledProfileFileName));
+	}
+
+	// no groups at all is fine, if that's what the file says.
+	writeTextFile(iniFileName, "[General]\nFormatVersion=2\nAmountGroups=0\n");
+	ProfileSnapshot loaded;
+	CHECK(ProfileLoader::loadIniFile(iniFileName, loaded));
+	CHECK(loaded.loadError.empty());
+
+	// and a pre 1.0 file, which has no AmountGroups, is still read.
+	writeTextFile(iniFileName, "[PixelShaders]\nAmountHashes=1\nShaderHash0=10\n");
+	ProfileSnapshot pre10;
+	CHECK(ProfileLoader::loadIniFile(iniFileName, pre10));
+	CHECK(pre10.loadError.empty());
+	CHECK(pre10.groups.size() == 1);
+	std::filesystem::remove(iniFileName);
+	std::filesystem::remove(compiledProfileFileName);
+}
+
+
+TEST_CASE(profileLoaderClampsThrottleValues)
+{
+	const std::string iniFileName = Tests::getTemporaryFileName("ThrottleValues.ini");
+	const std::string compiledProfileFileName = Tests::getTemporaryFileName("ThrottleValues.bin");
+	std::filesystem::remove(compiledProfileFileName);
+	// a hand edited file: reduced to 500% of the instances, and keeping every 0th draw.
+	writeTextFile(iniFileName, "[General]\nFormatVersion=2\nAmountGroups=2\n[Group0]\nName=Trees\nThrottleMode=3\nThrottleValue=500\n"
+				  "[Group1]\nName=Grass\nThrottleMode=1\nThrottleValue=0\n");
+	for(int pass = 0; pass < 2; pass++)
+	{
+		// the first pass reads the ini file and compiles it, the second one reads the compiled profile.
+		ProfileSnapshot loaded;
+		CHECK(ProfileLoader::loadProfile(iniFileName, compiledProfileFileName, loaded));
+		CHECK(loaded.groups.size() == 2);
+		CHECK(loaded.groups[0].getThrottleMode() == DrawThrottleMode::ReduceInstances);
+		CHECK(loaded.groups[0].getThrottleValue() == DrawThrottleCounters::ALL_INSTANCES);
+		CHECK(loaded.groups[1].getThrottleMode() == DrawThrottleMode::KeepEveryNthDraw);
+		CHECK(loaded.groups[1].getThrottleValue() == 1);
+		CHECK(std::filesystem::exists(compiledProfileFileName));
+	}
+	std::filesystem::remove(iniFileName);
+	std::filesystem::remove(compiledProfileFileName);
+}
+
+
+TEST_CASE(toggleGroupOverflowsThrottleSlotsOnlyWhenCountingDraws)
+{
+	ToggleGroup group("Trees", ToggleGroup::getNewGroupId());
+	group.toggleActive();
+	group.setThrottle(DrawThrottleMode::KeepFirstDrawsPerFrame, 10);
+	group.setThrottleSlot(DrawThrottleCounters::NO_SLOT);
+	CHECK(group.isThrottleOverflowing());
+	group.setThrottleSlot(0);
+	CHECK(!group.isThrottleOverflowing());
+	group.setThrottle(DrawThrottleMode::HideAll, 10);
+	group.setThrottleSlot(DrawThrottleCounters::NO_SLOT);
+	CHECK(!group.isThrottleOverflowing());
+	group.setThrottle(DrawThrottleMode::ReduceInstances, 0);
+	CHECK(group.getThrottleValue() == 1);
+	CHECK(!group.isThrottleOverflowing());
+}
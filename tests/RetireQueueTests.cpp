@@ -0,0 +1,208 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RetireQueue.h"
+
+using namespace ShaderToggler;
+
+namespace
+{
+	/// <summary>
+	/// A published object which counts its destruction and overwrites its contents when destroyed, so a reader of a freed object can notice.
+	/// Its memory isn't handed back to the heap until freeDestroyedValues, so a new object can't take its place and hide a late read.
+	/// </summary>
+	struct PublishedValue
+	{
+		static constexpr uint32_t ALIVE = 0xA11FE;
+
+		static void* operator new(size_t size) { return ::operator new(size); }
+		static void operator delete(void* toDelete)
+		{
+			std::lock_guard lock(getDestroyedValuesMutex());
+			getDestroyedValues().push_back(toDelete);
+		}
+		static std::mutex& getDestroyedValuesMutex()
+		{
+			static std::mutex destroyedValuesMutex;
+			return destroyedValuesMutex;
+		}
+		static std::vector<void*>& getDestroyedValues()
+		{
+			static std::vector<void*> destroyedValues;
+			return destroyedValues;
+		}
+		static void freeDestroyedValues()
+		{
+			std::lock_guard lock(getDestroyedValuesMutex());
+			for(void* destroyedValue : getDestroyedValues())
+			{
+				::operator delete(destroyedValue);
+			}
+			getDestroyedValues().clear();
+		}
+
+		explicit PublishedValue(std::atomic<int>* amountDestroyed): amountDestroyed(amountDestroyed) {}
+		~PublishedValue()
+		{
+			marker.store(0, std::memory_order_relaxed);
+			if(nullptr != amountDestroyed)
+			{
+				amountDestroyed->fetch_add(1);
+			}
+		}
+
+		std::atomic<uint32_t> marker = ALIVE;
+		std::atomic<int>* amountDestroyed;
+	};
+
+	/// <summary>
+	/// Spins until the flag specified is set.
+	/// </summary>
+	void waitFor(const std::atomic_bool& flag)
+	{
+		while(!flag.load())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+
+TEST_CASE(retiredObjectIsKeptWhileAReaderHoldsIt)
+{
+	std::atomic<int> amountDestroyed = 0;
+	std::atomic<const PublishedValue*> published = new PublishedValue(&amountDestroyed);
+	std::atomic_bool hasLoaded = false;
+	std::atomic_bool mayLeave = false;
+	bool readerSawFreedValue = false;
+	// a reader which loads the published object and is then held up for as long as the test wants, as a preempted draw call would be.
+	std::thread reader([&]()
+	{
+		const ReaderEpochs::ReadSection readSection;
+		const PublishedValue* value = published.load(std::memory_order_acquire);
+		hasLoaded = true;
+		waitFor(mayLeave);
+		readerSawFreedValue = value->marker.load() != PublishedValue::ALIVE;
+	});
+	waitFor(hasLoaded);
+	RetireQueue<PublishedValue> retireQueue;
+	retireQueue.retire(published.exchange(new PublishedValue(&amountDestroyed)));
+	for(int frame = 0; frame < 100; frame++)
+	{
+		retireQueue.collect();
+	}
+	CHECK(amountDestroyed == 0);
+	CHECK(retireQueue.size() == 1);
+	mayLeave = true;
+	reader.join();
+	retireQueue.collect();
+	CHECK(!readerSawFreedValue);
+	CHECK(amountDestroyed == 1);
+	CHECK(retireQueue.size() == 0);
+	delete published.load();
+	PublishedValue::freeDestroyedValues();
+}
+
+
+TEST_CASE(readerStartingAfterRetireDoesNotKeepRetiredObject)
+{
+	std::atomic<int> amountDestroyed = 0;
+	RetireQueue<PublishedValue> retireQueue;
+	retireQueue.retire(new PublishedValue(&amountDestroyed));
+	{
+		// a section started after the object was replaced can't have loaded it, nested sections included.
+		const ReaderEpochs::ReadSection readSection;
+		const ReaderEpochs::ReadSection nestedReadSection;
+		retireQueue.collect();
+		CHECK(amountDestroyed == 1);
+		retireQueue.retire(new PublishedValue(&amountDestroyed));
+		retireQueue.collect();
+		CHECK(amountDestroyed == 1);
+	}
+	retireQueue.collect();
+	CHECK(amountDestroyed == 2);
+	CHECK(ReaderEpochs::getOldestReadEpoch() == ReaderEpochs::NOT_READING);
+	PublishedValue::freeDestroyedValues();
+}
+
+
+TEST_CASE(readersNeverSeeFreedObjects)
+{
+	// readers keep loading and reading the published object while it's replaced and the replaced ones are freed as fast as possible.
+	std::atomic<const PublishedValue*> published = new PublishedValue(nullptr);
+	std::atomic_bool stopReading = false;
+	std::atomic<uint64_t> amountFreedValuesSeen = 0;
+	std::atomic<uint64_t> amountReads = 0;
+	std::vector<std::thread> readers;
+	for(int i = 0; i < 4; i++)
+	{
+		readers.emplace_back([&]()
+		{
+			while(!stopReading.load(std::memory_order_relaxed))
+			{
+				const ReaderEpochs::ReadSection readSection;
+				const PublishedValue* value = published.load(std::memory_order_acquire);
+				for(int read = 0; read < 16; read++)
+				{
+					amountFreedValuesSeen += value->marker.load(std::memory_order_relaxed) != PublishedValue::ALIVE ? 1 : 0;
+				}
+				amountReads.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	}
+	while(amountReads.load() == 0)
+	{
+		std::this_thread::yield();
+	}
+	RetireQueue<PublishedValue> retireQueue;
+	for(int frame = 0; frame < 20000; frame++)
+	{
+		retireQueue.retire(published.exchange(new PublishedValue(nullptr), std::memory_order_acq_rel));
+		retireQueue.collect();
+	}
+	stopReading = true;
+	for(auto& reader : readers)
+	{
+		reader.join();
+	}
+	retireQueue.collect();
+	CHECK(amountFreedValuesSeen == 0);
+	CHECK(retireQueue.size() == 0);
+	delete published.load();
+	PublishedValue::freeDestroyedValues();
+}
@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "ShaderHashSet.h"
+
+using namespace ShaderToggler;
+
+TEST_CASE(shaderHashSetFindsExactlyItsHashes)
+{
+	// every size up to well past the small set limit, so each shape of the partly filled deepest level is covered.
+	for(uint32_t amountHashes = 1; amountHashes <= 600; amountHashes++)
+	{
+		std::vector<uint32_t> hashes;
+		for(uint32_t i = 0; i < amountHashes; i++)
+		{
+			// even values only, so each odd value between them is a miss.
+			hashes.push_back(2 * (i + 1) * 1000);
+		}
+		ShaderHashSet hashSet;
+		hashSet.assign(std::vector<uint32_t>(hashes));
+		CHECK(hashSet.size() == amountHashes);
+		bool allFound = true;
+		bool noneFoundWrongly = !hashSet.contains(0) && !hashSet.contains(UINT32_MAX);
+		for(const uint32_t hash : hashes)
+		{
+			allFound &= hashSet.contains(hash);
+			noneFoundWrongly &= !hashSet.contains(hash + 1) && !hashSet.contains(hash - 1);
+		}
+		CHECK(allFound);
+		CHECK(noneFoundWrongly);
+	}
+}
+
+
+TEST_CASE(shaderHashSetFindsHashesWhichDifferInFewBits)
+{
+	// hashes which only differ in their highest or lowest bits are the hardest case for the multiplicative hashing of the perfect hash.
+	std::vector<uint32_t> hashes;
+	for(uint32_t i = 0; i < 4096; i++)
+	{
+		hashes.push_back(i << 20);
+		hashes.push_back((i << 1) | 1);
+	}
+	ShaderHashSet hashSet;
+	hashSet.assign(std::vector<uint32_t>(hashes));
+	CHECK(hashSet.size() == hashes.size());
+	bool allFound = true;
+	bool noneFoundWrongly = true;
+	for(const uint32_t hash : hashes)
+	{
+		allFound &= hashSet.contains(hash);
+		noneFoundWrongly &= !hashSet.contains(hash ^ 0x00080000);
+	}
+	CHECK(allFound);
+	CHECK(noneFoundWrongly);
+}
+
+
+TEST_CASE(shaderHashSetIteratesItsHashesSorted)
+{
+	for(const uint32_t amountHashes : { 5u, 500u })
+	{
+		std::vector<uint32_t> hashes;
+		for(uint32_t i = 0; i < amountHashes; i++)
+		{
+			hashes.push_back((i + 1) * 2654435761u);
+		}
+		// duplicates are dropped.
+		hashes.push_back(hashes.front());
+		ShaderHashSet hashSet;
+		hashSet.assign(std::vector<uint32_t>(hashes));
+		hashes.pop_back();
+		std::sort(hashes.begin(), hashes.end());
+		CHECK(hashSet.size() == amountHashes);
+		CHECK(std::equal(hashSet.begin(), hashSet.end(), hashes.begin(), hashes.end()));
+
+		ShaderHashSet sameHashes;
+		sameHashes.assignSorted(hashes);
+		CHECK(sameHashes == hashSet);
+	}
+}
+
+
+TEST_CASE(shaderHashSetUsesAStoredLayoutInPlace)
+{
+	for(const uint32_t amountHashes : { 5u, 500u })
+	{
+		std::vector<uint32_t> hashes;
+		for(uint32_t i = 0; i < amountHashes; i++)
+		{
+			hashes.push_back((i + 1) * 2654435761u);
+		}
+		ShaderHashSet built;
+		built.assign(std::vector<uint32_t>(hashes));
+		const auto storedLayout = std::make_shared<std::vector<uint32_t>>(built.getLayout().begin(), built.getLayout().end());
+
+		ShaderHashSet inPlace;
+		CHECK(inPlace.assignLayout(*storedLayout, built.size(), built.getSlotBits(), storedLayout));
+		CHECK(inPlace.getLayout().data() == storedLayout->data());
+		CHECK(inPlace == built);
+		bool allFound = true;
+		for(const uint32_t hash : hashes)
+		{
+			allFound &= inPlace.contains(hash) && !inPlace.contains(hash + 1);
+		}
+		CHECK(allFound);
+
+		// a copy shares the layout, assigning other hashes gives a set its own.
+		ShaderHashSet copy = inPlace;
+		CHECK(copy.getLayout().data() == storedLayout->data());
+		copy.assign(std::vector<uint32_t>(hashes));
+		CHECK(copy.getLayout().data() != storedLayout->data());
+		CHECK(copy == inPlace);
+
+		// a layout which doesn't belong to the size and table specified is refused.
+		CHECK(!inPlace.assignLayout(std::span<const uint32_t>(*storedLayout).first(storedLayout->size() - 1), built.size(), built.getSlotBits(), storedLayout));
+		CHECK(inPlace.empty());
+		CHECK(!inPlace.assignLayout(*storedLayout, built.size(), built.getSlotBits() + 1, storedLayout));
+	}
+}
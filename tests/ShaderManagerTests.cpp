@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include "ShaderManager.h"
+
+using namespace ShaderToggler;
+
+TEST_CASE(ablationStatesAreFreedWhenNoDrawCallReadsThem)
+{
+	// the ablation profiler ablates another shader every few frames for as long as it runs; each change publishes a hunting state.
+	ShaderManager shaderManager;
+	size_t mostRetiredStates = 0;
+	for(uint64_t frame = 1; frame <= 10000; frame++)
+	{
+		shaderManager.setAblatedShader(static_cast<uint32_t>(frame % 50));
+		mostRetiredStates = std::max(mostRetiredStates, shaderManager.getAmountRetiredHuntingStates());
+		shaderManager.onFramePresented();
+	}
+	// no draw call reads them, so each state is freed at the first present after it was replaced.
+	CHECK(mostRetiredStates <= 1);
+	CHECK(shaderManager.getAmountRetiredHuntingStates() == 0);
+
+	// a draw call still checking a shader keeps the state it read alive, however many frames it takes.
+	{
+		const ReaderEpochs::ReadSection readSection;
+		CHECK(shaderManager.isBlockedShader(10000 % 50));
+		shaderManager.setAblatedShader(ShaderIdBitset::NO_ID);
+		for(int frame = 0; frame < 100; frame++)
+		{
+			shaderManager.onFramePresented();
+		}
+		CHECK(shaderManager.getAmountRetiredHuntingStates() == 1);
+	}
+	shaderManager.onFramePresented();
+	CHECK(shaderManager.getAmountRetiredHuntingStates() == 0);
+}
+
+
+TEST_CASE(shaderManagerGivesGroupShadersTheirIdBeforeTheirPipeline)
+{
+	ShaderManager shaderManager;
+	shaderManager.addHashHandlePair(0x1234, 1);
+	const std::vector<uint32_t> groupHashes = { 0xABCD, 0x1234 };
+	std::vector<uint32_t> shaderIds;
+	shaderManager.internShaderHashes(groupHashes, shaderIds);
+	CHECK(shaderIds.size() == 2);
+	CHECK(shaderIds[1] == shaderManager.getPipelineShader(1).shaderId);
+	// a shader without a pipeline doesn't count as a shader of the game.
+	CHECK(shaderManager.getShaderCount() == 1);
+
+	// the pipeline created later on gets the id the group's hash got.
+	shaderManager.addHashHandlePair(0xABCD, 2);
+	CHECK(shaderManager.getPipelineShader(2).shaderId == shaderIds[0]);
+	CHECK(shaderManager.getShaderCount() == 2);
+}
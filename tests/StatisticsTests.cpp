@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <cmath>
+
+#include "Statistics.h"
+
+using namespace ShaderToggler;
+
+TEST_CASE(studentTQuantileIsContinuousBeyondTable)
+{
+	// exact two sided 95% quantiles, from a t table.
+	const struct { uint32_t degreesOfFreedom; double quantile; } exactQuantiles[] =
+	{
+		{ 1, 12.706 }, { 10, 2.228 }, { 20, 2.086 }, { 21, 2.080 }, { 25, 2.060 }, { 30, 2.042 }, { 40, 2.021 }, { 60, 2.000 }, { 120, 1.980 }, { 1000, 1.962 }
+	};
+	for(const auto& exact : exactQuantiles)
+	{
+		CHECK(std::abs(studentTQuantile95(exact.degreesOfFreedom) - exact.quantile) <= 0.0015);
+	}
+	// never increasing, and no jump where the table ends.
+	bool isDecreasing = true;
+	for(uint32_t degreesOfFreedom = 1; degreesOfFreedom < 500; degreesOfFreedom++)
+	{
+		isDecreasing &= studentTQuantile95(degreesOfFreedom + 1) <= studentTQuantile95(degreesOfFreedom);
+	}
+	CHECK(isDecreasing);
+	CHECK(studentTQuantile95(20) - studentTQuantile95(21) < 0.01);
+	CHECK(studentTQuantile95(1000000) > 1.959 && studentTQuantile95(1000000) < 1.961);
+	CHECK(studentTQuantile95(0) == 0.0);
+}
+
+
+TEST_CASE(meanWithIntervalUsesStudentT)
+{
+	// 30 values alternating between 9 and 11: mean 10, sample standard deviation sqrt(30/29).
+	std::vector<double> values;
+	for(int i = 0; i < 30; i++)
+	{
+		values.push_back(i % 2 == 0 ? 9.0 : 11.0);
+	}
+	const MeanWithInterval result = meanWithInterval(values);
+	CHECK(std::abs(result.mean - 10.0) < 1e-9);
+	const double expectedInterval = 2.045 * std::sqrt(30.0 / 29.0) / std::sqrt(30.0);
+	CHECK(std::abs(result.confidenceInterval95 - expectedInterval) < 0.001);
+	CHECK(result.isSignificant());
+}
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace ShaderToggler::Tests
+{
+	/// <summary>
+	/// A test or benchmark, registered by the TEST_CASE macro.
+	/// </summary>
+	struct TestCase
+	{
+		const char* name;
+		void (*function)();
+	};
+
+	/// <summary>
+	/// All registered test cases, in registration order.
+	/// </summary>
+	std::vector<TestCase>& getTestCases();
+	/// <summary>
+	/// Reports a failed check of the running test case.
+	/// </summary>
+	void reportFailure(const char* fileName, int line, const char* expression);
+	/// <summary>
+	/// Returns the path of a file with the name specified in the temp folder, for the files tests write and read back.
+	/// </summary>
+	std::string getTemporaryFileName(const std::string& name);
+
+	struct TestRegistration
+	{
+		TestRegistration(const char* name, void (*function)()) { getTestCases().push_back({ name, function }); }
+	};
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static ShaderToggler::Tests::TestRegistration name##Registration(#name, &name); \
+	static void name()
+
+#define CHECK(expression) \
+	do { if(!(expression)) { ShaderToggler::Tests::reportFailure(__FILE__, __LINE__, #expression); } } while(false)
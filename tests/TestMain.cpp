@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of ShaderToggler, a shader toggler add on for Reshade 5+ which allows you
+// to define groups of shaders to toggle them on/off with one key press
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/ShaderToggler
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+
+#include <cstring>
+
+namespace ShaderToggler::Tests
+{
+	static int s_amountFailures = 0;
+
+
+	std::vector<TestCase>& getTestCases()
+	{
+		static std::vector<TestCase> s_testCases;
+		return s_testCases;
+	}
+
+
+	void reportFailure(const char* fileName, int line, const char* expression)
+	{
+		s_amountFailures++;
+		printf("  %s(%d): check failed: %s\n", fileName, line, expression);
+	}
+
+
+	std::string getTemporaryFileName(const std::string& name)
+	{
+		return (std::filesystem::temp_directory_path() / ("ShaderTogglerTests_" + name)).string();
+	}
+}
+
+
+/// <summary>
+/// Runs all registered test cases, or only the ones with a name containing the first argument if one is passed.
+/// </summary>
+/// <returns>0 if all checks passed, 1 otherwise</returns>
+int main(int argc, char** argv)
+{
+	using namespace ShaderToggler::Tests;
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+	int amountFailedTestCases = 0;
+	for(const TestCase& testCase : getTestCases())
+	{
+		if(nullptr != filter && nullptr == strstr(testCase.name, filter))
+		{
+			continue;
+		}
+		printf("%s\n", testCase.name);
+		const int amountFailuresBefore = s_amountFailures;
+		testCase.function();
+		amountFailedTestCases += s_amountFailures != amountFailuresBefore ? 1 : 0;
+	}
+	printf("%d test case(s) failed.\n", amountFailedTestCases);
+	return amountFailedTestCases == 0 ? 0 : 1;
+}